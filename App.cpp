@@ -1,18 +1,41 @@
 #include "ColorLogic.h"
 
 struct TetraRenderParams {
-    Mat4 transform;
     Color* colors [6];
     float widthsAndTypes [4];
 };
 
+//std140 layout of the FrameConstants block in Basic.vert/Basic.frag
+struct TetraFrameConstants {
+    Mat4 cameraMatrix;
+    Color lightColor;
+    Color shadowColor;
+    float lightDirection[4];
+    float screenSize[4];
+};
+
+//std140 layout of one Material in the MaterialConstants block in Basic.vert
+#define MAX_TETRA_MATERIALS 8
+struct TetraMaterial {
+    Color colors [6];
+    float widthsAndTypes [4];
+};
+
 struct GameMemory {
     TetraRenderParams renderParams[5];
+    SceneStore tetraScene;
     MeshGeometryData tetraData;
-    MeshGPUBinding binding;
+    MeshGPUBinding* binding;
     ShaderProgram tetraShader;
-    ShaderProgramParams tetraRenderParams;
+    ShaderProgramParams* tetraRenderParams;
+    InstanceBuffer tetraMatrixBuffer;
+    InstanceBuffer tetraMaterialIndexBuffer;
+    RenderCommandList renderCommands;
+    UniformBuffer frameConstantsBuffer;
+    UniformBuffer materialConstantsBuffer;
+    TetraFrameConstants frameConstants;
     SlabSubsection_Stack lasResidentStorage;
+    FrameArena* frameArena;
     Pallette pallette;
     TextureData spaceData;
     TextureBindingID spaceTexBinding;
@@ -20,7 +43,14 @@ struct GameMemory {
     Vec3 lightDirection;
     Framebuffer myColorBuffer;
     Framebuffer myDepthBuffer;
-    LoadedSound backgroundSound;
+    LoadedSound* backgroundSound;
+    //Content that comes and goes hands its slots back here instead of leaking lasResidentStorage
+    Pool<MeshGPUBinding> bindingPool;
+    Pool<ShaderProgramParams> paramsPool;
+    Pool<LoadedSound> soundPool;
+    //Render stats accumulate over this many frames until 'p' is pressed
+    uint32 statsFrameCount;
+    bool statsKeyWasDown;
 };
 
 void CreateTetrahedron( MeshGeometryData* storage, SlabSubsection_Stack* savedSpace ) {
@@ -70,25 +100,31 @@ void CreateTetrahedron( MeshGeometryData* storage, SlabSubsection_Stack* savedSp
     storage->normalData[9] = face4Normal; storage->normalData[10] = face4Normal; storage->normalData[11] = face4Normal;
 
     storage->dataCount = 12;
+    storage->vertexCount = 12;
 }
 
-void GameInit( MemorySlab* mainSlab, void* gameMemory, RendererStorage* rendererStoragePtr ) {
+void GameInit( MemorySlab* mainSlab, void* gameMemory, RendererStorage* rendererStoragePtr, FrameArena* frameArena ) {
     GameMemory* gMem = (GameMemory*)gameMemory;
+    gMem->frameArena = frameArena;
 
-    gMem->lasResidentStorage = CarveNewSubsection( mainSlab, KILOBYTES( 128 ) );
+    gMem->lasResidentStorage = CarveNewSubsection( mainSlab, KILOBYTES( 128 ), "LAS Resident" );
+    gMem->bindingPool = CreatePool<MeshGPUBinding>( &gMem->lasResidentStorage, 16 );
+    gMem->paramsPool = CreatePool<ShaderProgramParams>( &gMem->lasResidentStorage, 16 );
+    gMem->soundPool = CreatePool<LoadedSound>( &gMem->lasResidentStorage, 16 );
 
     float screenAspectRatio = (float)SCREEN_HEIGHT / (float)SCREEN_WIDTH;
     SetRendererCameraProjection( 10.0f, 10.0f * screenAspectRatio, 6.0f, -6.0f, &rendererStoragePtr->baseProjectionMatrix );
     SetRendererCameraTransform( rendererStoragePtr, { 0.0f, 0.0f, -2.0f }, { 0.0f, 0.0f, 0.0f } );
 
-    gMem->backgroundSound = LoadWaveFile( "Data/Sounds/SpaceSounds.wav" );
-
-    CreateShaderProgram( "Data/Shaders/Basic.vert", "Data/Shaders/Basic.frag", &gMem->tetraShader );
-    LoadTextureDataFromDisk( "Data/Textures/Space.png", &gMem->spaceData );
-    CreateTextureBinding( &gMem->spaceData, &gMem->spaceTexBinding );
+    //Reads and decodes run on the loader threads while the rest of init carries on, each wait below does its GL upload
+    gMem->backgroundSound = AllocFromPool( &gMem->soundPool );
+    AssetLoadHandle soundLoad = LoadSoundAsync( "Data/Sounds/SpaceSounds.wav", gMem->backgroundSound );
+    AssetLoadHandle shaderLoad = LoadShaderProgramAsync( "Data/Shaders/Basic.vert", "Data/Shaders/Basic.frag", &gMem->tetraShader );
+    AssetLoadHandle spaceTextureLoad = LoadTextureAsync( "Data/Textures/Space.png", &gMem->spaceData, &gMem->spaceTexBinding );
 
     CreateTetrahedron( &gMem->tetraData, &gMem->lasResidentStorage );
-    CreateRenderBinding( &gMem->tetraData, &gMem->binding );
+    gMem->binding = AllocFromPool( &gMem->bindingPool );
+    CreateRenderBinding( &gMem->tetraData, gMem->binding, VERTEX_BUFFERS_INTERLEAVED );
     gMem->myColorBuffer = CreateFramebuffer( SCREEN_WIDTH, SCREEN_HEIGHT, Framebuffer::FramebufferType::COLOR );
     gMem->myDepthBuffer = CreateFramebuffer( SCREEN_WIDTH, SCREEN_HEIGHT, Framebuffer::FramebufferType::DEPTH );
 
@@ -110,22 +146,45 @@ void GameInit( MemorySlab* mainSlab, void* gameMemory, RendererStorage* renderer
     gMem->lightDirection = { -0.707f, -1.0f, 0.5f };
     Normalize( &gMem->lightDirection );
 
-    gMem->tetraRenderParams = CreateShaderParamSet( &gMem->tetraShader );
-    gMem->tetraRenderParams.indexDataPtr = gMem->binding.indexDataPtr;
-    gMem->tetraRenderParams.indiciesToDraw = gMem->binding.dataCount;
-    SetVertexInput( &gMem->tetraRenderParams, "position", gMem->binding.vertexDataPtr );
-    SetVertexInput( &gMem->tetraRenderParams, "normal", gMem->binding.nrmlDataPtr );
-    SetVertexInput( &gMem->tetraRenderParams, "texCoord", gMem->binding.uvDataPtr );
-    SetUniform( &gMem->tetraRenderParams, "cameraMatrix", (void*)&rendererStoragePtr->cameraTransform );
-    SetUniform( &gMem->tetraRenderParams, "screenSize", (void*)&gMem->screenSize[0] );
-    SetUniform( &gMem->tetraRenderParams, "lightDirection", (void*)&gMem->lightDirection );
-    SetUniform( &gMem->tetraRenderParams, "lightColor", (void*)GetColorByName( "LightYellow", &gMem->pallette ) );
-    SetUniform( &gMem->tetraRenderParams, "shadowColor", (void*)GetColorByName( "ShadowBlue", &gMem->pallette ) );
-    SetSampler( &gMem->tetraRenderParams, "spaceBG", gMem->spaceTexBinding );
+    WaitForAssetLoad( shaderLoad );
+    WaitForAssetLoad( spaceTextureLoad );
+    gMem->tetraRenderParams = AllocFromPool( &gMem->paramsPool );
+    *gMem->tetraRenderParams = CreateShaderParamSet( &gMem->tetraShader );
+    gMem->tetraRenderParams->indexDataPtr = gMem->binding->indexDataPtr;
+    gMem->tetraRenderParams->indiciesToDraw = gMem->binding->dataCount;
+    InterleavedVertexFormat* tetraFormat = &gMem->binding->format;
+    SetVertexInput( gMem->tetraRenderParams, "position", gMem->binding->vertexDataPtr, tetraFormat->stride, tetraFormat->positionOffset );
+    SetVertexInput( gMem->tetraRenderParams, "normal", gMem->binding->nrmlDataPtr, tetraFormat->stride, tetraFormat->normalOffset );
+    SetVertexInput( gMem->tetraRenderParams, "texCoord", gMem->binding->uvDataPtr, tetraFormat->stride, tetraFormat->uvOffset );
+    SetSampler( gMem->tetraRenderParams, "spaceBG", gMem->spaceTexBinding );
+
+    gMem->renderCommands = CreateRenderCommandList( &gMem->lasResidentStorage, 64 );
+
+    //One tetra per material, instance inputs read straight out of the scene store's arrays
+    gMem->tetraScene = CreateSceneStore( &gMem->lasResidentStorage, 5 );
+    for( int tetraIndex = 0; tetraIndex < 5; ++tetraIndex ) {
+        AddSceneObject( &gMem->tetraScene, { 0.0f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 1.0f }, (float)tetraIndex );
+    }
+    gMem->tetraMatrixBuffer = CreateInstanceBuffer( sizeof( Mat4 ), gMem->tetraScene.capacity );
+    gMem->tetraMaterialIndexBuffer = CreateInstanceBuffer( sizeof( float ), gMem->tetraScene.capacity );
+    SetInstanceInput( gMem->tetraRenderParams, "instanceModelMatrix", &gMem->tetraMatrixBuffer, 0 );
+    SetInstanceInput( gMem->tetraRenderParams, "instanceMaterialIndex", &gMem->tetraMaterialIndexBuffer, 0 );
+    UpdateInstanceBuffer( &gMem->tetraMaterialIndexBuffer, gMem->tetraScene.materialIndices, gMem->tetraScene.count );
+
+    gMem->frameConstantsBuffer = CreateUniformBuffer( sizeof( TetraFrameConstants ), 0 );
+    gMem->materialConstantsBuffer = CreateUniformBuffer( sizeof( TetraMaterial ) * MAX_TETRA_MATERIALS, 1 );
+    SetUniformBlock( &gMem->tetraShader, "FrameConstants", &gMem->frameConstantsBuffer );
+    SetUniformBlock( &gMem->tetraShader, "MaterialConstants", &gMem->materialConstantsBuffer );
+    gMem->frameConstants.lightColor = *GetColorByName( "LightYellow", &gMem->pallette );
+    gMem->frameConstants.shadowColor = *GetColorByName( "ShadowBlue", &gMem->pallette );
+    gMem->frameConstants.lightDirection[0] = gMem->lightDirection.x;
+    gMem->frameConstants.lightDirection[1] = gMem->lightDirection.y;
+    gMem->frameConstants.lightDirection[2] = gMem->lightDirection.z;
+    gMem->frameConstants.lightDirection[3] = 0.0f;
+    gMem->frameConstants.screenSize[0] = gMem->screenSize[0];
+    gMem->frameConstants.screenSize[1] = gMem->screenSize[1];
 
     for( int renderParamIndex = 0; renderParamIndex < 5; ++renderParamIndex ) {
-        SetToIdentity( &gMem->renderParams[ renderParamIndex ].transform );
-
         const float gradient = 0.5f;
         const float lines = 0.0f;
         const float space = 1.0f;
@@ -187,16 +246,33 @@ void GameInit( MemorySlab* mainSlab, void* gameMemory, RendererStorage* renderer
             gMem->renderParams[ renderParamIndex ].widthsAndTypes[3] = gradient;
         }
     }
+
+    //Color sets never change, so the material block is filled once here
+    TetraMaterial materials[ MAX_TETRA_MATERIALS ] = { };
+    for( int materialIndex = 0; materialIndex < 5; ++materialIndex ) {
+        TetraRenderParams* tetra = &gMem->renderParams[ materialIndex ];
+        for( int colorIndex = 0; colorIndex < 6; ++colorIndex ) {
+            materials[ materialIndex ].colors[ colorIndex ] = *tetra->colors[ colorIndex ];
+        }
+        memcpy( &materials[ materialIndex ].widthsAndTypes[0], &tetra->widthsAndTypes[0], sizeof( float ) * 4 );
+    }
+    UpdateUniformBuffer( &gMem->materialConstantsBuffer, &materials[0], sizeof( TetraMaterial ) * MAX_TETRA_MATERIALS );
+
+    WaitForAssetLoad( soundLoad );
 }
 
-bool Update( void* gameMemory, float millisecondsElapsed, SoundRenderBuffer* sound, PlayingSound* activeSoundList ) {
+bool Update( void* gameMemory, float millisecondsElapsed, ActiveSoundList* activeSoundList ) {
     GameMemory* gMem = (GameMemory*)gameMemory;
 
-    static float step = PI / 256.0f;
+    //Tuned when every frame was one 16ms update
+    float step = ( PI / 256.0f ) * ( millisecondsElapsed / 16.0f );
     const float magicY = -0.247437f;
     const float magicX = 0.834486f;
     static float magicZ = -0.846755f;
 
+    SceneStore* scene = &gMem->tetraScene;
+    SaveSceneTransforms( scene );
+
     if( IsKeyDown( 'z' ) )
         magicZ += step;
     if( IsKeyDown( 'x' ) )
@@ -212,49 +288,60 @@ bool Update( void* gameMemory, float millisecondsElapsed, SoundRenderBuffer* sou
     wiggle += ( wiggleStep * millisecondsElapsed );
     if( wiggle > ( 2.0f * PI ) ) wiggle -= ( 2.0f * PI );
 
-    for( uint8 i = 0; i < 5; ++i ) {
-        SetToIdentity( &gMem->renderParams[i].transform );
-
-        float zExtra =  ((float)i) * ( ( 2.0f * PI ) / 5.0f );
-        Mat4 y, x, z, m;
-        SetToIdentity( &y ); SetToIdentity( &x ); SetToIdentity( &z ); SetToIdentity( &m );
+    Vec3* tetraEulers = PushArray<Vec3>( gMem->frameArena, scene->count );
+    ForEachSceneObject( scene, [&]( uint32 i ) {
+        float zExtra =  ((float)i) * ( ( 2.0f * PI ) / scene->count );
 
-        const float wiggleOffset = ( 2.0f * PI ) / 5.0f;
+        const float wiggleOffset = ( 2.0f * PI ) / scene->count;
         float wiggleValue = cosf( wiggle + ( (float)i * wiggleOffset ) ) * angleWiggleMax;
 
-        SetRotation( &y, 0.0f, 1.0f, 0.0f, magicY + ( mousey * maxRotation ) + wiggleValue );
-        SetRotation( &x, 1.0f, 0.0f, 0.0f, magicX + ( mousex * maxRotation ) + wiggleValue );
-        SetRotation( &z, 0.0f, 0.0f, 1.0f, magicZ + zExtra );
-        gMem->renderParams[i].transform = MultMatrix( MultMatrix( y, x ), z );
-    }
+        tetraEulers[i] = {
+            magicX + ( mousex * maxRotation ) + wiggleValue,
+            magicY + ( mousey * maxRotation ) + wiggleValue,
+            magicZ + zExtra
+        };
+    } );
+    //Spin around y first, then x, then z
+    QuatArrayFromEulersYXZ( tetraEulers, scene->rotations, scene->count );
 
     static bool onlyTrueOnce = true;
     if( onlyTrueOnce ) {
-        QueueLoadedSound( &gMem->backgroundSound, activeSoundList );
+        QueueLoadedSound( gMem->backgroundSound, activeSoundList );
     }
     onlyTrueOnce = false;
 
     return true;
 }
 
-void Render( void* gameMemory, RendererStorage* rendererStorage ) {
+void Render( void* gameMemory, RendererStorage* rendererStorage, float interpolation ) {
     GameMemory* gMem = (GameMemory*)gameMemory;
 
     //SetCurrentFramebuffer( &gMem->myColorBuffer );
     //SetCurrentFramebuffer( &gMem->myDepthBuffer );
     //glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
 
-    for( int tetraRenders = 0; tetraRenders < 5; ++tetraRenders ) {
-        SetUniform( &gMem->tetraRenderParams, "modelMatrix", (void*)&gMem->renderParams[ tetraRenders ].transform );
-        SetUniform( &gMem->tetraRenderParams, "outerColor1", (void*)gMem->renderParams[ tetraRenders ].colors[0] );
-        SetUniform( &gMem->tetraRenderParams, "outerColor2", (void*)gMem->renderParams[ tetraRenders ].colors[1] );
-        SetUniform( &gMem->tetraRenderParams, "innerColor1", (void*)gMem->renderParams[ tetraRenders ].colors[2] );
-        SetUniform( &gMem->tetraRenderParams, "innerColor2", (void*)gMem->renderParams[ tetraRenders ].colors[3] );
-        SetUniform( &gMem->tetraRenderParams, "innerBorderColor", (void*)gMem->renderParams[ tetraRenders ].colors[4] );
-        SetUniform( &gMem->tetraRenderParams, "outerBorderColor", (void*)gMem->renderParams[ tetraRenders ].colors[5] );
-        SetUniform( &gMem->tetraRenderParams, "widthsAndTypes", (void*)&gMem->renderParams[ tetraRenders ].widthsAndTypes[0] );
-        RenderBoundData( &gMem->tetraShader, &gMem->tetraRenderParams );
+    gMem->frameConstants.cameraMatrix = rendererStorage->cameraTransform;
+    UpdateUniformBuffer( &gMem->frameConstantsBuffer, &gMem->frameConstants, sizeof( TetraFrameConstants ) );
+
+    SceneStore* scene = &gMem->tetraScene;
+    UpdateSceneWorldMatricesInterpolated( scene, interpolation, gMem->frameArena );
+    UpdateInstanceBuffer( &gMem->tetraMatrixBuffer, scene->worldMatrices, scene->count );
+    PushRenderCommand( &gMem->renderCommands, &gMem->tetraShader, gMem->tetraRenderParams, scene->count );
+    SubmitRenderCommands( &gMem->renderCommands );
+
+    //Reports once per press, covering every frame since the last one
+    gMem->statsFrameCount++;
+    bool statsKeyDown = IsKeyDown( 'p' );
+    if( statsKeyDown && !gMem->statsKeyWasDown ) {
+        printf( "Render stats over %u frames\n", gMem->statsFrameCount );
+        PrintRenderStats( &gMem->renderCommands.stats );
+        PrintAssetMemoryStats();
+        PrintMemoryReport();
+        printf( "Frame arena high water mark: %llu bytes\n", (unsigned long long)gMem->frameArena->highWaterMark );
+        memset( &gMem->renderCommands.stats, 0, sizeof( RenderStats ) );
+        gMem->statsFrameCount = 0;
     }
+    gMem->statsKeyWasDown = statsKeyDown;
 
     //SetCurrentFramebuffer( NULL );
     //RenderTexturedQuad( rendererStorage, gMem->myColorBuffer.textureBindingID, 1.0f, 1.0f, 0.0f, 0.0f );
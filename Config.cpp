@@ -1,10 +1,23 @@
-#define RESERVED_SPACE 32
+//Megabytes of address space for the slab, only what gets carved is committed
+#define RESERVED_SPACE 1024
 #define SCREEN_WIDTH 1024
 #define SCREEN_HEIGHT 680
+//Records every slab carve and sub stack alloc, report prints at startup and with 'p'
+#define MEMORY_TRACKING
 
-#define WIN32_ENTRY
-#define OPENGL_RENDERER_IMPLEMENTATION
+#ifdef _WIN32
+	#define WIN32_ENTRY
+	#define OPENGL_RENDERER_IMPLEMENTATION
+	//#define SOFTWARE_RENDERER_IMPLEMENTATION
+#else
+	//Headless, no window or audio device, renders with the software rasterizer
+	#define LINUX_ENTRY
+	#define SOFTWARE_RENDERER_IMPLEMENTATION
+#endif
 
 #ifdef WIN32_ENTRY
 	#include "Src\WinMain.cpp"
+#endif
+#ifdef LINUX_ENTRY
+	#include "Src/LinuxMain.cpp"
 #endif
\ No newline at end of file
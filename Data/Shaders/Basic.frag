@@ -1,20 +1,24 @@
 #version 140
-uniform vec4 outerColor1;
-uniform vec4 outerColor2;
-uniform vec4 innerColor1;
-uniform vec4 innerColor2;
-uniform vec4 innerBorderColor;
-uniform vec4 outerBorderColor;
-uniform vec4 widthsAndTypes;
-uniform vec4 lightColor;
-uniform vec4 shadowColor;
-uniform vec3 lightDirection;
-uniform vec2 screenSize;
+//Uploaded once per frame, shared with Basic.vert
+layout(std140) uniform FrameConstants {
+	mat4 cameraMatrix;
+	vec4 lightColor;
+	vec4 shadowColor;
+	vec4 lightDirection;
+	vec2 screenSize;
+};
 
 uniform sampler2D spaceBG;
 
 smooth in vec3 bary;
 smooth in vec3 nrml;
+flat in vec4 outerColor1;
+flat in vec4 outerColor2;
+flat in vec4 innerColor1;
+flat in vec4 innerColor2;
+flat in vec4 innerBorderColor;
+flat in vec4 outerBorderColor;
+flat in vec4 widthsAndTypes;
 
 void ColorFragAsSpace() {
 	float adjustedX = ( gl_FragCoord.x - ( ( screenSize.x - screenSize.y ) * 0.5 ) ) / screenSize.y;
@@ -27,7 +31,7 @@ void ColorFragAsSpace() {
 }
 
 void Shade() {
-	float shadowDot = dot( lightDirection, nrml );
+	float shadowDot = dot( lightDirection.xyz, nrml );
 	float sign = sign( shadowDot );
 	shadowDot = -1.0f * sign * sqrt( abs( shadowDot ) );
 
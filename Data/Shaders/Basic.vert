@@ -1,14 +1,46 @@
 #version 140
 
-uniform mat4 modelMatrix;
-uniform mat4 cameraMatrix;
+//Uploaded once per frame, shared with Basic.frag
+layout(std140) uniform FrameConstants {
+	mat4 cameraMatrix;
+	vec4 lightColor;
+	vec4 shadowColor;
+	vec4 lightDirection;
+	vec2 screenSize;
+};
+
+struct Material {
+	vec4 outerColor1;
+	vec4 outerColor2;
+	vec4 innerColor1;
+	vec4 innerColor2;
+	vec4 innerBorderColor;
+	vec4 outerBorderColor;
+	vec4 widthsAndTypes;
+};
+
+//Color sets for every tetrahedron style, instances pick one by index
+layout(std140) uniform MaterialConstants {
+	Material materials[ 8 ];
+};
 
 attribute vec3 position;
 attribute vec3 normal;
 attribute vec2 texCoord;
 
+//Per instance data, advanced once per tetrahedron rather than once per vertex
+attribute mat4 instanceModelMatrix;
+attribute float instanceMaterialIndex;
+
 smooth out vec3 bary;
 smooth out vec3 nrml;
+flat out vec4 outerColor1;
+flat out vec4 outerColor2;
+flat out vec4 innerColor1;
+flat out vec4 innerColor2;
+flat out vec4 innerBorderColor;
+flat out vec4 outerBorderColor;
+flat out vec4 widthsAndTypes;
 
 void main() { 
 	gl_TexCoord[0] = vec4( texCoord.xy, 0.0f, 0.0f );
@@ -21,8 +53,17 @@ void main() {
 		bary = vec3( 0.0f, 0.0f, 1.0f );
 	}
 
+	Material material = materials[ int( instanceMaterialIndex ) ];
+	outerColor1 = material.outerColor1;
+	outerColor2 = material.outerColor2;
+	innerColor1 = material.innerColor1;
+	innerColor2 = material.innerColor2;
+	innerBorderColor = material.innerBorderColor;
+	outerBorderColor = material.outerBorderColor;
+	widthsAndTypes = material.widthsAndTypes;
+
 	vec3 normalisbeingused = normal;
-	gl_Position = cameraMatrix * modelMatrix * vec4( position, 1.0f );
-	nrml = (modelMatrix * vec4( normal, 0.0f ) ).xyz;
+	gl_Position = cameraMatrix * instanceModelMatrix * vec4( position, 1.0f );
+	nrml = (instanceModelMatrix * vec4( normal, 0.0f ) ).xyz;
 	normalize( nrml );
 }
\ No newline at end of file
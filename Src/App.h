@@ -23,19 +23,37 @@ bool IsControllerButtonDown( uint8 buttonIndex );
 void GetControllerStickState( uint8 stickIndex, float* x, float* y );
 float GetTriggerState( uint8 triggerIndex );
 
-void* ReadWholeFile( char* filename, int64* bytesRead );
+///Result comes from AllocAssetMemory, hand it back with FreeAssetMemory
+void* ReadWholeFile( const char* filename, int64* bytesRead );
+///Private copy on write view of the whole file, quietly NULL if it can't be opened so it can probe for caches
+void* MapWholeFile( const char* filename, int64* bytesMapped );
+void UnmapWholeFile( void* data, int64 bytesMapped );
+///Writes to a temporary beside the target then renames, so a crash never leaves a half written file behind
+bool WriteWholeFile( const char* filename, const void* data, int64 bytes );
+///Last write time in platform units, only good for comparing against itself. 0 if the file doesn't exist
+int64 GetFileModifiedTime( const char* filename );
+///General purpose heap in the slab for asset data that lives an unknown length of time
+void* AllocAssetMemory( uint64 size );
+void* ReallocAssetMemory( void* ptr, uint64 size );
+void FreeAssetMemory( void* ptr );
+void PrintAssetMemoryStats();
 
 #include "Memory.h"
 #include "Math3D.h"
 #include "Renderer.h"
+#include "Scene.h"
 #include "Sound.h"
+#include "Timing.h"
+#include "AssetLoading.h"
 
 /* --------------------------------------------------------------------------
 	                      STUFF THE GAME PROVIDES THE OS
  ----------------------------------------------------------------------------*/
-bool Update( void* gameMemory, float millisecondsElapsed, SoundRenderBuffer* sound, PlayingSound* activeSoundList );
-void Render( void* gameMemory );
-void GameInit( MemorySlab* mainSlab, void* gameMemory );
+///Called zero or more times a frame, always with the same fixed step
+bool Update( void* gameMemory, float millisecondsElapsed, ActiveSoundList* activeSoundList );
+///interpolation is how far past the last Update the frame is, as a fraction of a step
+void Render( void* gameMemory, RendererStorage* rendererStorage, float interpolation );
+void GameInit( MemorySlab* mainSlab, void* gameMemory, RendererStorage* rendererStorage, FrameArena* frameArena );
 
 #define APP_H
 #endif
\ No newline at end of file
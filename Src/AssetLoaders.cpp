@@ -0,0 +1,1483 @@
+/*----------------------------------------------------------------------------------------
+                      Platform independent OS layer pieces
+    Shared by every platform layer. The including file provides appInfo with an assetHeap,
+    which also holds the loaders' intermediate buffers, and includes this after appInfo is declared
+-----------------------------------------------------------------------------------------*/
+#include <mutex>
+
+///Just enough of a pull style XML reader for the COLLADA the loaders use. It steps tag to tag through the
+///file in place and only remembers the names of the open elements, so nothing is built per node
+#define XML_MAX_DEPTH 64
+struct XmlReader {
+	const char* cursor;
+	const char* end;
+	//The tag the last NextXmlTag stopped on
+	const char* name;
+	uint32 nameLength;
+	const char* attributes;
+	const char* attributesEnd;
+	bool isEndTag;
+	bool isEmptyElement;
+	//Character data straight after a start tag, up to the next tag
+	const char* text;
+	const char* textEnd;
+	//Elements enclosing the current tag, outermost first. Anything nested past XML_MAX_DEPTH is counted but not named
+	const char* openNames[ XML_MAX_DEPTH ];
+	uint32 openNameLengths[ XML_MAX_DEPTH ];
+	uint32 depth;
+	bool startTagPending;
+};
+
+///What the mesh loader pulls out of one pass over a COLLADA file. Arrays are asset heap, names point into the file
+struct ColladaMeshArrays {
+	float* positions;
+	uint32 positionCount;
+	float* normals;
+	uint32 normalCount;
+	float* uvs;
+	uint32 uvCount;
+	uint32* indices;
+	uint32 indexCount;
+	//Skin controller
+	const char* jointNames;
+	const char* jointNamesEnd;
+	float* inverseBindPoses;
+	uint32 inverseBindPoseCount;
+	float* weights;
+	uint32 weightCount;
+	uint32* influenceCounts;
+	uint32 influencedVertexCount;
+	uint32* influences;
+	uint32 influenceCount;
+	//Influences spread out to MAXBONESPERVERT per position, built from the skin arrays after the pass
+	float* vertexBoneWeights;
+	uint32* vertexBoneIndices;
+};
+
+///One welded vertex, zeroed before it's filled so whole vertices can be hashed and compared as bytes
+struct ColladaVertex {
+	Vec3 position;
+	Vec3 normal;
+	float uv[2];
+	float boneWeights[ MAXBONESPERVERT ];
+	uint32 boneIndices[ MAXBONESPERVERT ];
+};
+
+//Helpers only to be used in this file ( so far ), they return how many values were written
+static uint32 ParseFloatArray( const char* text, const char* textEnd, float* numbersOut, uint32 maxCount );
+static uint32 ParseUInt32Array( const char* text, const char* textEnd, uint32* numbersOut, uint32 maxCount );
+static void CheckParsedCount( const char* fileName, const char* arrayName, uint32 parsedCount, uint32 expectedCount );
+static const char* SkipTextWhitespace( const char* text, const char* textEnd );
+static const char* FindTokenEnd( const char* text, const char* textEnd );
+
+static XmlReader BeginXmlReader( const char* text, int64 length );
+///Advances to the next start or end tag, false at the end of the file
+static bool NextXmlTag( XmlReader* reader );
+static bool XmlTagIs( const XmlReader* reader, const char* tagName );
+///levelsUp of 1 is the element holding the current tag
+static bool XmlAncestorIs( const XmlReader* reader, uint32 levelsUp, const char* tagName );
+static bool GetXmlAttribute( const XmlReader* reader, const char* attributeName, const char** value, const char** valueEnd );
+static bool XmlAttributeIs( const XmlReader* reader, const char* attributeName, const char* expected );
+static uint32 GetXmlAttributeUInt32( const XmlReader* reader, const char* attributeName );
+
+///Parse the current tag's text into a new asset heap array of count values, NULL if count is 0 or the heap is full
+static float* ParseColladaFloats( const char* fileName, const char* arrayName, const XmlReader* reader, uint32 count );
+static uint32* ParseColladaUInt32s( const char* fileName, const char* arrayName, const XmlReader* reader, uint32 count );
+static void FreeColladaMeshArrays( ColladaMeshArrays* arrays );
+static Bone* FindBoneByName( Armature* armature, const char* name, const char* nameEnd );
+static void ReadColladaCorner( const ColladaMeshArrays* raw, uint32 corner, ColladaVertex* vertex );
+///Numbers each corner's vertex into indicesOut, corners with identical data share one. vertexCorners gets the first corner
+///of each vertex, returns the vertex count
+static uint32 WeldColladaCorners( const ColladaMeshArrays* raw, uint32 cornerCount, uint32* indicesOut, uint32* vertexCorners );
+///Reorders whole triangles so they reuse recently transformed vertices, leaves indices untouched if there's no scratch memory
+static void OptimizeVertexCacheOrder( uint32* indices, uint32 indexCount, uint32 vertexCount );
+
+//The asset load workers allocate too, so every trip into the heap takes this
+static std::mutex assetHeapLock;
+
+void* AllocAssetMemory( uint64 size ) {
+	std::lock_guard<std::mutex> guard( assetHeapLock );
+	return SlabHeapAlloc( &appInfo.assetHeap, size );
+}
+
+void* ReallocAssetMemory( void* ptr, uint64 size ) {
+	std::lock_guard<std::mutex> guard( assetHeapLock );
+	return SlabHeapRealloc( &appInfo.assetHeap, ptr, size );
+}
+
+void FreeAssetMemory( void* ptr ) {
+	std::lock_guard<std::mutex> guard( assetHeapLock );
+	SlabHeapFree( &appInfo.assetHeap, ptr );
+}
+
+void PrintAssetMemoryStats() {
+	std::lock_guard<std::mutex> guard( assetHeapLock );
+	PrintSlabHeapStats( &appInfo.assetHeap );
+}
+
+/*----------------------------------------------------------------------------------------
+                       Renderer.h function prototype implementations
+-----------------------------------------------------------------------------------------*/
+
+bool LoadMeshDataFromDisk( const char* fileName,  SlabSubsection_Stack* allocater, MeshGeometryData* storage, Armature* armature ) {
+	storage->dataCount = 0;
+	storage->mappedFile = NULL;
+	storage->mappedSize = 0;
+	if( armature != NULL ) {
+		armature->boneCount = 0;
+		armature->rootBone = NULL;
+	}
+
+	int64 fileSize = 0;
+	const char* fileText = (const char*)MapWholeFile( fileName, &fileSize );
+	if( fileText == NULL ) {
+		printf( "Could not load mesh: %s\n", fileName );
+		return false;
+	}
+
+	//Only the first geometry and skin controller are read, their sources in the fixed order Blender exports them
+	ColladaMeshArrays raw = { };
+	uint32 geometriesSeen = 0;
+	uint32 controllersSeen = 0;
+	uint32 visualScenesSeen = 0;
+	uint32 meshSourceIndex = 0;
+	uint32 skinSourceIndex = 0;
+	uint32 triangleCount = 0;
+	//The armature is the first scene node whose first child node is a JOINT, that child is the root bone.
+	//Bones stay open until their node's end tag, so children find their parent on top of the stack
+	bool sceneNodeHasChild = false;
+	bool armatureDone = armature == NULL;
+	Bone* openBones[ MAXBONES ];
+	uint32 openBoneDepths[ MAXBONES ];
+	uint32 openBoneCount = 0;
+
+	XmlReader reader = BeginXmlReader( fileText, fileSize );
+	while( NextXmlTag( &reader ) ) {
+		if( reader.isEndTag ) {
+			if( openBoneCount > 0 && reader.depth == openBoneDepths[ openBoneCount - 1 ] && XmlTagIs( &reader, "node" ) ) {
+				openBoneCount--;
+				armatureDone = openBoneCount == 0;
+			}
+			continue;
+		}
+
+		if( XmlTagIs( &reader, "geometry" ) ) {
+			geometriesSeen++;
+		} else if( XmlTagIs( &reader, "controller" ) ) {
+			controllersSeen++;
+		} else if( XmlTagIs( &reader, "visual_scene" ) ) {
+			visualScenesSeen++;
+		} else if( XmlTagIs( &reader, "source" ) ) {
+			if( XmlAncestorIs( &reader, 1, "mesh" ) ) meshSourceIndex++;
+			if( XmlAncestorIs( &reader, 1, "skin" ) ) skinSourceIndex++;
+		} else if( XmlTagIs( &reader, "float_array" ) ) {
+			uint32 count = GetXmlAttributeUInt32( &reader, "count" );
+			if( geometriesSeen == 1 && XmlAncestorIs( &reader, 2, "mesh" ) ) {
+				if( meshSourceIndex == 1 && raw.positions == NULL ) {
+					raw.positions = ParseColladaFloats( fileName, "positions", &reader, count );
+					raw.positionCount = raw.positions != NULL ? count : 0;
+				} else if( meshSourceIndex == 2 && raw.normals == NULL ) {
+					raw.normals = ParseColladaFloats( fileName, "normals", &reader, count );
+					raw.normalCount = raw.normals != NULL ? count : 0;
+				} else if( meshSourceIndex == 3 && raw.uvs == NULL ) {
+					raw.uvs = ParseColladaFloats( fileName, "uvs", &reader, count );
+					raw.uvCount = raw.uvs != NULL ? count : 0;
+				}
+			} else if( controllersSeen == 1 && XmlAncestorIs( &reader, 2, "skin" ) ) {
+				if( skinSourceIndex == 2 && raw.inverseBindPoses == NULL && armature != NULL ) {
+					raw.inverseBindPoses = ParseColladaFloats( fileName, "inverse bind matrices", &reader, count );
+					raw.inverseBindPoseCount = raw.inverseBindPoses != NULL ? count : 0;
+				} else if( skinSourceIndex == 3 && raw.weights == NULL ) {
+					raw.weights = ParseColladaFloats( fileName, "bone weights", &reader, count );
+					raw.weightCount = raw.weights != NULL ? count : 0;
+				}
+			}
+		} else if( XmlTagIs( &reader, "polylist" ) ) {
+			if( geometriesSeen == 1 && triangleCount == 0 ) {
+				triangleCount = GetXmlAttributeUInt32( &reader, "count" );
+			}
+		} else if( XmlTagIs( &reader, "p" ) ) {
+			if( geometriesSeen == 1 && raw.indices == NULL && XmlAncestorIs( &reader, 1, "polylist" ) ) {
+				//Assume this is already triangulated, with vertex, normal and uv inputs
+				uint32 count = triangleCount * 3 * 3;
+				raw.indices = ParseColladaUInt32s( fileName, "indices", &reader, count );
+				raw.indexCount = raw.indices != NULL ? count : 0;
+			}
+		} else if( XmlTagIs( &reader, "Name_array" ) ) {
+			if( controllersSeen == 1 && skinSourceIndex == 1 && XmlAncestorIs( &reader, 2, "skin" ) ) {
+				raw.jointNames = reader.text;
+				raw.jointNamesEnd = reader.textEnd;
+			}
+		} else if( XmlTagIs( &reader, "vertex_weights" ) ) {
+			if( controllersSeen == 1 && raw.influencedVertexCount == 0 ) {
+				raw.influencedVertexCount = GetXmlAttributeUInt32( &reader, "count" );
+			}
+		} else if( XmlTagIs( &reader, "vcount" ) ) {
+			if( controllersSeen == 1 && raw.influenceCounts == NULL && XmlAncestorIs( &reader, 1, "vertex_weights" ) ) {
+				raw.influenceCounts = ParseColladaUInt32s( fileName, "influence counts", &reader, raw.influencedVertexCount );
+				if( raw.influenceCounts == NULL ) raw.influencedVertexCount = 0;
+			}
+		} else if( XmlTagIs( &reader, "v" ) ) {
+			if( controllersSeen == 1 && raw.influences == NULL && XmlAncestorIs( &reader, 1, "vertex_weights" ) ) {
+				//vcount comes first, so the bone and weight index pairs can be sized exactly
+				uint64 count = 0;
+				for( uint32 i = 0; i < raw.influencedVertexCount; i++ ) {
+					count += (uint64)raw.influenceCounts[i] * 2;
+				}
+				if( count > 0xFFFFFFFF ) count = 0;
+				raw.influences = ParseColladaUInt32s( fileName, "influences", &reader, (uint32)count );
+				raw.influenceCount = raw.influences != NULL ? (uint32)count : 0;
+			}
+		} else if( XmlTagIs( &reader, "node" ) ) {
+			if( armatureDone || visualScenesSeen != 1 ) continue;
+			Bone* parentBone = NULL;
+			if( openBoneCount > 0 ) {
+				//Only nodes directly inside a bone are its children
+				if( reader.depth != openBoneDepths[ openBoneCount - 1 ] + 1 ) continue;
+				parentBone = openBones[ openBoneCount - 1 ];
+			} else if( XmlAncestorIs( &reader, 1, "visual_scene" ) ) {
+				sceneNodeHasChild = false;
+				continue;
+			} else if( XmlAncestorIs( &reader, 2, "visual_scene" ) && !sceneNodeHasChild ) {
+				sceneNodeHasChild = true;
+				if( !XmlAttributeIs( &reader, "type", "JOINT" ) ) continue;
+			} else {
+				continue;
+			}
+			if( reader.isEmptyElement ) continue;
+			if( armature->boneCount == MAXBONES ) {
+				printf( "%s: armature has more than %u bones, the rest are dropped\n", fileName, MAXBONES );
+				armatureDone = true;
+				continue;
+			}
+
+			Bone* bone = &armature->bones[ armature->boneCount ];
+			bone->parent = parentBone;
+			bone->currentTransform = &armature->boneTransforms[ armature->boneCount ];
+			SetToIdentity( bone->currentTransform );
+			SetToIdentity( &bone->bindPose );
+			SetToIdentity( &bone->invBindPose );
+			bone->boneIndex = armature->boneCount;
+			bone->childCount = 0;
+			armature->boneCount++;
+
+			memset( bone->name, 0, sizeof( bone->name ) );
+			const char* name = NULL;
+			const char* nameEnd = NULL;
+			if( GetXmlAttribute( &reader, "sid", &name, &nameEnd ) ) {
+				size_t nameLength = nameEnd - name;
+				if( nameLength >= sizeof( bone->name ) ) nameLength = sizeof( bone->name ) - 1;
+				memcpy( bone->name, name, nameLength );
+			}
+
+			if( parentBone == NULL ) {
+				armature->rootBone = bone;
+			} else if( parentBone->childCount < sizeof( parentBone->children ) / sizeof( Bone* ) ) {
+				parentBone->children[ parentBone->childCount++ ] = bone;
+			} else {
+				printf( "%s: bone %s has too many children, %s won't be posed\n", fileName, parentBone->name, bone->name );
+			}
+			openBones[ openBoneCount ] = bone;
+			openBoneDepths[ openBoneCount ] = reader.depth;
+			openBoneCount++;
+		} else if( XmlTagIs( &reader, "matrix" ) ) {
+			if( openBoneCount > 0 && reader.depth == openBoneDepths[ openBoneCount - 1 ] + 1 ) {
+				float matrixData[16] = { };
+				CheckParsedCount( fileName, "bone matrix", ParseFloatArray( reader.text, reader.textEnd, matrixData, 16 ), 16 );
+				//Note: this is only local transform data, but its being saved in bind matrix for now
+				Mat4 m;
+				memcpy( &m.m[0][0], &matrixData[0], sizeof(float) * 16 );
+				openBones[ openBoneCount - 1 ]->bindPose = TransposeMatrix( m );
+			}
+		}
+	}
+
+	if( raw.positions == NULL || raw.indices == NULL ) {
+		printf( "Could not find mesh geometry in %s\n", fileName );
+		FreeColladaMeshArrays( &raw );
+		UnmapWholeFile( (void*)fileText, fileSize );
+		return false;
+	}
+
+	const uint32 positionVertexCount = raw.positionCount / 3;
+	//Skinning Data, spread out to MAXBONESPERVERT influences per position
+	if( raw.influenceCounts != NULL ) {
+		raw.vertexBoneWeights = (float*)AllocAssetMemory( sizeof(float) * MAXBONESPERVERT * positionVertexCount );
+		raw.vertexBoneIndices = (uint32*)AllocAssetMemory( sizeof(uint32) * MAXBONESPERVERT * positionVertexCount );
+		if( raw.vertexBoneWeights == NULL || raw.vertexBoneIndices == NULL ) {
+			printf( "%s: no room in the asset heap for skinning data, loading it unskinned\n", fileName );
+			FreeAssetMemory( raw.vertexBoneWeights );
+			FreeAssetMemory( raw.vertexBoneIndices );
+			raw.vertexBoneWeights = NULL;
+			raw.vertexBoneIndices = NULL;
+		} else {
+			memset( raw.vertexBoneWeights, 0, sizeof(float) * MAXBONESPERVERT * positionVertexCount );
+			memset( raw.vertexBoneIndices, 0, sizeof(uint32) * MAXBONESPERVERT * positionVertexCount );
+
+			uint32 colladaIndexIndirection = 0;
+			for( uint32 i = 0; i < raw.influencedVertexCount && i < positionVertexCount; i++ ) {
+				uint32 influenceCount = raw.influenceCounts[i];
+				for( uint32 j = 0; j < influenceCount && colladaIndexIndirection + 1 < raw.influenceCount; j++ ) {
+					uint32 boneIndex = raw.influences[ colladaIndexIndirection++ ];
+					uint32 weightIndex = raw.influences[ colladaIndexIndirection++ ];
+					//Influences past what a vertex can hold are dropped
+					if( j >= MAXBONESPERVERT || weightIndex >= raw.weightCount ) continue;
+					raw.vertexBoneWeights[ i * MAXBONESPERVERT + j ] = raw.weights[ weightIndex ];
+					raw.vertexBoneIndices[ i * MAXBONESPERVERT + j ] = boneIndex;
+				}
+			}
+		}
+	}
+
+	//Armature
+	if( armature != NULL && armature->boneCount > 0 ) {
+		//Bones were read parents first, so each parent is already in model space when its children get to it
+		for( uint8 boneIndex = 0; boneIndex < armature->boneCount; boneIndex++ ) {
+			Bone* bone = &armature->bones[ boneIndex ];
+			if( bone->parent != NULL ) {
+				bone->bindPose = MultMatrix( bone->parent->bindPose, bone->bindPose );
+			}
+		}
+
+		//Inverse bind poses are listed in the skin's joint name order
+		Mat4 correction;
+		correction.m[0][0] = 1.0f; correction.m[0][1] = 0.0f; correction.m[0][2] = 0.0f; correction.m[0][3] = 0.0f;
+		correction.m[1][0] = 0.0f; correction.m[1][1] = 0.0f; correction.m[1][2] = 1.0f; correction.m[1][3] = 0.0f;
+		correction.m[2][0] = 0.0f; correction.m[2][1] = -1.0f; correction.m[2][2] = 0.0f; correction.m[2][3] = 0.0f;
+		correction.m[3][0] = 0.0f; correction.m[3][1] = 0.0f; correction.m[3][2] = 0.0f; correction.m[3][3] = 1.0f;
+		const char* nextBoneName = raw.jointNames;
+		for( uint32 matrixIndex = 0; matrixIndex < armature->boneCount && ( matrixIndex + 1 ) * 16 <= raw.inverseBindPoseCount; matrixIndex++ ) {
+			nextBoneName = SkipTextWhitespace( nextBoneName, raw.jointNamesEnd );
+			const char* boneNameEnd = FindTokenEnd( nextBoneName, raw.jointNamesEnd );
+			if( nextBoneName == boneNameEnd ) break;
+			Bone* targetBone = FindBoneByName( armature, nextBoneName, boneNameEnd );
+			if( targetBone == NULL ) {
+				printf( "%s: skin joint %.*s isn't in the armature\n", fileName, (int)( boneNameEnd - nextBoneName ), nextBoneName );
+				nextBoneName = boneNameEnd;
+				continue;
+			}
+			nextBoneName = boneNameEnd;
+
+			Mat4 matrix;
+			memcpy( &matrix.m[0], &raw.inverseBindPoses[matrixIndex * 16], sizeof(float) * 16 );
+			targetBone->invBindPose = TransposeMatrix( matrix );
+			targetBone->invBindPose = MultMatrix( correction, targetBone->invBindPose );
+		}
+	}
+
+	//Corners with identical data become one vertex, triangles are then ordered for the post transform cache and
+	//vertices numbered by first use. Corners are read back out of the raw arrays when needed, so only indices are kept
+	//Each corner is a position, normal and uv index triple in the raw indices
+	const uint32 cornerCount = raw.indexCount / 3;
+	const uint32 indexCount = cornerCount - cornerCount % 3;
+	//Anything carved for a mesh that doesn't fit is handed back, so a failed load leaves allocater as it found it
+	void* allocaterStart = allocater->current;
+	storage->iData = (uint32*)AllocOnSubStack_Aligned( allocater, indexCount * sizeof( uint32 ), 4 );
+	if( storage->iData == NULL ) {
+		printf( "%s: %llu bytes of indices don't fit in the mesh's sub stack\n", fileName, (unsigned long long)indexCount * sizeof( uint32 ) );
+		FreeColladaMeshArrays( &raw );
+		UnmapWholeFile( (void*)fileText, fileSize );
+		return false;
+	}
+	uint32* vertexCorners = (uint32*)AllocAssetMemory( sizeof( uint32 ) * (uint64)indexCount );
+	if( vertexCorners == NULL ) {
+		allocater->current = allocaterStart;
+		storage->iData = NULL;
+		printf( "%s: no room in the asset heap to weld %u vertices\n", fileName, indexCount );
+		FreeColladaMeshArrays( &raw );
+		UnmapWholeFile( (void*)fileText, fileSize );
+		return false;
+	}
+	uint32 vertexCount = WeldColladaCorners( &raw, indexCount, storage->iData, vertexCorners );
+	OptimizeVertexCacheOrder( storage->iData, indexCount, vertexCount );
+
+	storage->vertexCount = vertexCount;
+	storage->vData = (Vec3*)AllocOnSubStack_Aligned( allocater, vertexCount * sizeof( Vec3 ), 16 );
+	storage->uvData = (float*)AllocOnSubStack_Aligned( allocater, vertexCount * 2 * sizeof( float ), 4 );
+	storage->normalData = (Vec3*)AllocOnSubStack_Aligned( allocater, vertexCount * sizeof( Vec3 ), 4 );
+	if( raw.vertexBoneWeights != NULL ) {
+		storage->boneWeightData = (float*)AllocOnSubStack_Aligned( allocater, sizeof(float) * vertexCount * MAXBONESPERVERT, 4 );
+		storage->boneIndexData = (uint32*)AllocOnSubStack_Aligned( allocater, sizeof(uint32) * vertexCount * MAXBONESPERVERT, 4 );
+	} else {
+		storage->boneWeightData = NULL;
+		storage->boneIndexData = NULL;
+	}
+	if( storage->vData == NULL || storage->uvData == NULL || storage->normalData == NULL ||
+		( raw.vertexBoneWeights != NULL && ( storage->boneWeightData == NULL || storage->boneIndexData == NULL ) ) ) {
+		uint64 bytesPerVertex = sizeof( Vec3 ) * 2 + sizeof( float ) * 2;
+		if( raw.vertexBoneWeights != NULL ) bytesPerVertex += ( sizeof( float ) + sizeof( uint32 ) ) * MAXBONESPERVERT;
+		printf( "%s: %u vertices need %llu bytes, more than is left in the mesh's sub stack\n", fileName, vertexCount,
+			(unsigned long long)( bytesPerVertex * vertexCount ) );
+		allocater->current = allocaterStart;
+		memset( storage, 0, sizeof( MeshGeometryData ) );
+		FreeAssetMemory( vertexCorners );
+		FreeColladaMeshArrays( &raw );
+		UnmapWholeFile( (void*)fileText, fileSize );
+		return false;
+	}
+
+	//Vertex fetch order, vertices are written out in the order the optimized triangles first touch them
+	const uint32 unwritten = 0xFFFFFFFF;
+	uint32* vertexRemap = (uint32*)AllocAssetMemory( sizeof( uint32 ) * (uint64)vertexCount );
+	if( vertexRemap != NULL ) {
+		memset( vertexRemap, 0xFF, sizeof( uint32 ) * (uint64)vertexCount );
+	}
+	uint32 writtenCount = 0;
+	for( uint32 i = 0; i < indexCount; i++ ) {
+		uint32 vertexIndex = storage->iData[i];
+		uint32 storageIndex = vertexIndex;
+		if( vertexRemap != NULL ) {
+			if( vertexRemap[ vertexIndex ] != unwritten ) {
+				storage->iData[i] = vertexRemap[ vertexIndex ];
+				continue;
+			}
+			storageIndex = writtenCount++;
+			vertexRemap[ vertexIndex ] = storageIndex;
+			storage->iData[i] = storageIndex;
+		}
+
+		ColladaVertex vertex;
+		ReadColladaCorner( &raw, vertexCorners[ vertexIndex ], &vertex );
+		storage->vData[ storageIndex ] = vertex.position;
+		storage->normalData[ storageIndex ] = vertex.normal;
+		storage->uvData[ storageIndex * 2 ] = vertex.uv[0];
+		storage->uvData[ storageIndex * 2 + 1 ] = vertex.uv[1];
+		if( raw.vertexBoneWeights != NULL ) {
+			memcpy( &storage->boneWeightData[ storageIndex * MAXBONESPERVERT ], vertex.boneWeights, sizeof( vertex.boneWeights ) );
+			memcpy( &storage->boneIndexData[ storageIndex * MAXBONESPERVERT ], vertex.boneIndices, sizeof( vertex.boneIndices ) );
+		}
+	}
+	storage->dataCount = indexCount;
+
+	FreeAssetMemory( vertexRemap );
+	FreeAssetMemory( vertexCorners );
+	FreeColladaMeshArrays( &raw );
+	UnmapWholeFile( (void*)fileText, fileSize );
+	return true;
+}
+
+static void ApplyColladaAnimationChannel( const char* fileName, ArmatureKeyFrame* keyframe, Armature* armature,
+	const char* target, const char* targetEnd, const float* rawTransformData ) {
+	//Desired data: what bone, and what local transform to it occurs. Targets look like "Bone/transform"
+	const char* nameEnd = target;
+	while( nameEnd < targetEnd && *nameEnd != '/' ) {
+		nameEnd++;
+	}
+	Bone* targetBone = FindBoneByName( armature, target, nameEnd );
+	if( targetBone == NULL ) {
+		printf( "%s: animation targets %.*s, which isn't in the armature\n", fileName, (int)( nameEnd - target ), target );
+		return;
+	}
+
+	//Save data in BoneKeyFrame struct
+	Mat4 boneLocalTransform;
+	memcpy( &boneLocalTransform.m[0][0], &rawTransformData[0], 16 * sizeof(float) );
+	boneLocalTransform = TransposeMatrix( boneLocalTransform );
+	if( targetBone == armature->rootBone ) {
+		Mat4 correction;
+		correction.m[0][0] = 1.0f; correction.m[0][1] = 0.0f; correction.m[0][2] = 0.0f; correction.m[0][3] = 0.0f;
+		correction.m[1][0] = 0.0f; correction.m[1][1] = 0.0f; correction.m[1][2] = -1.0f; correction.m[1][3] = 0.0f;
+		correction.m[2][0] = 0.0f; correction.m[2][1] = 1.0f; correction.m[2][2] = 0.0f; correction.m[2][3] = 0.0f;
+		correction.m[3][0] = 0.0f; correction.m[3][1] = 0.0f; correction.m[3][2] = 0.0f; correction.m[3][3] = 1.0f;
+		boneLocalTransform = MultMatrix( boneLocalTransform, correction );
+	}
+	BoneKeyFrame* key = &keyframe->targetBoneTransforms[ targetBone->boneIndex ];
+	key->combinedMatrix = boneLocalTransform;
+	DecomposeMat4( boneLocalTransform, &key->scale, &key->rotation, &key->translation );
+}
+
+void LoadAnimationDataFromCollada( const char* fileName, ArmatureKeyFrame* keyframe, Armature* armature ) {
+	if( armature->rootBone == NULL ) {
+		printf( "Can't load animation %s without an armature\n", fileName );
+		return;
+	}
+	int64 fileSize = 0;
+	const char* fileText = (const char*)MapWholeFile( fileName, &fileSize );
+	if( fileText == NULL ) {
+		printf( "Could not load animation: %s\n", fileName );
+		return;
+	}
+
+	//Each animation holds an input and an output source and the channel naming the bone, the channel comes last.
+	//Containers that only hold other animations never see a channel, so nesting works out
+	const char* target = NULL;
+	const char* targetEnd = NULL;
+	uint32 sourceIndex = 0;
+	float rawTransformData[16] = { };
+
+	XmlReader reader = BeginXmlReader( fileText, fileSize );
+	while( NextXmlTag( &reader ) ) {
+		if( XmlTagIs( &reader, "animation" ) ) {
+			if( reader.isEndTag && target != NULL ) {
+				ApplyColladaAnimationChannel( fileName, keyframe, armature, target, targetEnd, rawTransformData );
+			}
+			target = NULL;
+			sourceIndex = 0;
+			memset( rawTransformData, 0, sizeof( rawTransformData ) );
+		} else if( reader.isEndTag ) {
+			continue;
+		} else if( XmlTagIs( &reader, "source" ) && XmlAncestorIs( &reader, 1, "animation" ) ) {
+			sourceIndex++;
+		} else if( XmlTagIs( &reader, "float_array" ) && XmlAncestorIs( &reader, 2, "animation" ) && sourceIndex == 2 ) {
+			//Only the first keyframe is used
+			uint32 count = GetXmlAttributeUInt32( &reader, "count" );
+			if( count > 16 ) count = 16;
+			CheckParsedCount( fileName, "animation matrix", ParseFloatArray( reader.text, reader.textEnd, rawTransformData, count ), count );
+		} else if( XmlTagIs( &reader, "channel" ) && XmlAncestorIs( &reader, 1, "animation" ) ) {
+			GetXmlAttribute( &reader, "target", &target, &targetEnd );
+		}
+	}
+	UnmapWholeFile( (void*)fileText, fileSize );
+
+
+	//Pre multiply bones with parents to save doing it during runtime
+	struct {
+		ArmatureKeyFrame* keyframe;
+		void PremultiplyKeyFrame( Bone* target, const Mat4& parentTransform ) {
+			BoneKeyFrame* boneKey = &keyframe->targetBoneTransforms[ target->boneIndex ];
+			Mat4 netMatrix = MultMatrix( boneKey->combinedMatrix, parentTransform );
+
+			for( uint8 boneIndex = 0; boneIndex < target->childCount; boneIndex++ ) {
+				PremultiplyKeyFrame( target->children[ boneIndex ], netMatrix );
+			}
+			boneKey->combinedMatrix = netMatrix;
+			DecomposeMat4( boneKey->combinedMatrix, &boneKey->scale, &boneKey->rotation, &boneKey->translation );
+		}
+	}LocalRecursiveScope;
+	LocalRecursiveScope.keyframe = keyframe;
+	Mat4 i; SetToIdentity( &i );
+	LocalRecursiveScope.PremultiplyKeyFrame( armature->rootBone, i );
+}
+
+void LoadTextureDataFromDisk( const char* fileName, TextureData* storage ) {
+    storage->data = (uint8*)stbi_load( fileName, (int*)&storage->width, (int*)&storage->height, (int*)&storage->channelsPerPixel, 0 );
+    if( storage->data == NULL ) {
+        printf( "Could not load file: %s\n", fileName );
+    }
+    printf( "Loaded file: %s\n", fileName );
+    printf( "Width: %d, Height: %d, Channel count: %d\n", storage->width, storage->height, storage->channelsPerPixel );
+}
+
+/*----------------------------------------------------------------------------------------
+                                 Binary mesh cache
+    One file per mesh: a header then 16 byte aligned arrays laid out exactly like
+    MeshGeometryData, so loading is a map and some pointer assignments. The armature is
+    stored with indices in place of pointers and rebuilt into the caller's Armature.
+    Little endian only, bump MESH_CACHE_VERSION whenever the layout or the cooking changes
+-----------------------------------------------------------------------------------------*/
+
+#define MESH_CACHE_MAGIC 0x48534D54 //"TMSH"
+#define MESH_CACHE_VERSION 2
+#define MESH_CACHE_EXTENSION ".mesh"
+#define MESH_CACHE_NO_PARENT 0xFF
+//The armature was parsed when cooking, boneCount can still be 0 for a mesh without a skeleton
+#define MESH_CACHE_HAS_ARMATURE 0x1
+
+struct MeshCacheHeader {
+	uint32 magic;
+	uint32 version;
+	//Source's modified time when cooked, a mismatch means the cache is stale
+	int64 sourceModifiedTime;
+	uint64 fileSize;
+	uint32 vertexCount;
+	uint32 indexCount;
+	uint32 bonesPerVertex;
+	uint32 boneCount;
+	uint32 flags;
+	uint32 padding;
+	//0 when the array isn't stored
+	uint64 vDataOffset;
+	uint64 uvDataOffset;
+	uint64 normalDataOffset;
+	uint64 boneWeightOffset;
+	uint64 boneIndexOffset;
+	uint64 iDataOffset;
+	uint64 bonesOffset;
+};
+
+struct MeshCacheBone {
+	Mat4 bindPose, invBindPose;
+	char name[32];
+	uint8 parentIndex;
+	uint8 childIndices[4];
+	uint8 childCount;
+};
+
+static uint64 MeshCacheReserve( uint64* cursor, uint64 bytes ) {
+	if( bytes == 0 ) return 0;
+	uint64 offset = ( *cursor + 15 ) & ~(uint64)15;
+	*cursor = offset + bytes;
+	return offset;
+}
+
+bool WriteMeshCache( const char* cacheFileName, int64 sourceModifiedTime, const MeshGeometryData* mesh, const Armature* armature ) {
+	uint32 vertexCount = mesh->vertexCount;
+	bool hasSkinning = mesh->boneWeightData != NULL && mesh->boneIndexData != NULL;
+	uint32 boneCount = armature != NULL ? armature->boneCount : 0;
+
+	MeshCacheHeader header = { };
+	header.magic = MESH_CACHE_MAGIC;
+	header.version = MESH_CACHE_VERSION;
+	header.sourceModifiedTime = sourceModifiedTime;
+	header.vertexCount = vertexCount;
+	header.indexCount = mesh->dataCount;
+	header.bonesPerVertex = MAXBONESPERVERT;
+	header.boneCount = boneCount;
+	header.flags = armature != NULL ? MESH_CACHE_HAS_ARMATURE : 0;
+
+	uint64 cursor = sizeof( MeshCacheHeader );
+	header.vDataOffset = MeshCacheReserve( &cursor, sizeof( Vec3 ) * vertexCount );
+	header.uvDataOffset = MeshCacheReserve( &cursor, sizeof( float ) * 2 * vertexCount );
+	header.normalDataOffset = MeshCacheReserve( &cursor, sizeof( Vec3 ) * vertexCount );
+	if( hasSkinning ) {
+		header.boneWeightOffset = MeshCacheReserve( &cursor, sizeof( float ) * MAXBONESPERVERT * vertexCount );
+		header.boneIndexOffset = MeshCacheReserve( &cursor, sizeof( uint32 ) * MAXBONESPERVERT * vertexCount );
+	}
+	header.iDataOffset = MeshCacheReserve( &cursor, sizeof( uint32 ) * header.indexCount );
+	header.bonesOffset = MeshCacheReserve( &cursor, sizeof( MeshCacheBone ) * boneCount );
+	header.fileSize = cursor;
+
+	uint8* fileData = (uint8*)AllocAssetMemory( header.fileSize );
+	if( fileData == NULL ) {
+		printf( "No room to build mesh cache %s\n", cacheFileName );
+		return false;
+	}
+	memset( fileData, 0, header.fileSize );
+	memcpy( fileData, &header, sizeof( MeshCacheHeader ) );
+	memcpy( fileData + header.vDataOffset, mesh->vData, sizeof( Vec3 ) * vertexCount );
+	memcpy( fileData + header.uvDataOffset, mesh->uvData, sizeof( float ) * 2 * vertexCount );
+	memcpy( fileData + header.normalDataOffset, mesh->normalData, sizeof( Vec3 ) * vertexCount );
+	if( hasSkinning ) {
+		memcpy( fileData + header.boneWeightOffset, mesh->boneWeightData, sizeof( float ) * MAXBONESPERVERT * vertexCount );
+		memcpy( fileData + header.boneIndexOffset, mesh->boneIndexData, sizeof( uint32 ) * MAXBONESPERVERT * vertexCount );
+	}
+	memcpy( fileData + header.iDataOffset, mesh->iData, sizeof( uint32 ) * header.indexCount );
+
+	MeshCacheBone* cacheBones = (MeshCacheBone*)( fileData + header.bonesOffset );
+	for( uint32 boneIndex = 0; boneIndex < boneCount; ++boneIndex ) {
+		const Bone* bone = &armature->bones[ boneIndex ];
+		MeshCacheBone* cacheBone = &cacheBones[ boneIndex ];
+		cacheBone->bindPose = bone->bindPose;
+		cacheBone->invBindPose = bone->invBindPose;
+		memcpy( cacheBone->name, bone->name, sizeof( cacheBone->name ) );
+		cacheBone->parentIndex = bone->parent != NULL ? bone->parent->boneIndex : MESH_CACHE_NO_PARENT;
+		cacheBone->childCount = bone->childCount;
+		for( uint8 childIndex = 0; childIndex < bone->childCount; ++childIndex ) {
+			cacheBone->childIndices[ childIndex ] = bone->children[ childIndex ]->boneIndex;
+		}
+	}
+
+	bool written = WriteWholeFile( cacheFileName, fileData, header.fileSize );
+	FreeAssetMemory( fileData );
+	return written;
+}
+
+bool LoadMeshCache( const char* cacheFileName, int64 sourceModifiedTime, MeshGeometryData* storage, Armature* armature ) {
+	int64 mappedSize = 0;
+	uint8* fileData = (uint8*)MapWholeFile( cacheFileName, &mappedSize );
+	if( fileData == NULL ) {
+		return false;
+	}
+
+	if( mappedSize < (int64)sizeof( MeshCacheHeader ) ) {
+		UnmapWholeFile( fileData, mappedSize );
+		return false;
+	}
+	MeshCacheHeader* header = (MeshCacheHeader*)fileData;
+	bool valid = header->magic == MESH_CACHE_MAGIC &&
+		header->version == MESH_CACHE_VERSION && header->fileSize == (uint64)mappedSize &&
+		header->bonesPerVertex == MAXBONESPERVERT && header->boneCount <= MAXBONES;
+	//No source on disk means a shipped cache, anything else has to match what it was cooked from
+	if( valid && sourceModifiedTime != 0 && header->sourceModifiedTime != sourceModifiedTime ) {
+		valid = false;
+	}
+	if( valid && armature != NULL && ( header->flags & MESH_CACHE_HAS_ARMATURE ) == 0 ) {
+		valid = false;
+	}
+	//Every array has to sit inside the file, a truncated or hand edited cache just gets recooked
+	struct { uint64 offset; uint64 bytes; bool required; } ranges[] = {
+		{ header->vDataOffset, sizeof( Vec3 ) * (uint64)header->vertexCount, true },
+		{ header->uvDataOffset, sizeof( float ) * 2 * (uint64)header->vertexCount, true },
+		{ header->normalDataOffset, sizeof( Vec3 ) * (uint64)header->vertexCount, true },
+		{ header->boneWeightOffset, sizeof( float ) * MAXBONESPERVERT * (uint64)header->vertexCount, false },
+		{ header->boneIndexOffset, sizeof( uint32 ) * MAXBONESPERVERT * (uint64)header->vertexCount, false },
+		{ header->iDataOffset, sizeof( uint32 ) * (uint64)header->indexCount, true },
+		{ header->bonesOffset, sizeof( MeshCacheBone ) * (uint64)header->boneCount, false }
+	};
+	for( uint32 rangeIndex = 0; valid && rangeIndex < sizeof( ranges ) / sizeof( ranges[0] ); ++rangeIndex ) {
+		if( ranges[ rangeIndex ].offset == 0 ) {
+			valid = !ranges[ rangeIndex ].required || ranges[ rangeIndex ].bytes == 0;
+			continue;
+		}
+		valid = ( ranges[ rangeIndex ].offset & 15 ) == 0 && ranges[ rangeIndex ].offset >= sizeof( MeshCacheHeader ) &&
+			ranges[ rangeIndex ].offset + ranges[ rangeIndex ].bytes <= (uint64)mappedSize;
+	}
+	if( !valid ) {
+		UnmapWholeFile( fileData, mappedSize );
+		return false;
+	}
+
+	storage->vData = (Vec3*)( fileData + header->vDataOffset );
+	storage->uvData = (float*)( fileData + header->uvDataOffset );
+	storage->normalData = (Vec3*)( fileData + header->normalDataOffset );
+	storage->boneWeightData = header->boneWeightOffset != 0 ? (float*)( fileData + header->boneWeightOffset ) : NULL;
+	storage->boneIndexData = header->boneIndexOffset != 0 ? (uint32*)( fileData + header->boneIndexOffset ) : NULL;
+	storage->iData = (uint32*)( fileData + header->iDataOffset );
+	storage->dataCount = header->indexCount;
+	storage->vertexCount = header->vertexCount;
+	storage->mappedFile = fileData;
+	storage->mappedSize = mappedSize;
+
+	if( armature != NULL ) {
+		MeshCacheBone* cacheBones = (MeshCacheBone*)( fileData + header->bonesOffset );
+		armature->boneCount = header->boneCount;
+		armature->rootBone = NULL;
+		for( uint8 boneIndex = 0; boneIndex < armature->boneCount; ++boneIndex ) {
+			MeshCacheBone* cacheBone = &cacheBones[ boneIndex ];
+			Bone* bone = &armature->bones[ boneIndex ];
+			bone->bindPose = cacheBone->bindPose;
+			bone->invBindPose = cacheBone->invBindPose;
+			memcpy( bone->name, cacheBone->name, sizeof( bone->name ) );
+			bone->name[ sizeof( bone->name ) - 1 ] = 0;
+			bone->boneIndex = boneIndex;
+			bone->currentTransform = &armature->boneTransforms[ boneIndex ];
+			SetToIdentity( bone->currentTransform );
+			bone->parent = cacheBone->parentIndex < armature->boneCount ? &armature->bones[ cacheBone->parentIndex ] : NULL;
+			if( bone->parent == NULL && armature->rootBone == NULL ) {
+				armature->rootBone = bone;
+			}
+			bone->childCount = 0;
+			for( uint8 childIndex = 0; childIndex < cacheBone->childCount && childIndex < 4; ++childIndex ) {
+				if( cacheBone->childIndices[ childIndex ] < armature->boneCount ) {
+					bone->children[ bone->childCount++ ] = &armature->bones[ cacheBone->childIndices[ childIndex ] ];
+				}
+			}
+		}
+	}
+	return true;
+}
+
+void ReleaseMeshCache( MeshGeometryData* storage ) {
+	if( storage->mappedFile == NULL ) return;
+	UnmapWholeFile( storage->mappedFile, storage->mappedSize );
+	memset( storage, 0, sizeof( MeshGeometryData ) );
+}
+
+static bool GetMeshCacheFileName( const char* fileName, char* cacheFileName, size_t bufferSize ) {
+	return snprintf( cacheFileName, bufferSize, "%s" MESH_CACHE_EXTENSION, fileName ) < (int)bufferSize;
+}
+
+bool CookMeshCache( const char* fileName, SlabSubsection_Stack* allocater ) {
+	char cacheFileName[ 512 ];
+	if( !GetMeshCacheFileName( fileName, cacheFileName, sizeof( cacheFileName ) ) ) {
+		printf( "Path too long to cook: %s\n", fileName );
+		return false;
+	}
+	int64 sourceModifiedTime = GetFileModifiedTime( fileName );
+	if( sourceModifiedTime == 0 ) {
+		printf( "Could not open mesh %s\n", fileName );
+		return false;
+	}
+	//Too big for the stack, and the cooker only ever runs one at a time
+	static Armature armature;
+	memset( &armature, 0, sizeof( Armature ) );
+	MeshGeometryData mesh = { };
+	if( !LoadMeshDataFromDisk( fileName, allocater, &mesh, &armature ) ) {
+		return false;
+	}
+	return WriteMeshCache( cacheFileName, sourceModifiedTime, &mesh, &armature );
+}
+
+void LoadMeshData( const char* fileName, SlabSubsection_Stack* allocater, MeshGeometryData* storage, Armature* armature ) {
+	char cacheFileName[ 512 ];
+	if( !GetMeshCacheFileName( fileName, cacheFileName, sizeof( cacheFileName ) ) ) {
+		LoadMeshDataFromDisk( fileName, allocater, storage, armature );
+		return;
+	}
+
+	int64 sourceModifiedTime = GetFileModifiedTime( fileName );
+	if( LoadMeshCache( cacheFileName, sourceModifiedTime, storage, armature ) ) {
+		return;
+	}
+	if( !LoadMeshDataFromDisk( fileName, allocater, storage, armature ) ) {
+		return;
+	}
+	if( WriteMeshCache( cacheFileName, sourceModifiedTime, storage, armature ) ) {
+		printf( "Cooked mesh cache %s\n", cacheFileName );
+	}
+}
+
+/*----------------------------------------------------------------------------------------
+                       Local Functions only to be used in this file
+------------------------------------------------------------------------------------------*/
+
+/*
+    Numeric arrays come straight out of the document's text, no copies and no per token buffers.
+    Tokens are whitespace separated, parsing stops at the first one that isn't a whole number or
+    once maxCount values are written. Floats take a from_chars style fast path (exact integer
+    mantissa times an exact power of ten, one rounding) and fall back to strtof for the rest, so
+    results match strtof bit for bit
+*/
+
+#if defined( MATH3D_SSE ) && ( defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 ) )
+	#define TEXT_PARSE_SSE2
+	#include <emmintrin.h>
+#endif
+
+static inline bool IsTextWhitespace( char c ) {
+	return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+#ifdef TEXT_PARSE_SSE2
+static inline uint32 LowestSetBit( uint32 value ) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward( &index, value );
+	return index;
+#else
+	return __builtin_ctz( value );
+#endif
+}
+
+///Bit n set when byte n of the 16 at text is whitespace
+static inline uint32 WhitespaceMask16( const char* text ) {
+	__m128i bytes = _mm_loadu_si128( (const __m128i*)text );
+	__m128i spaces = _mm_or_si128( _mm_cmpeq_epi8( bytes, _mm_set1_epi8( ' ' ) ), _mm_cmpeq_epi8( bytes, _mm_set1_epi8( '\n' ) ) );
+	__m128i others = _mm_or_si128( _mm_cmpeq_epi8( bytes, _mm_set1_epi8( '\r' ) ), _mm_cmpeq_epi8( bytes, _mm_set1_epi8( '\t' ) ) );
+	return (uint32)_mm_movemask_epi8( _mm_or_si128( spaces, others ) );
+}
+#endif
+
+static const char* SkipTextWhitespace( const char* text, const char* textEnd ) {
+#ifdef TEXT_PARSE_SSE2
+	//Pretty printed exports put long indented runs between rows
+	while( textEnd - text >= 16 ) {
+		uint32 notWhitespace = ~WhitespaceMask16( text ) & 0xFFFF;
+		if( notWhitespace != 0 ) return text + LowestSetBit( notWhitespace );
+		text += 16;
+	}
+#endif
+	while( text < textEnd && IsTextWhitespace( *text ) ) text++;
+	return text;
+}
+
+static const char* FindTokenEnd( const char* text, const char* textEnd ) {
+#ifdef TEXT_PARSE_SSE2
+	while( textEnd - text >= 16 ) {
+		uint32 whitespace = WhitespaceMask16( text );
+		if( whitespace != 0 ) return text + LowestSetBit( whitespace );
+		text += 16;
+	}
+#endif
+	while( text < textEnd && !IsTextWhitespace( *text ) ) text++;
+	return text;
+}
+
+static bool ParseFloatTokenSlow( const char* token, const char* tokenEnd, float* out ) {
+	char buffer[64];
+	size_t length = tokenEnd - token;
+	if( length == 0 || length >= sizeof( buffer ) ) return false;
+	memcpy( buffer, token, length );
+	buffer[ length ] = 0;
+	char* parseEnd = NULL;
+	float value = strtof( buffer, &parseEnd );
+	if( parseEnd != buffer + length ) return false;
+	*out = value;
+	return true;
+}
+
+static bool ParseFloatToken( const char* token, const char* tokenEnd, float* out ) {
+	static const float floatPowersOfTen[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+	static const double doublePowersOfTen[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+	const char* cursor = token;
+	bool negative = false;
+	if( cursor < tokenEnd && ( *cursor == '-' || *cursor == '+' ) ) {
+		negative = *cursor == '-';
+		cursor++;
+	}
+
+	//Up to 19 significant digits fit in the mantissa, past that it's strtof's problem
+	uint64 mantissa = 0;
+	int32 exponent = 0;
+	uint32 significantDigits = 0;
+	bool sawDigit = false;
+	bool truncated = false;
+	while( cursor < tokenEnd && (uint8)( *cursor - '0' ) < 10 ) {
+		if( significantDigits < 19 ) {
+			mantissa = mantissa * 10 + ( *cursor - '0' );
+			if( mantissa != 0 ) significantDigits++;
+		} else {
+			exponent++;
+			truncated = true;
+		}
+		sawDigit = true;
+		cursor++;
+	}
+	if( cursor < tokenEnd && *cursor == '.' ) {
+		cursor++;
+		while( cursor < tokenEnd && (uint8)( *cursor - '0' ) < 10 ) {
+			if( significantDigits < 19 ) {
+				mantissa = mantissa * 10 + ( *cursor - '0' );
+				if( mantissa != 0 ) significantDigits++;
+				exponent--;
+			} else {
+				truncated = true;
+			}
+			sawDigit = true;
+			cursor++;
+		}
+	}
+	if( sawDigit && cursor < tokenEnd && ( *cursor == 'e' || *cursor == 'E' ) ) {
+		cursor++;
+		bool exponentNegative = false;
+		if( cursor < tokenEnd && ( *cursor == '-' || *cursor == '+' ) ) {
+			exponentNegative = *cursor == '-';
+			cursor++;
+		}
+		int32 exponentValue = 0;
+		bool sawExponentDigit = false;
+		while( cursor < tokenEnd && (uint8)( *cursor - '0' ) < 10 ) {
+			if( exponentValue < 10000 ) exponentValue = exponentValue * 10 + ( *cursor - '0' );
+			sawExponentDigit = true;
+			cursor++;
+		}
+		if( !sawExponentDigit ) return ParseFloatTokenSlow( token, tokenEnd, out );
+		exponent += exponentNegative ? -exponentValue : exponentValue;
+	}
+	//inf, nan, hex floats and anything odd
+	if( !sawDigit || cursor != tokenEnd || truncated ) {
+		return ParseFloatTokenSlow( token, tokenEnd, out );
+	}
+
+	if( mantissa == 0 ) {
+		*out = negative ? -0.0f : 0.0f;
+		return true;
+	}
+	//Both operands exact in float, so the one multiply or divide rounds correctly
+	if( mantissa <= ( 1ULL << 24 ) && exponent >= -10 && exponent <= 10 ) {
+		float value = (float)mantissa;
+		value = exponent < 0 ? value / floatPowersOfTen[ -exponent ] : value * floatPowersOfTen[ exponent ];
+		*out = negative ? -value : value;
+		return true;
+	}
+	//Same in double, then one more rounding down to float
+	if( mantissa <= ( 1ULL << 53 ) && exponent >= -22 && exponent <= 22 ) {
+		double value = (double)mantissa;
+		value = exponent < 0 ? value / doublePowersOfTen[ -exponent ] : value * doublePowersOfTen[ exponent ];
+		uint64 bits;
+		memcpy( &bits, &value, sizeof( bits ) );
+		//Landing exactly halfway between two floats could round the wrong way the second time
+		if( ( bits & 0x1FFFFFFF ) != 0x10000000 ) {
+			*out = negative ? -(float)value : (float)value;
+			return true;
+		}
+	}
+	return ParseFloatTokenSlow( token, tokenEnd, out );
+}
+
+static bool ParseUInt32Token( const char* token, const char* tokenEnd, uint32* out ) {
+	const char* cursor = token;
+	if( cursor < tokenEnd && *cursor == '+' ) cursor++;
+	if( cursor == tokenEnd ) return false;
+	uint64 value = 0;
+	while( cursor < tokenEnd ) {
+		uint8 digit = (uint8)( *cursor - '0' );
+		if( digit >= 10 ) return false;
+		value = value * 10 + digit;
+		if( value > 0xFFFFFFFF ) return false;
+		cursor++;
+	}
+	*out = (uint32)value;
+	return true;
+}
+
+static uint32 ParseFloatArray( const char* text, const char* textEnd, float* numbersOut, uint32 maxCount ) {
+	uint32 count = 0;
+	text = SkipTextWhitespace( text, textEnd );
+	while( text < textEnd && count < maxCount ) {
+		const char* tokenEnd = FindTokenEnd( text, textEnd );
+		if( !ParseFloatToken( text, tokenEnd, &numbersOut[ count ] ) ) break;
+		count++;
+		text = SkipTextWhitespace( tokenEnd, textEnd );
+	}
+	return count;
+}
+
+static uint32 ParseUInt32Array( const char* text, const char* textEnd, uint32* numbersOut, uint32 maxCount ) {
+	uint32 count = 0;
+	text = SkipTextWhitespace( text, textEnd );
+	while( text < textEnd && count < maxCount ) {
+		const char* tokenEnd = FindTokenEnd( text, textEnd );
+		if( !ParseUInt32Token( text, tokenEnd, &numbersOut[ count ] ) ) break;
+		count++;
+		text = SkipTextWhitespace( tokenEnd, textEnd );
+	}
+	return count;
+}
+
+static void CheckParsedCount( const char* fileName, const char* arrayName, uint32 parsedCount, uint32 expectedCount ) {
+	if( parsedCount != expectedCount ) {
+		printf( "%s: read %u of %u values for %s\n", fileName, parsedCount, expectedCount, arrayName );
+	}
+}
+
+static XmlReader BeginXmlReader( const char* text, int64 length ) {
+	XmlReader reader = { };
+	reader.cursor = text;
+	reader.end = text + length;
+	return reader;
+}
+
+static bool XmlNameIs( const char* name, uint32 nameLength, const char* expected ) {
+	size_t expectedLength = strlen( expected );
+	return nameLength == expectedLength && memcmp( name, expected, expectedLength ) == 0;
+}
+
+static const char* FindText( const char* text, const char* textEnd, const char* pattern ) {
+	size_t patternLength = strlen( pattern );
+	while( (size_t)( textEnd - text ) >= patternLength ) {
+		const char* candidate = (const char*)memchr( text, pattern[0], textEnd - text );
+		if( candidate == NULL || (size_t)( textEnd - candidate ) < patternLength ) return NULL;
+		if( memcmp( candidate, pattern, patternLength ) == 0 ) return candidate;
+		text = candidate + 1;
+	}
+	return NULL;
+}
+
+static bool NextXmlTag( XmlReader* reader ) {
+	//A start tag's element stays open until its end tag turns up
+	if( reader->startTagPending ) {
+		if( reader->depth < XML_MAX_DEPTH ) {
+			reader->openNames[ reader->depth ] = reader->name;
+			reader->openNameLengths[ reader->depth ] = reader->nameLength;
+		}
+		reader->depth++;
+		reader->startTagPending = false;
+	}
+	reader->text = NULL;
+	reader->textEnd = NULL;
+
+	while( reader->cursor < reader->end ) {
+		const char* tagStart = (const char*)memchr( reader->cursor, '<', reader->end - reader->cursor );
+		if( tagStart == NULL ) break;
+		const char* cursor = tagStart + 1;
+		if( cursor >= reader->end ) break;
+
+		//Declarations, processing instructions, comments and CDATA hold nothing the loaders read
+		if( *cursor == '?' || *cursor == '!' ) {
+			const char* closer = *cursor == '?' ? "?>" : ">";
+			size_t remaining = reader->end - cursor;
+			if( remaining >= 3 && memcmp( cursor, "!--", 3 ) == 0 ) {
+				closer = "-->";
+				cursor += 3;
+			} else if( remaining >= 8 && memcmp( cursor, "![CDATA[", 8 ) == 0 ) {
+				closer = "]]>";
+				cursor += 8;
+			}
+			const char* skipEnd = FindText( cursor, reader->end, closer );
+			if( skipEnd == NULL ) break;
+			reader->cursor = skipEnd + strlen( closer );
+			continue;
+		}
+
+		bool isEndTag = *cursor == '/';
+		if( isEndTag ) cursor++;
+		const char* nameStart = cursor;
+		while( cursor < reader->end && !IsTextWhitespace( *cursor ) && *cursor != '>' && *cursor != '/' ) cursor++;
+		const char* attributes = cursor;
+		//Quoted attribute values are allowed to hold '>'
+		char quote = 0;
+		while( cursor < reader->end && ( quote != 0 || *cursor != '>' ) ) {
+			if( quote != 0 ) {
+				if( *cursor == quote ) quote = 0;
+			} else if( *cursor == '"' || *cursor == '\'' ) {
+				quote = *cursor;
+			}
+			cursor++;
+		}
+		//Truncated file
+		if( cursor >= reader->end ) break;
+
+		reader->name = nameStart;
+		reader->nameLength = (uint32)( attributes - nameStart );
+		reader->isEndTag = isEndTag;
+		reader->isEmptyElement = !isEndTag && cursor[-1] == '/';
+		reader->attributes = attributes;
+		reader->attributesEnd = reader->isEmptyElement ? cursor - 1 : cursor;
+		reader->cursor = cursor + 1;
+		if( isEndTag ) {
+			if( reader->depth > 0 ) reader->depth--;
+		} else if( !reader->isEmptyElement ) {
+			//Next search starts at the end of the text, so big arrays are only scanned once for the tag
+			const char* textEnd = (const char*)memchr( reader->cursor, '<', reader->end - reader->cursor );
+			reader->text = reader->cursor;
+			reader->textEnd = textEnd != NULL ? textEnd : reader->end;
+			reader->cursor = reader->textEnd;
+			reader->startTagPending = true;
+		}
+		return true;
+	}
+	reader->cursor = reader->end;
+	return false;
+}
+
+static bool XmlTagIs( const XmlReader* reader, const char* tagName ) {
+	return XmlNameIs( reader->name, reader->nameLength, tagName );
+}
+
+static bool XmlAncestorIs( const XmlReader* reader, uint32 levelsUp, const char* tagName ) {
+	if( levelsUp == 0 || levelsUp > reader->depth ) return false;
+	uint32 index = reader->depth - levelsUp;
+	if( index >= XML_MAX_DEPTH ) return false;
+	return XmlNameIs( reader->openNames[ index ], reader->openNameLengths[ index ], tagName );
+}
+
+static bool GetXmlAttribute( const XmlReader* reader, const char* attributeName, const char** value, const char** valueEnd ) {
+	const char* cursor = reader->attributes;
+	const char* end = reader->attributesEnd;
+	while( cursor < end ) {
+		cursor = SkipTextWhitespace( cursor, end );
+		const char* nameStart = cursor;
+		while( cursor < end && *cursor != '=' && !IsTextWhitespace( *cursor ) ) cursor++;
+		const char* nameEnd = cursor;
+		cursor = SkipTextWhitespace( cursor, end );
+		if( cursor >= end || *cursor != '=' ) return false;
+		cursor = SkipTextWhitespace( cursor + 1, end );
+		if( cursor >= end || ( *cursor != '"' && *cursor != '\'' ) ) return false;
+		char quote = *cursor++;
+		const char* valueStart = cursor;
+		cursor = (const char*)memchr( cursor, quote, end - cursor );
+		if( cursor == NULL ) return false;
+		if( XmlNameIs( nameStart, (uint32)( nameEnd - nameStart ), attributeName ) ) {
+			*value = valueStart;
+			*valueEnd = cursor;
+			return true;
+		}
+		cursor++;
+	}
+	return false;
+}
+
+static bool XmlAttributeIs( const XmlReader* reader, const char* attributeName, const char* expected ) {
+	const char* value = NULL;
+	const char* valueEnd = NULL;
+	if( !GetXmlAttribute( reader, attributeName, &value, &valueEnd ) ) return false;
+	return XmlNameIs( value, (uint32)( valueEnd - value ), expected );
+}
+
+static uint32 GetXmlAttributeUInt32( const XmlReader* reader, const char* attributeName ) {
+	const char* value = NULL;
+	const char* valueEnd = NULL;
+	uint32 number = 0;
+	if( GetXmlAttribute( reader, attributeName, &value, &valueEnd ) ) {
+		ParseUInt32Array( value, valueEnd, &number, 1 );
+	}
+	return number;
+}
+
+static float* ParseColladaFloats( const char* fileName, const char* arrayName, const XmlReader* reader, uint32 count ) {
+	if( count == 0 ) return NULL;
+	float* numbers = (float*)AllocAssetMemory( sizeof( float ) * (uint64)count );
+	if( numbers == NULL ) {
+		printf( "%s: no room in the asset heap for %u %s\n", fileName, count, arrayName );
+		return NULL;
+	}
+	uint32 parsedCount = ParseFloatArray( reader->text, reader->textEnd, numbers, count );
+	CheckParsedCount( fileName, arrayName, parsedCount, count );
+	//Anything short is left zeroed
+	memset( numbers + parsedCount, 0, sizeof( float ) * (uint64)( count - parsedCount ) );
+	return numbers;
+}
+
+static uint32* ParseColladaUInt32s( const char* fileName, const char* arrayName, const XmlReader* reader, uint32 count ) {
+	if( count == 0 ) return NULL;
+	uint32* numbers = (uint32*)AllocAssetMemory( sizeof( uint32 ) * (uint64)count );
+	if( numbers == NULL ) {
+		printf( "%s: no room in the asset heap for %u %s\n", fileName, count, arrayName );
+		return NULL;
+	}
+	uint32 parsedCount = ParseUInt32Array( reader->text, reader->textEnd, numbers, count );
+	CheckParsedCount( fileName, arrayName, parsedCount, count );
+	memset( numbers + parsedCount, 0, sizeof( uint32 ) * (uint64)( count - parsedCount ) );
+	return numbers;
+}
+
+static void FreeColladaMeshArrays( ColladaMeshArrays* arrays ) {
+	FreeAssetMemory( arrays->positions );
+	FreeAssetMemory( arrays->normals );
+	FreeAssetMemory( arrays->uvs );
+	FreeAssetMemory( arrays->indices );
+	FreeAssetMemory( arrays->inverseBindPoses );
+	FreeAssetMemory( arrays->weights );
+	FreeAssetMemory( arrays->influenceCounts );
+	FreeAssetMemory( arrays->influences );
+	FreeAssetMemory( arrays->vertexBoneWeights );
+	FreeAssetMemory( arrays->vertexBoneIndices );
+	memset( arrays, 0, sizeof( ColladaMeshArrays ) );
+}
+
+static Bone* FindBoneByName( Armature* armature, const char* name, const char* nameEnd ) {
+	for( uint8 boneIndex = 0; boneIndex < armature->boneCount; boneIndex++ ) {
+		Bone* bone = &armature->bones[ boneIndex ];
+		if( XmlNameIs( name, (uint32)( nameEnd - name ), bone->name ) ) {
+			return bone;
+		}
+	}
+	return NULL;
+}
+
+static void ReadColladaCorner( const ColladaMeshArrays* raw, uint32 corner, ColladaVertex* vertex ) {
+	memset( vertex, 0, sizeof( ColladaVertex ) );
+	uint32 vertIndex = raw->indices[ corner * 3 + 0 ];
+	uint32 normalIndex = raw->indices[ corner * 3 + 1 ];
+	uint32 uvIndex = raw->indices[ corner * 3 + 2 ];
+	//Out of range indices (bad export or short parse) read the first element instead of past the array
+	if( vertIndex >= raw->positionCount / 3 ) vertIndex = 0;
+	if( (uint64)normalIndex * 3 + 2 >= raw->normalCount ) normalIndex = 0;
+	if( (uint64)uvIndex * 2 + 1 >= raw->uvCount ) uvIndex = 0;
+
+	vertex->position.x = raw->positions[ vertIndex * 3 + 0 ];
+	vertex->position.z = -raw->positions[ vertIndex * 3 + 1 ];
+	vertex->position.y = raw->positions[ vertIndex * 3 + 2 ];
+	if( raw->normalCount >= 3 ) {
+		vertex->normal.x = raw->normals[ normalIndex * 3 + 0 ];
+		vertex->normal.z = -raw->normals[ normalIndex * 3 + 1 ];
+		vertex->normal.y = raw->normals[ normalIndex * 3 + 2 ];
+	}
+	if( raw->uvCount >= 2 ) {
+		vertex->uv[0] = raw->uvs[ uvIndex * 2 ];
+		vertex->uv[1] = raw->uvs[ uvIndex * 2 + 1 ];
+	}
+	if( raw->vertexBoneWeights != NULL ) {
+		memcpy( vertex->boneWeights, &raw->vertexBoneWeights[ vertIndex * MAXBONESPERVERT ], sizeof( vertex->boneWeights ) );
+		memcpy( vertex->boneIndices, &raw->vertexBoneIndices[ vertIndex * MAXBONESPERVERT ], sizeof( vertex->boneIndices ) );
+	}
+}
+
+static uint32 HashColladaVertex( const ColladaVertex* vertex ) {
+	const uint32* words = (const uint32*)vertex;
+	uint32 hash = 2166136261u;
+	for( uint32 i = 0; i < sizeof( ColladaVertex ) / sizeof( uint32 ); i++ ) {
+		hash = ( hash ^ words[i] ) * 16777619u;
+	}
+	//FNV alone leaves the low bits, which pick the slot, depending only on the low bits of each word
+	hash ^= hash >> 16;
+	hash *= 0x85EBCA6B;
+	hash ^= hash >> 13;
+	return hash;
+}
+
+static uint32 WeldColladaCorners( const ColladaMeshArrays* raw, uint32 cornerCount, uint32* indicesOut, uint32* vertexCorners ) {
+	struct WeldSlot {
+		uint32 hash;
+		//Vertex index + 1, 0 for an empty slot
+		uint32 vertex;
+	};
+	//Open addressing at half load or less
+	uint64 slotCount = 16;
+	while( slotCount < (uint64)cornerCount * 2 ) slotCount <<= 1;
+	WeldSlot* slots = (WeldSlot*)AllocAssetMemory( sizeof( WeldSlot ) * slotCount );
+	if( slots == NULL ) {
+		printf( "No room in the asset heap to weld %u vertices, leaving them unshared\n", cornerCount );
+		for( uint32 corner = 0; corner < cornerCount; corner++ ) {
+			indicesOut[ corner ] = corner;
+			vertexCorners[ corner ] = corner;
+		}
+		return cornerCount;
+	}
+	memset( slots, 0, sizeof( WeldSlot ) * slotCount );
+
+	uint32 vertexCount = 0;
+	const uint64 slotMask = slotCount - 1;
+	for( uint32 corner = 0; corner < cornerCount; corner++ ) {
+		ColladaVertex vertex;
+		ReadColladaCorner( raw, corner, &vertex );
+		uint32 hash = HashColladaVertex( &vertex );
+		uint64 slot = hash & slotMask;
+		uint32 match = 0;
+		while( slots[ slot ].vertex != 0 ) {
+			if( slots[ slot ].hash == hash ) {
+				ColladaVertex existing;
+				ReadColladaCorner( raw, vertexCorners[ slots[ slot ].vertex - 1 ], &existing );
+				if( memcmp( &vertex, &existing, sizeof( ColladaVertex ) ) == 0 ) {
+					match = slots[ slot ].vertex;
+					break;
+				}
+			}
+			slot = ( slot + 1 ) & slotMask;
+		}
+		if( match == 0 ) {
+			vertexCorners[ vertexCount ] = corner;
+			match = ++vertexCount;
+			slots[ slot ].hash = hash;
+			slots[ slot ].vertex = match;
+		}
+		indicesOut[ corner ] = match - 1;
+	}
+
+	FreeAssetMemory( slots );
+	return vertexCount;
+}
+
+/*
+    Tom Forsyth's linear speed vertex cache optimisation. Triangles are emitted greedily by score, a vertex scores
+    higher the more recently it went through a simulated LRU cache and the fewer triangles it has left, so
+    nearly finished vertices get used up before they're evicted. Only triangles touching the cache are rescored
+    after each pick, when none of them are left the next unemitted triangle in the original order is taken
+*/
+#define VERTEX_CACHE_SIZE 32
+#define VERTEX_CACHE_VALENCE_TABLE_SIZE 32
+
+static void OptimizeVertexCacheOrder( uint32* indices, uint32 indexCount, uint32 vertexCount ) {
+	const uint32 noTriangle = 0xFFFFFFFF;
+	uint32 triangleCount = indexCount / 3;
+	if( triangleCount < 2 ) return;
+
+	//Vertices in the last triangle get a fixed score a bit lower than the next few slots, otherwise the order
+	//zig zags back over the same strip
+	float cachePositionScores[ VERTEX_CACHE_SIZE ];
+	for( uint32 position = 0; position < VERTEX_CACHE_SIZE; position++ ) {
+		if( position < 3 ) {
+			cachePositionScores[ position ] = 0.75f;
+		} else {
+			float scaler = 1.0f - (float)( position - 3 ) / (float)( VERTEX_CACHE_SIZE - 3 );
+			cachePositionScores[ position ] = powf( scaler, 1.5f );
+		}
+	}
+	float valenceScores[ VERTEX_CACHE_VALENCE_TABLE_SIZE ];
+	valenceScores[0] = 0.0f;
+	for( uint32 valence = 1; valence < VERTEX_CACHE_VALENCE_TABLE_SIZE; valence++ ) {
+		valenceScores[ valence ] = 2.0f / sqrtf( (float)valence );
+	}
+	auto ScoreVertex = [&]( int32 cachePosition, uint32 liveTriangles ) -> float {
+		if( liveTriangles == 0 ) return -1.0f;
+		float score = cachePosition >= 0 ? cachePositionScores[ cachePosition ] : 0.0f;
+		return score + ( liveTriangles < VERTEX_CACHE_VALENCE_TABLE_SIZE ? valenceScores[ liveTriangles ] : 2.0f / sqrtf( (float)liveTriangles ) );
+	};
+
+	uint32* adjacencyOffsets = (uint32*)AllocAssetMemory( sizeof( uint32 ) * ( (uint64)vertexCount + 1 ) );
+	uint32* liveTriangles = (uint32*)AllocAssetMemory( sizeof( uint32 ) * (uint64)vertexCount );
+	uint32* adjacency = (uint32*)AllocAssetMemory( sizeof( uint32 ) * (uint64)indexCount );
+	int32* cachePositions = (int32*)AllocAssetMemory( sizeof( int32 ) * (uint64)vertexCount );
+	float* vertexScores = (float*)AllocAssetMemory( sizeof( float ) * (uint64)vertexCount );
+	uint8* triangleEmitted = (uint8*)AllocAssetMemory( sizeof( uint8 ) * (uint64)triangleCount );
+	uint32* optimized = (uint32*)AllocAssetMemory( sizeof( uint32 ) * (uint64)indexCount );
+	if( adjacencyOffsets == NULL || liveTriangles == NULL || adjacency == NULL || cachePositions == NULL ||
+		vertexScores == NULL || triangleEmitted == NULL || optimized == NULL ) {
+		printf( "No room in the asset heap to optimize %u triangles, keeping their order\n", triangleCount );
+		goto cleanup;
+	}
+
+	//Each vertex's triangles, live ones first. Emitting a triangle swaps it past the end of the live range
+	memset( liveTriangles, 0, sizeof( uint32 ) * vertexCount );
+	for( uint32 i = 0; i < indexCount; i++ ) {
+		liveTriangles[ indices[i] ]++;
+	}
+	adjacencyOffsets[0] = 0;
+	for( uint32 vertex = 0; vertex < vertexCount; vertex++ ) {
+		adjacencyOffsets[ vertex + 1 ] = adjacencyOffsets[ vertex ] + liveTriangles[ vertex ];
+		liveTriangles[ vertex ] = 0;
+	}
+	for( uint32 i = 0; i < indexCount; i++ ) {
+		uint32 vertex = indices[i];
+		adjacency[ adjacencyOffsets[ vertex ] + liveTriangles[ vertex ]++ ] = i / 3;
+	}
+
+	for( uint32 vertex = 0; vertex < vertexCount; vertex++ ) {
+		cachePositions[ vertex ] = -1;
+		vertexScores[ vertex ] = ScoreVertex( -1, liveTriangles[ vertex ] );
+	}
+	{
+		uint32 bestTriangle = 0;
+		float bestScore = -1.0f;
+		for( uint32 triangle = 0; triangle < triangleCount; triangle++ ) {
+			const uint32* corners = &indices[ triangle * 3 ];
+			float score = vertexScores[ corners[0] ] + vertexScores[ corners[1] ] + vertexScores[ corners[2] ];
+			if( score > bestScore ) {
+				bestScore = score;
+				bestTriangle = triangle;
+			}
+		}
+		memset( triangleEmitted, 0, sizeof( uint8 ) * triangleCount );
+
+		uint32 cache[ VERTEX_CACHE_SIZE + 3 ];
+		uint32 cacheCount = 0;
+		uint32 scanCursor = 0;
+		for( uint32 emitted = 0; emitted < triangleCount; emitted++ ) {
+			if( bestTriangle == noTriangle ) {
+				while( triangleEmitted[ scanCursor ] ) scanCursor++;
+				bestTriangle = scanCursor;
+			}
+			const uint32* corners = &indices[ bestTriangle * 3 ];
+			optimized[ emitted * 3 + 0 ] = corners[0];
+			optimized[ emitted * 3 + 1 ] = corners[1];
+			optimized[ emitted * 3 + 2 ] = corners[2];
+			triangleEmitted[ bestTriangle ] = 1;
+
+			for( uint8 corner = 0; corner < 3; corner++ ) {
+				uint32 vertex = corners[ corner ];
+				uint32* vertexTriangles = &adjacency[ adjacencyOffsets[ vertex ] ];
+				uint32 liveCount = liveTriangles[ vertex ];
+				for( uint32 i = 0; i < liveCount; i++ ) {
+					if( vertexTriangles[i] == bestTriangle ) {
+						vertexTriangles[i] = vertexTriangles[ liveCount - 1 ];
+						vertexTriangles[ liveCount - 1 ] = bestTriangle;
+						liveTriangles[ vertex ]--;
+						break;
+					}
+				}
+			}
+
+			//The emitted triangle's vertices move to the front, everything else shifts back and may fall off the end
+			uint32 newCache[ VERTEX_CACHE_SIZE + 3 ];
+			uint32 newCount = 0;
+			for( uint8 corner = 0; corner < 3; corner++ ) {
+				uint32 vertex = corners[ corner ];
+				if( newCount > 0 && newCache[0] == vertex ) continue;
+				if( newCount > 1 && newCache[1] == vertex ) continue;
+				newCache[ newCount++ ] = vertex;
+			}
+			for( uint32 i = 0; i < cacheCount; i++ ) {
+				uint32 vertex = cache[i];
+				if( vertex != corners[0] && vertex != corners[1] && vertex != corners[2] ) {
+					newCache[ newCount++ ] = vertex;
+				}
+			}
+			for( uint32 i = 0; i < newCount; i++ ) {
+				uint32 vertex = newCache[i];
+				cachePositions[ vertex ] = i < VERTEX_CACHE_SIZE ? (int32)i : -1;
+				vertexScores[ vertex ] = ScoreVertex( cachePositions[ vertex ], liveTriangles[ vertex ] );
+			}
+			cacheCount = newCount < VERTEX_CACHE_SIZE ? newCount : VERTEX_CACHE_SIZE;
+			memcpy( cache, newCache, sizeof( uint32 ) * cacheCount );
+
+			bestTriangle = noTriangle;
+			bestScore = -1.0f;
+			for( uint32 i = 0; i < newCount; i++ ) {
+				uint32 vertex = newCache[i];
+				const uint32* vertexTriangles = &adjacency[ adjacencyOffsets[ vertex ] ];
+				for( uint32 j = 0; j < liveTriangles[ vertex ]; j++ ) {
+					uint32 triangle = vertexTriangles[j];
+					const uint32* triangleCorners = &indices[ triangle * 3 ];
+					float score = vertexScores[ triangleCorners[0] ] + vertexScores[ triangleCorners[1] ] + vertexScores[ triangleCorners[2] ];
+					if( score > bestScore ) {
+						bestScore = score;
+						bestTriangle = triangle;
+					}
+				}
+			}
+		}
+	}
+	memcpy( indices, optimized, sizeof( uint32 ) * indexCount );
+
+	cleanup:
+	FreeAssetMemory( adjacencyOffsets );
+	FreeAssetMemory( liveTriangles );
+	FreeAssetMemory( adjacency );
+	FreeAssetMemory( cachePositions );
+	FreeAssetMemory( vertexScores );
+	FreeAssetMemory( triangleEmitted );
+	FreeAssetMemory( optimized );
+}
@@ -0,0 +1,316 @@
+#ifndef ASSET_LOADING_H
+#define ASSET_LOADING_H
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+/*------------------------------------------------------------------------------------------------------------------
+												Async Asset Loading
+    Workers do the file reads and decoding, anything that touches the GPU is left for the main thread. Load*Async
+    queue a job and hand back a handle, WaitForAssetLoad blocks on one and does its upload, FinishAssetLoads does
+    the uploads for whatever is ready without blocking and can be called once a frame for loads made mid game.
+    Only call these from the thread that owns the GL context. Whatever a job writes into has to stay put until
+    the job is finished, and a mesh job owns its allocater until then
+-------------------------------------------------------------------------------------------------------------------*/
+
+#ifndef ASSET_LOAD_WORKERS
+	//Loads mostly wait on the disk or a single decoder, past a few threads they only queue behind each other
+	#define ASSET_LOAD_WORKERS 4
+#endif
+#define MAX_ASSET_LOADS 256
+#define ASSET_LOAD_MAX_PATH 256
+
+enum AssetLoadType : uint32 {
+	ASSET_LOAD_TEXTURE,
+	ASSET_LOAD_SOUND,
+	ASSET_LOAD_SHADER,
+	ASSET_LOAD_MESH
+};
+
+enum AssetLoadState : uint32 {
+	ASSET_LOAD_FREE,
+	ASSET_LOAD_QUEUED,
+	//Worker side is done, waiting on the main thread for the upload
+	ASSET_LOAD_DECODED,
+	ASSET_LOAD_FINISHED
+};
+
+///Fine to hold on to forever, once the slot is reused by a newer load the old handle just reads as finished
+struct AssetLoadHandle {
+	uint32 slot;
+	uint32 sequence;
+};
+
+struct AssetLoadJob {
+	AssetLoadType type;
+	std::atomic<uint32> state;
+	uint32 sequence;
+	bool succeeded;
+	char paths[ 2 ][ ASSET_LOAD_MAX_PATH ];
+	//Only the fields for the job's type are set
+	TextureData* texture;
+	TextureBindingID* textureBinding;
+	LoadedSound* sound;
+	ShaderProgram* shader;
+	char* shaderSources[ 2 ];
+	MeshGeometryData* mesh;
+	SlabSubsection_Stack* meshAllocater;
+	Armature* armature;
+	MeshGPUBinding* meshBinding;
+	VertexBufferLayout meshLayout;
+};
+
+static struct {
+	uint32 workerCount;
+	//Heap allocated and never freed, the detached workers are still waiting on these during static destruction
+	std::mutex* lock;
+	std::condition_variable* wakeCondition;
+	std::condition_variable* doneCondition;
+	//Slots waiting for a worker, a slot is only ever queued once so it can't overflow
+	uint32 queue[ MAX_ASSET_LOADS ];
+	uint32 queueStart;
+	uint32 queueCount;
+	uint32 nextSequence;
+	AssetLoadJob jobs[ MAX_ASSET_LOADS ];
+} assetLoader;
+
+static void DecodeAssetLoadJob( AssetLoadJob* job ) {
+	switch( job->type ) {
+		case ASSET_LOAD_TEXTURE:
+			LoadTextureDataFromDisk( job->paths[ 0 ], job->texture );
+			job->succeeded = job->texture->data != NULL;
+			break;
+		case ASSET_LOAD_SOUND:
+			*job->sound = LoadWaveFile( job->paths[ 0 ] );
+			job->succeeded = job->sound->sampleCount > 0;
+			break;
+		case ASSET_LOAD_SHADER:
+			job->shaderSources[ 0 ] = ReadShaderSrcFileFromDisk( job->paths[ 0 ] );
+			job->shaderSources[ 1 ] = ReadShaderSrcFileFromDisk( job->paths[ 1 ] );
+			job->succeeded = job->shaderSources[ 0 ] != NULL && job->shaderSources[ 1 ] != NULL;
+			break;
+		case ASSET_LOAD_MESH:
+			LoadMeshData( job->paths[ 0 ], job->meshAllocater, job->mesh, job->armature );
+			job->succeeded = job->mesh->dataCount > 0;
+			break;
+	}
+}
+
+///Main thread half of a job, anything that needs the GL context
+static void FinishAssetLoadJob( AssetLoadJob* job ) {
+	switch( job->type ) {
+		case ASSET_LOAD_TEXTURE:
+			if( job->succeeded && job->textureBinding != NULL ) {
+				CreateTextureBinding( job->texture, job->textureBinding );
+			}
+			break;
+		case ASSET_LOAD_SOUND:
+			break;
+		case ASSET_LOAD_SHADER:
+			if( job->succeeded ) {
+				CreateShaderProgramFromSource( job->paths[ 0 ], job->shaderSources[ 0 ], job->paths[ 1 ], job->shaderSources[ 1 ], job->shader );
+			} else {
+				printf( "Could not read shader sources: %s, %s\n", job->paths[ 0 ], job->paths[ 1 ] );
+			}
+			FreeAssetMemory( job->shaderSources[ 0 ] );
+			FreeAssetMemory( job->shaderSources[ 1 ] );
+			break;
+		case ASSET_LOAD_MESH:
+			if( job->succeeded && job->meshBinding != NULL ) {
+				CreateRenderBinding( job->mesh, job->meshBinding, job->meshLayout );
+			}
+			break;
+	}
+	job->state.store( ASSET_LOAD_FINISHED, std::memory_order_relaxed );
+}
+
+static void AssetLoadWorkerLoop() {
+	for(;;) {
+		uint32 slot;
+		{
+			std::unique_lock<std::mutex> guard( *assetLoader.lock );
+			assetLoader.wakeCondition->wait( guard, []{ return assetLoader.queueCount > 0; } );
+			slot = assetLoader.queue[ assetLoader.queueStart ];
+			assetLoader.queueStart = ( assetLoader.queueStart + 1 ) % MAX_ASSET_LOADS;
+			assetLoader.queueCount--;
+		}
+
+		AssetLoadJob* job = &assetLoader.jobs[ slot ];
+		DecodeAssetLoadJob( job );
+
+		{
+			//Under the lock so a waiter can't check the state and then miss the notify
+			std::lock_guard<std::mutex> guard( *assetLoader.lock );
+			job->state.store( ASSET_LOAD_DECODED, std::memory_order_release );
+		}
+		assetLoader.doneCondition->notify_all();
+	}
+}
+
+///Called once by the platform layer before GameInit. Without it, or on a single core, loads run inline as they're made
+void StartAssetLoadWorkers( uint32 maxWorkers = ASSET_LOAD_WORKERS ) {
+	uint32 hardwareThreads = std::thread::hardware_concurrency();
+	assetLoader.workerCount = ( hardwareThreads > 1 ) ? hardwareThreads - 1 : 0;
+	if( assetLoader.workerCount > maxWorkers ) {
+		assetLoader.workerCount = maxWorkers;
+	}
+	assetLoader.lock = new std::mutex();
+	assetLoader.wakeCondition = new std::condition_variable();
+	assetLoader.doneCondition = new std::condition_variable();
+	for( uint32 workerIndex = 0; workerIndex < assetLoader.workerCount; ++workerIndex ) {
+		std::thread( AssetLoadWorkerLoop ).detach();
+	}
+	printf( "Asset loader using %u worker threads\n", assetLoader.workerCount );
+}
+
+///Does the upload for every load the workers are done with, returns how many that was
+uint32 FinishAssetLoads() {
+	uint32 finishedCount = 0;
+	for( uint32 slot = 0; slot < MAX_ASSET_LOADS; ++slot ) {
+		AssetLoadJob* job = &assetLoader.jobs[ slot ];
+		if( job->state.load( std::memory_order_acquire ) == ASSET_LOAD_DECODED ) {
+			FinishAssetLoadJob( job );
+			finishedCount++;
+		}
+	}
+	return finishedCount;
+}
+
+static bool AnyAssetLoadDecoded() {
+	for( uint32 slot = 0; slot < MAX_ASSET_LOADS; ++slot ) {
+		if( assetLoader.jobs[ slot ].state.load( std::memory_order_acquire ) == ASSET_LOAD_DECODED ) return true;
+	}
+	return false;
+}
+
+///Claims the slot that has gone longest without use, if every slot is busy it finishes loads until one frees up
+static AssetLoadJob* BeginAssetLoad( AssetLoadType type, const char* firstPath, const char* secondPath = "" ) {
+	assert( strlen( firstPath ) < ASSET_LOAD_MAX_PATH && strlen( secondPath ) < ASSET_LOAD_MAX_PATH );
+	for(;;) {
+		for( uint32 probe = 0; probe < MAX_ASSET_LOADS; ++probe ) {
+			uint32 slot = ( assetLoader.nextSequence + probe ) % MAX_ASSET_LOADS;
+			AssetLoadJob* job = &assetLoader.jobs[ slot ];
+			uint32 state = job->state.load( std::memory_order_acquire );
+			if( state != ASSET_LOAD_FREE && state != ASSET_LOAD_FINISHED ) continue;
+
+			//Sequence 0 is never handed out, so a zeroed handle never matches a live load
+			job->sequence = ++assetLoader.nextSequence;
+			job->type = type;
+			job->succeeded = false;
+			snprintf( job->paths[ 0 ], ASSET_LOAD_MAX_PATH, "%s", firstPath );
+			snprintf( job->paths[ 1 ], ASSET_LOAD_MAX_PATH, "%s", secondPath );
+			job->state.store( ASSET_LOAD_QUEUED, std::memory_order_relaxed );
+			return job;
+		}
+
+		if( FinishAssetLoads() == 0 ) {
+			std::unique_lock<std::mutex> guard( *assetLoader.lock );
+			assetLoader.doneCondition->wait( guard, []{ return AnyAssetLoadDecoded(); } );
+		}
+	}
+}
+
+static AssetLoadHandle SubmitAssetLoad( AssetLoadJob* job ) {
+	uint32 slot = (uint32)( job - assetLoader.jobs );
+	AssetLoadHandle handle = { slot, job->sequence };
+	if( assetLoader.workerCount == 0 ) {
+		DecodeAssetLoadJob( job );
+		job->state.store( ASSET_LOAD_DECODED, std::memory_order_release );
+		return handle;
+	}
+
+	{
+		std::lock_guard<std::mutex> guard( *assetLoader.lock );
+		assetLoader.queue[ ( assetLoader.queueStart + assetLoader.queueCount ) % MAX_ASSET_LOADS ] = slot;
+		assetLoader.queueCount++;
+	}
+	assetLoader.wakeCondition->notify_one();
+	return handle;
+}
+
+///binding can be NULL to only decode, storage->data comes from stbi either way
+AssetLoadHandle LoadTextureAsync( const char* fileName, TextureData* storage, TextureBindingID* binding = NULL ) {
+	AssetLoadJob* job = BeginAssetLoad( ASSET_LOAD_TEXTURE, fileName );
+	job->texture = storage;
+	job->textureBinding = binding;
+	return SubmitAssetLoad( job );
+}
+
+AssetLoadHandle LoadSoundAsync( const char* fileName, LoadedSound* storage ) {
+	AssetLoadJob* job = BeginAssetLoad( ASSET_LOAD_SOUND, fileName );
+	job->sound = storage;
+	return SubmitAssetLoad( job );
+}
+
+///Sources are read on a worker, compiling and linking waits for the main thread
+AssetLoadHandle LoadShaderProgramAsync( const char* vertProgramFilePath, const char* fragProgramFilePath, ShaderProgram* program ) {
+	AssetLoadJob* job = BeginAssetLoad( ASSET_LOAD_SHADER, vertProgramFilePath, fragProgramFilePath );
+	job->shader = program;
+	job->shaderSources[ 0 ] = NULL;
+	job->shaderSources[ 1 ] = NULL;
+	return SubmitAssetLoad( job );
+}
+
+///Nothing else may alloc from allocater until the load is finished. binding can be NULL to skip the GPU upload
+AssetLoadHandle LoadMeshAsync( const char* fileName, SlabSubsection_Stack* allocater, MeshGeometryData* storage, Armature* armature = NULL,
+	MeshGPUBinding* binding = NULL, VertexBufferLayout layout = VERTEX_BUFFERS_SEPARATE ) {
+	AssetLoadJob* job = BeginAssetLoad( ASSET_LOAD_MESH, fileName );
+	memset( storage, 0, sizeof( MeshGeometryData ) );
+	job->mesh = storage;
+	job->meshAllocater = allocater;
+	job->armature = armature;
+	job->meshBinding = binding;
+	job->meshLayout = layout;
+	return SubmitAssetLoad( job );
+}
+
+static AssetLoadJob* GetAssetLoadJob( AssetLoadHandle handle ) {
+	assert( handle.slot < MAX_ASSET_LOADS );
+	AssetLoadJob* job = &assetLoader.jobs[ handle.slot ];
+	if( job->sequence != handle.sequence || job->state.load( std::memory_order_acquire ) == ASSET_LOAD_FREE ) {
+		return NULL;
+	}
+	return job;
+}
+
+///Never blocks, does the upload if the decode just finished
+bool IsAssetLoadDone( AssetLoadHandle handle ) {
+	AssetLoadJob* job = GetAssetLoadJob( handle );
+	if( job == NULL ) return true;
+	uint32 state = job->state.load( std::memory_order_acquire );
+	if( state == ASSET_LOAD_DECODED ) {
+		FinishAssetLoadJob( job );
+		return true;
+	}
+	return state == ASSET_LOAD_FINISHED;
+}
+
+///Blocks until the load is decoded and uploaded. False if it failed, a handle whose slot was since reused reads as true
+bool WaitForAssetLoad( AssetLoadHandle handle ) {
+	AssetLoadJob* job = GetAssetLoadJob( handle );
+	if( job == NULL ) return true;
+	if( job->state.load( std::memory_order_acquire ) == ASSET_LOAD_QUEUED ) {
+		std::unique_lock<std::mutex> guard( *assetLoader.lock );
+		assetLoader.doneCondition->wait( guard, [job]{ return job->state.load( std::memory_order_acquire ) != ASSET_LOAD_QUEUED; } );
+	}
+	if( job->state.load( std::memory_order_acquire ) == ASSET_LOAD_DECODED ) {
+		FinishAssetLoadJob( job );
+	}
+	return job->succeeded;
+}
+
+///Waits on everything still in flight, false if any of those failed
+bool WaitForAllAssetLoads() {
+	bool allSucceeded = true;
+	for( uint32 slot = 0; slot < MAX_ASSET_LOADS; ++slot ) {
+		AssetLoadJob* job = &assetLoader.jobs[ slot ];
+		uint32 state = job->state.load( std::memory_order_acquire );
+		if( state == ASSET_LOAD_FREE || state == ASSET_LOAD_FINISHED ) continue;
+		AssetLoadHandle handle = { slot, job->sequence };
+		if( !WaitForAssetLoad( handle ) ) allSucceeded = false;
+	}
+	return allSucceeded;
+}
+
+#endif
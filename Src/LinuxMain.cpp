@@ -0,0 +1,505 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <functional>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include "App.h"
+
+//Decoded images and stb's own scratch come out of the asset heap
+#define STBI_MALLOC( size ) AllocAssetMemory( size )
+#define STBI_REALLOC( ptr, newSize ) ReallocAssetMemory( ptr, newSize )
+#define STBI_FREE( ptr ) FreeAssetMemory( ptr )
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ONLY_PNG
+#include "stb/stb_image.h"
+
+#include "../App.cpp"
+
+/*----------------------------------------------------------------------------------------
+    Headless Linux entry point. No window and no audio device, the software rasterizer
+    draws into memory and input comes from an optional script file:
+
+        tetra [--frames N] [--input script.txt] [--screenshot out.ppm] [--screenshot-frame N] [--realtime] [--fps N] [--sim-hz N]
+        tetra --cook-mesh file.dae [--cook-mesh another.dae ...]
+
+    Script lines are "<frame> <event> <args>", applied at the start of that frame:
+        10 key w down / 40 key w up
+        10 mouse 0.25 -0.5               (normalized window coordinates)
+        10 button 0 down
+        10 stick 0 0.5 -1.0
+        10 trigger 1 0.75
+        300 quit
+-----------------------------------------------------------------------------------------*/
+
+#ifndef SOFTWARE_RENDERER_IMPLEMENTATION
+	#error "The Linux platform layer is headless only, build with SOFTWARE_RENDERER_IMPLEMENTATION"
+#endif
+
+enum InputScriptEventType {
+	SCRIPT_KEY, SCRIPT_MOUSE, SCRIPT_BUTTON, SCRIPT_STICK, SCRIPT_TRIGGER, SCRIPT_QUIT
+};
+
+struct InputScriptEvent {
+	uint32 frame;
+	InputScriptEventType type;
+	uint8 index;
+	bool down;
+	float x, y;
+};
+
+static struct {
+	bool running;
+	//Simulated time advances a fixed 1/targetFrameHZ per frame unless realtime is set, which also paces the loop
+	bool realtime;
+	uint32 frameIndex;
+	//0 runs until the script quits
+	uint32 frameLimit;
+	const char* screenshotPath;
+	uint32 screenshotFrame;
+
+	uint32 targetFrameHZ;
+	uint32 simulationHZ;
+	FrameArena frameArena;
+	SlabHeap assetHeap;
+
+	bool keysDown[ 256 ];
+	float mouseX, mouseY;
+	//Same layout as the Win32 side so the getters read the same
+	struct {
+		float leftStick_x, leftStick_y;
+		float rightStick_x, rightStick_y;
+		float leftTrigger, rightTrigger;
+		bool buttons[8];
+	} controllerState;
+
+	InputScriptEvent* scriptEvents;
+	uint32 scriptEventCount;
+	uint32 nextScriptEvent;
+} appInfo;
+
+static uint8 NormalizeKey( uint8 keyChar ) {
+	if( keyChar >= 'a' && keyChar <= 'z' ) {
+		keyChar -= ( 'a' - 'A' );
+	}
+	return keyChar;
+}
+
+///Events have to be in frame order, anything malformed is skipped with a warning
+static void LoadInputScript( const char* fileName ) {
+	int64 bytesRead = 0;
+	char* fileData = (char*)ReadWholeFile( fileName, &bytesRead );
+	if( fileData == NULL ) return;
+	//Copied so the last line can be terminated even without a trailing newline
+	char* text = (char*)AllocAssetMemory( bytesRead + 1 );
+	memcpy( text, fileData, bytesRead );
+	text[ bytesRead ] = 0;
+	FreeAssetMemory( fileData );
+
+	uint32 lineCount = 1;
+	for( int64 i = 0; i < bytesRead; ++i ) {
+		if( text[i] == '\n' ) lineCount++;
+	}
+	appInfo.scriptEvents = (InputScriptEvent*)AllocAssetMemory( sizeof( InputScriptEvent ) * lineCount );
+	appInfo.scriptEventCount = 0;
+
+	char* line = text;
+	char* textEnd = text + bytesRead;
+	uint32 lineNumber = 0;
+	while( line < textEnd ) {
+		char* lineEnd = line;
+		while( lineEnd < textEnd && *lineEnd != '\n' ) lineEnd++;
+		*lineEnd = 0;
+		lineNumber++;
+
+		InputScriptEvent event = { };
+		char eventName[16] = { };
+		char keyOrState[16] = { };
+		char state[16] = { };
+		uint32 index = 0;
+		int fieldCount = sscanf( line, "%u %15s", &event.frame, eventName );
+		bool valid = fieldCount == 2;
+		if( valid && strcmp( eventName, "key" ) == 0 ) {
+			event.type = SCRIPT_KEY;
+			valid = sscanf( line, "%*u %*s %15s %15s", keyOrState, state ) == 2;
+			event.index = NormalizeKey( (uint8)keyOrState[0] );
+			event.down = strcmp( state, "down" ) == 0;
+		} else if( valid && strcmp( eventName, "mouse" ) == 0 ) {
+			event.type = SCRIPT_MOUSE;
+			valid = sscanf( line, "%*u %*s %f %f", &event.x, &event.y ) == 2;
+		} else if( valid && strcmp( eventName, "button" ) == 0 ) {
+			event.type = SCRIPT_BUTTON;
+			valid = sscanf( line, "%*u %*s %u %15s", &index, state ) == 2 && index < 8;
+			event.index = (uint8)index;
+			event.down = strcmp( state, "down" ) == 0;
+		} else if( valid && strcmp( eventName, "stick" ) == 0 ) {
+			event.type = SCRIPT_STICK;
+			valid = sscanf( line, "%*u %*s %u %f %f", &index, &event.x, &event.y ) == 3 && index < 2;
+			event.index = (uint8)index;
+		} else if( valid && strcmp( eventName, "trigger" ) == 0 ) {
+			event.type = SCRIPT_TRIGGER;
+			valid = sscanf( line, "%*u %*s %u %f", &index, &event.x ) == 2 && index < 2;
+			event.index = (uint8)index;
+		} else if( valid && strcmp( eventName, "quit" ) == 0 ) {
+			event.type = SCRIPT_QUIT;
+		} else if( fieldCount > 0 ) {
+			valid = false;
+		} else {
+			//Blank line
+			line = lineEnd + 1;
+			continue;
+		}
+
+		if( valid ) {
+			appInfo.scriptEvents[ appInfo.scriptEventCount++ ] = event;
+		} else {
+			printf( "%s(%u): couldn't read input event, skipping it\n", fileName, lineNumber );
+		}
+		line = lineEnd + 1;
+	}
+
+	FreeAssetMemory( text );
+	printf( "Loaded %u scripted input events from %s\n", appInfo.scriptEventCount, fileName );
+}
+
+static void ApplyScriptedInput( uint32 frameIndex ) {
+	while( appInfo.nextScriptEvent < appInfo.scriptEventCount ) {
+		InputScriptEvent* event = &appInfo.scriptEvents[ appInfo.nextScriptEvent ];
+		if( event->frame > frameIndex ) break;
+		appInfo.nextScriptEvent++;
+
+		switch( event->type ) {
+			case SCRIPT_KEY: {
+				appInfo.keysDown[ event->index ] = event->down;
+			}break;
+			case SCRIPT_MOUSE: {
+				appInfo.mouseX = event->x;
+				appInfo.mouseY = event->y;
+			}break;
+			case SCRIPT_BUTTON: {
+				appInfo.controllerState.buttons[ event->index ] = event->down;
+			}break;
+			case SCRIPT_STICK: {
+				if( event->index == 0 ) {
+					appInfo.controllerState.leftStick_x = event->x;
+					appInfo.controllerState.leftStick_y = event->y;
+				} else {
+					appInfo.controllerState.rightStick_x = event->x;
+					appInfo.controllerState.rightStick_y = event->y;
+				}
+			}break;
+			case SCRIPT_TRIGGER: {
+				if( event->index == 0 ) {
+					appInfo.controllerState.leftTrigger = event->x;
+				} else {
+					appInfo.controllerState.rightTrigger = event->x;
+				}
+			}break;
+			case SCRIPT_QUIT: {
+				appInfo.running = false;
+			}break;
+		}
+	}
+}
+
+//LoaderChecks.cpp, included at the bottom with the rest of the loaders
+static uint32 RunLoaderChecks( MemorySlab* slab );
+
+int main( int argc, char** argv ) {
+	appInfo.running = true;
+	appInfo.realtime = false;
+	appInfo.targetFrameHZ = 60;
+	appInfo.simulationHZ = SIMULATION_HZ;
+	const char* inputScriptPath = NULL;
+	const char* cookMeshPaths[ 64 ];
+	uint32 cookMeshCount = 0;
+	bool checkLoaders = false;
+
+	for( int argIndex = 1; argIndex < argc; ++argIndex ) {
+		const char* arg = argv[ argIndex ];
+		bool hasValue = argIndex + 1 < argc;
+		if( strcmp( arg, "--frames" ) == 0 && hasValue ) {
+			appInfo.frameLimit = (uint32)atoi( argv[ ++argIndex ] );
+		} else if( strcmp( arg, "--input" ) == 0 && hasValue ) {
+			inputScriptPath = argv[ ++argIndex ];
+		} else if( strcmp( arg, "--screenshot" ) == 0 && hasValue ) {
+			appInfo.screenshotPath = argv[ ++argIndex ];
+		} else if( strcmp( arg, "--screenshot-frame" ) == 0 && hasValue ) {
+			appInfo.screenshotFrame = (uint32)atoi( argv[ ++argIndex ] );
+		} else if( strcmp( arg, "--realtime" ) == 0 ) {
+			appInfo.realtime = true;
+		} else if( strcmp( arg, "--fps" ) == 0 && hasValue && atoi( argv[ argIndex + 1 ] ) > 0 ) {
+			appInfo.targetFrameHZ = (uint32)atoi( argv[ ++argIndex ] );
+		} else if( strcmp( arg, "--cook-mesh" ) == 0 && hasValue && cookMeshCount < 64 ) {
+			cookMeshPaths[ cookMeshCount++ ] = argv[ ++argIndex ];
+		} else if( strcmp( arg, "--check-loaders" ) == 0 ) {
+			checkLoaders = true;
+		} else if( strcmp( arg, "--sim-hz" ) == 0 && hasValue && atoi( argv[ argIndex + 1 ] ) > 0 ) {
+			appInfo.simulationHZ = (uint32)atoi( argv[ ++argIndex ] );
+		} else {
+			printf( "Usage: %s [--frames N] [--input script.txt] [--screenshot out.ppm] [--screenshot-frame N] [--realtime] [--fps N] [--sim-hz N]\n", argv[0] );
+			printf( "       %s --cook-mesh file.dae [--cook-mesh another.dae ...]\n", argv[0] );
+			printf( "       %s --check-loaders\n", argv[0] );
+			return 1;
+		}
+	}
+	//Default to the last frame when a frame count is given, the first one otherwise
+	if( appInfo.screenshotPath != NULL && appInfo.screenshotFrame == 0 && appInfo.frameLimit > 0 ) {
+		appInfo.screenshotFrame = appInfo.frameLimit - 1;
+	}
+	printf( "Program Started, running headless\n" );
+
+	//Only address space up front, pages get committed as subsections are carved
+	MemorySlab gameSlab = ReserveMemorySlab( MEGABYTES( RESERVED_SPACE ), SLAB_PAGES_TRANSPARENT_HUGE );
+	assert( gameSlab.slabStart != NULL );
+	appInfo.frameArena = CreateFrameArena( &gameSlab, FRAME_ARENA_SIZE );
+	appInfo.assetHeap = CreateSlabHeap( &gameSlab, ASSET_HEAP_SIZE );
+
+	//Cooking is its own run, write each mesh's binary cache and leave
+	if( cookMeshCount > 0 ) {
+		SlabSubsection_Stack cookStorage = CarveNewSubsection( &gameSlab, MEGABYTES( 256 ), "Mesh Cooking" );
+		uint32 cookFailures = 0;
+		for( uint32 cookIndex = 0; cookIndex < cookMeshCount; ++cookIndex ) {
+			ClearSubStack( &cookStorage );
+			if( CookMeshCache( cookMeshPaths[ cookIndex ], &cookStorage ) ) {
+				printf( "Cooked %s\n", cookMeshPaths[ cookIndex ] );
+			} else {
+				cookFailures++;
+			}
+		}
+		return cookFailures > 0 ? 1 : 0;
+	}
+	if( checkLoaders ) {
+		return RunLoaderChecks( &gameSlab ) > 0 ? 1 : 0;
+	}
+
+	StartAssetLoadWorkers();
+
+	SlabSubsection_Stack systemsMemory = CarveNewSubsection( &gameSlab, KILOBYTES( 12 ), "Systems" );
+	SlabSubsection_Stack gameMemoryStack = CarveNewSubsection( &gameSlab, sizeof( GameMemory ) * 2, "Game Memory" );
+	void* gMemPtr = AllocOnSubStack_Aligned( &gameMemoryStack, sizeof( GameMemory ), alignof( GameMemory ) );
+
+	SoundSystemStorage* soundSystemStorage = LinuxInitSound( 60, &systemsMemory );
+	RendererStorage* renderSystemStorage = InitRenderer( SCREEN_WIDTH, SCREEN_HEIGHT, &systemsMemory );
+
+	if( inputScriptPath != NULL ) {
+		LoadInputScript( inputScriptPath );
+	}
+
+	GameInit( &gameSlab, gMemPtr, renderSystemStorage, &appInfo.frameArena );
+	PrintMemoryReport();
+
+	FixedStepClock simClock = CreateFixedStepClock( appInfo.simulationHZ );
+	FramePacer framePacer = CreateFramePacer( appInfo.targetFrameHZ );
+	int64 framePeriod = 1000000000LL / appInfo.targetFrameHZ;
+	int64 totalComputeTime = 0;
+	int64 lastTime = GetMonotonicNanoseconds();
+	do {
+		int64 startTime = GetMonotonicNanoseconds();
+		ResetFrameArena( &appInfo.frameArena );
+		ApplyScriptedInput( appInfo.frameIndex );
+
+		AdvanceFixedStepClock( &simClock, appInfo.realtime ? startTime - lastTime : framePeriod );
+		lastTime = startTime;
+
+		if( appInfo.running ) {
+			while( appInfo.running && TakeFixedStep( &simClock ) ) {
+				appInfo.running = Update( gMemPtr, GetFixedStepMilliseconds( &simClock ), &soundSystemStorage->activeSounds );
+			}
+			Render( gMemPtr, renderSystemStorage, GetInterpolationAlpha( &simClock ) );
+			PushAudioToSoundCard( soundSystemStorage );
+
+			if( appInfo.screenshotPath != NULL && appInfo.frameIndex == appInfo.screenshotFrame ) {
+				if( WriteSoftwareFramebufferToFile( appInfo.screenshotPath ) ) {
+					printf( "Wrote frame %u to %s\n", appInfo.frameIndex, appInfo.screenshotPath );
+				}
+			}
+			ClearCurrentFramebuffer();
+		}
+
+		appInfo.frameIndex++;
+		if( appInfo.frameLimit > 0 && appInfo.frameIndex >= appInfo.frameLimit ) {
+			appInfo.running = false;
+		}
+
+		totalComputeTime += GetMonotonicNanoseconds() - startTime;
+		if( appInfo.realtime ) {
+			WaitForNextFrame( &framePacer );
+		}
+	} while( appInfo.running );
+
+	if( appInfo.frameIndex > 0 ) {
+		printf( "Ran %u frames and %llu %uHz steps, average compute %.3f ms\n", appInfo.frameIndex,
+			(unsigned long long)simClock.totalSteps, appInfo.simulationHZ, (double)totalComputeTime / (double)appInfo.frameIndex / 1000000.0 );
+	}
+	if( appInfo.realtime ) {
+		PrintFramePacerStats( &framePacer );
+	}
+	DestroyFramePacer( &framePacer );
+	return 0;
+}
+
+/*----------------------------------------------------------------------------------------
+                         App.h function prototype implementations
+-----------------------------------------------------------------------------------------*/
+
+void GetMousePosition( float* x, float* y ) {
+	*x = appInfo.mouseX;
+	*y = appInfo.mouseY;
+}
+
+bool IsKeyDown( uint8 keyChar ) {
+	return appInfo.keysDown[ NormalizeKey( keyChar ) ];
+}
+
+bool IsControllerButtonDown( uint8 buttonIndex ) {
+	if( buttonIndex >= 8 ) return false;
+	return appInfo.controllerState.buttons[ buttonIndex ];
+}
+
+void GetControllerStickState( uint8 stickIndex, float* x, float* y ) {
+	if( stickIndex == 0 ) {
+		*x = appInfo.controllerState.leftStick_x;
+		*y = appInfo.controllerState.leftStick_y;
+	} else if( stickIndex == 1 ) {
+		*x = appInfo.controllerState.rightStick_x;
+		*y = appInfo.controllerState.rightStick_y;
+	}
+}
+
+float GetTriggerState( uint8 triggerIndex ) {
+	if( triggerIndex == 0 ) {
+		return appInfo.controllerState.leftTrigger;
+	} else if( triggerIndex == 1 ) {
+		return appInfo.controllerState.rightTrigger;
+	}
+
+	return 0.0f;
+}
+
+///Missing or empty files print a message and return NULL with bytesRead set to 0, headless runs shouldn't die on absent assets
+void* ReadWholeFile( const char* filename, int64* bytesRead ) {
+	*bytesRead = 0;
+	int fileHandle = open( filename, O_RDONLY );
+	if( fileHandle < 0 ) {
+		printf( "Could not open file %s\n", filename );
+		return NULL;
+	}
+
+	struct stat fileInfo;
+	if( fstat( fileHandle, &fileInfo ) != 0 || fileInfo.st_size == 0 ) {
+		printf( "Could not read the size of %s, or it is empty\n", filename );
+		close( fileHandle );
+		return NULL;
+	}
+	assert( fileInfo.st_size <= 0xFFFFFFFF );
+
+	uint8* data = (uint8*)AllocAssetMemory( fileInfo.st_size );
+	assert( data != NULL );
+
+	int64 totalRead = 0;
+	while( totalRead < fileInfo.st_size ) {
+		ssize_t readCount = read( fileHandle, data + totalRead, fileInfo.st_size - totalRead );
+		if( readCount < 0 && errno == EINTR ) continue;
+		if( readCount <= 0 ) break;
+		totalRead += readCount;
+	}
+	close( fileHandle );
+
+	if( totalRead != fileInfo.st_size ) {
+		printf( "Only read %lld of %lld bytes from %s\n", (long long)totalRead, (long long)fileInfo.st_size, filename );
+		FreeAssetMemory( data );
+		return NULL;
+	}
+
+	*bytesRead = totalRead;
+	return data;
+}
+
+void* MapWholeFile( const char* filename, int64* bytesMapped ) {
+	*bytesMapped = 0;
+	int fileHandle = open( filename, O_RDONLY );
+	if( fileHandle < 0 ) {
+		return NULL;
+	}
+	struct stat fileInfo;
+	if( fstat( fileHandle, &fileInfo ) != 0 || fileInfo.st_size == 0 ) {
+		close( fileHandle );
+		return NULL;
+	}
+	//Writable private pages so the data can be patched in place without touching the file
+	void* data = mmap( NULL, fileInfo.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileHandle, 0 );
+	close( fileHandle );
+	if( data == MAP_FAILED ) {
+		printf( "Could not map %s\n", filename );
+		return NULL;
+	}
+	*bytesMapped = fileInfo.st_size;
+	return data;
+}
+
+void UnmapWholeFile( void* data, int64 bytesMapped ) {
+	munmap( data, bytesMapped );
+}
+
+bool WriteWholeFile( const char* filename, const void* data, int64 bytes ) {
+	char tempName[ 512 ];
+	if( snprintf( tempName, sizeof( tempName ), "%s.tmp", filename ) >= (int)sizeof( tempName ) ) {
+		printf( "Path too long to write: %s\n", filename );
+		return false;
+	}
+	int fileHandle = open( tempName, O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+	if( fileHandle < 0 ) {
+		printf( "Could not create file %s\n", tempName );
+		return false;
+	}
+	int64 totalWritten = 0;
+	while( totalWritten < bytes ) {
+		ssize_t writeCount = write( fileHandle, (const uint8*)data + totalWritten, bytes - totalWritten );
+		if( writeCount < 0 && errno == EINTR ) continue;
+		if( writeCount <= 0 ) break;
+		totalWritten += writeCount;
+	}
+	close( fileHandle );
+
+	if( totalWritten != bytes || rename( tempName, filename ) != 0 ) {
+		printf( "Could not write %s\n", filename );
+		unlink( tempName );
+		return false;
+	}
+	return true;
+}
+
+int64 GetFileModifiedTime( const char* filename ) {
+	struct stat fileInfo;
+	if( stat( filename, &fileInfo ) != 0 ) {
+		return 0;
+	}
+	return (int64)fileInfo.st_mtim.tv_sec * 1000000000LL + fileInfo.st_mtim.tv_nsec;
+}
+
+/*----------------------------------------------------------------------------------------
+                       Renderer.h function prototype implementations
+-----------------------------------------------------------------------------------------*/
+
+char* ReadShaderSrcFileFromDisk( const char* fileName ) {
+	int64 bytesRead = 0;
+	char* fileData = (char*)ReadWholeFile( fileName, &bytesRead );
+	if( fileData == NULL ) {
+		return 0;
+	}
+	char* buffer = (char*)AllocAssetMemory( bytesRead + 1 );
+	memcpy( buffer, fileData, bytesRead );
+	buffer[ bytesRead ] = 0;
+	FreeAssetMemory( fileData );
+	return buffer;
+}
+
+#include "AssetLoaders.cpp"
+#include "LoaderChecks.cpp"
@@ -0,0 +1,323 @@
+/*----------------------------------------------------------------------------------------
+                                 Loader self checks
+    Run with --check-loaders (make check). Everything is generated in place, no fixtures.
+    Included after AssetLoaders.cpp so the file local parsers can be reached directly.
+    Each check prints what it measured and returns how many things were wrong
+-----------------------------------------------------------------------------------------*/
+
+//xorshift64*, only here so the generated inputs are the same on every run and platform
+static uint64 NextCheckRandom( uint64* state ) {
+	*state ^= *state >> 12;
+	*state ^= *state << 25;
+	*state ^= *state >> 27;
+	return *state * 2685821657736338717ULL;
+}
+
+static float CheckRandomFloatBits( uint64* state ) {
+	uint32 bits = (uint32)NextCheckRandom( state );
+	float value;
+	memcpy( &value, &bits, sizeof( float ) );
+	return value;
+}
+
+///ParseFloatToken has to agree with strtof bit for bit, including on what it rejects
+static bool CheckFloatAgainstStrtof( const char* text, uint32* mismatchCount ) {
+	float parsed = 0.0f;
+	bool parsedOk = ParseFloatToken( text, text + strlen( text ), &parsed );
+	char* strtofEnd;
+	float expected = strtof( text, &strtofEnd );
+	bool expectedOk = strtofEnd != text && *strtofEnd == 0;
+	if( parsedOk == expectedOk && ( !parsedOk || memcmp( &parsed, &expected, sizeof( float ) ) == 0 ) ) {
+		return true;
+	}
+	if( (*mismatchCount)++ < 10 ) {
+		printf( "  [%s] parsed %d %.9g, strtof %d %.9g\n", text, parsedOk, parsed, expectedOk, expected );
+	}
+	return false;
+}
+
+static uint32 CheckFloatParsing() {
+	const char* fixedInputs[] = { "0", "-0", "1", "+1.5", ".5", "5.", "1e10", "1E-5", "-1.17549435e-38", "3.4028235e38",
+		"3.5e38", "1e-50", "inf", "-nan", "0x1p3", "1e", "1e+", "-", ".", "abc", "1.2.3", "12a", "16777217", "16777216.5",
+		"0.30000001192092896", "1.00000005960464477539062500001", "1.000000059604644775390625",
+		"123456789012345678901234567890", "0.000000000000000000000000000001", "9007199254740993", "7.038531e-26" };
+	uint32 mismatchCount = 0;
+	uint32 inputCount = 0;
+	for( uint32 fixedIndex = 0; fixedIndex < sizeof( fixedInputs ) / sizeof( fixedInputs[0] ); ++fixedIndex ) {
+		CheckFloatAgainstStrtof( fixedInputs[ fixedIndex ], &mismatchCount );
+		inputCount++;
+	}
+
+	//The shapes exporters write: any float at every precision, fixed point, long doubles, odd exponents
+	uint64 random = 0x9E3779B97F4A7C15ULL;
+	char text[ 64 ];
+	for( uint32 i = 0; i < 3000000; ++i ) {
+		switch( NextCheckRandom( &random ) % 5 ) {
+			case 0: {
+				float value = CheckRandomFloatBits( &random );
+				if( value != value ) continue;
+				snprintf( text, sizeof( text ), "%.*g", (int)( NextCheckRandom( &random ) % 10 ) + 1, value );
+			}break;
+			case 1: {
+				snprintf( text, sizeof( text ), "%.6f", ( (double)( NextCheckRandom( &random ) % 2000000 ) - 1000000.0 ) / 1000.0 );
+			}break;
+			case 2: {
+				double value = (double)NextCheckRandom( &random ) / 1e15;
+				snprintf( text, sizeof( text ), "%.*g", (int)( NextCheckRandom( &random ) % 17 ) + 1, ( NextCheckRandom( &random ) & 1 ) ? value : -value );
+			}break;
+			case 3: {
+				float value = CheckRandomFloatBits( &random );
+				if( value != value ) continue;
+				snprintf( text, sizeof( text ), "%.9g", value );
+			}break;
+			default: {
+				snprintf( text, sizeof( text ), "%llu.%llue%d", (unsigned long long)( NextCheckRandom( &random ) % 100000000 ),
+					(unsigned long long)( NextCheckRandom( &random ) % 1000000 ), (int)( NextCheckRandom( &random ) % 80 ) - 40 );
+			}break;
+		}
+		CheckFloatAgainstStrtof( text, &mismatchCount );
+		inputCount++;
+	}
+
+	//Exactly halfway between neighbouring floats, where a double rounding would show
+	for( uint32 i = 0; i < 200000; ++i ) {
+		uint32 bits = (uint32)NextCheckRandom( &random ) & 0x7F7FFFFF;
+		float low;
+		memcpy( &low, &bits, sizeof( float ) );
+		double halfway = ( (double)low + (double)nextafterf( low, INFINITY ) ) / 2.0;
+		snprintf( text, sizeof( text ), "%.17g", halfway );
+		CheckFloatAgainstStrtof( text, &mismatchCount );
+		snprintf( text, sizeof( text ), "%.9g", halfway );
+		CheckFloatAgainstStrtof( text, &mismatchCount );
+		inputCount += 2;
+	}
+	printf( "Float parsing: %u of %u inputs differ from strtof\n", mismatchCount, inputCount );
+
+	uint32 failures = mismatchCount > 0 ? 1 : 0;
+	const char* indexText = "  1 2\n\t3   4294967295 4294967296 7";
+	uint32 indices[ 8 ];
+	uint32 indexCount = ParseUInt32Array( indexText, indexText + strlen( indexText ), indices, 8 );
+	if( indexCount != 4 || indices[3] != 4294967295u ) {
+		printf( "  uint32 parsing stopped after %u values, should stop at the out of range one after 4\n", indexCount );
+		failures++;
+	}
+	const char* floatText = "1 2 3 4 5";
+	float floats[ 3 ];
+	if( ParseFloatArray( floatText, floatText + strlen( floatText ), floats, 3 ) != 3 ) {
+		printf( "  float parsing wrote past its capacity\n" );
+		failures++;
+	}
+	return failures;
+}
+
+#define CHECK_GRID_FILE "loader_check_grid.dae"
+
+///Writes a flat gridSize x gridSize quad grid as an unskinned COLLADA polylist, two triangles per quad.
+///Position ids run along x then y, (x, y) is id y * ( gridSize + 1 ) + x
+static bool WriteCheckGridCollada( const char* fileName, uint32 gridSize ) {
+	const uint32 rowLength = gridSize + 1;
+	const uint32 positionCount = rowLength * rowLength;
+	const uint32 triangleCount = gridSize * gridSize * 2;
+	uint64 capacity = 4096 + (uint64)positionCount * 3 * 16 + (uint64)triangleCount * 3 * 24;
+	char* text = (char*)AllocAssetMemory( capacity );
+	if( text == NULL ) {
+		printf( "  no room in the asset heap for a %u x %u grid\n", gridSize, gridSize );
+		return false;
+	}
+	uint64 length = 0;
+	length += snprintf( text + length, capacity - length, "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<COLLADA version=\"1.4.1\">\n"
+		"<library_geometries><geometry id=\"Grid-mesh\"><mesh>\n"
+		"<source id=\"Grid-positions\"><float_array id=\"Grid-positions-array\" count=\"%u\">", positionCount * 3 );
+	for( uint32 y = 0; y < rowLength; ++y ) {
+		for( uint32 x = 0; x < rowLength; ++x ) {
+			//A little height so no two rows are exactly alike
+			length += snprintf( text + length, capacity - length, "%g %g %g ", (float)x / gridSize * 2.0f - 1.0f,
+				(float)y / gridSize * 2.0f - 1.0f, ( ( x * 7 + y * 3 ) % 5 ) * 0.01f );
+		}
+	}
+	length += snprintf( text + length, capacity - length, "</float_array></source>\n"
+		"<source id=\"Grid-normals\"><float_array id=\"Grid-normals-array\" count=\"3\">0 0 1</float_array></source>\n"
+		"<source id=\"Grid-map\"><float_array id=\"Grid-map-array\" count=\"8\">0 0 1 0 1 1 0 1</float_array></source>\n"
+		"<vertices id=\"Grid-vertices\"><input semantic=\"POSITION\" source=\"#Grid-positions\"/></vertices>\n"
+		"<polylist count=\"%u\">\n<input semantic=\"VERTEX\" source=\"#Grid-vertices\" offset=\"0\"/>"
+		"<input semantic=\"NORMAL\" source=\"#Grid-normals\" offset=\"1\"/>"
+		"<input semantic=\"TEXCOORD\" source=\"#Grid-map\" offset=\"2\" set=\"0\"/>\n<p>", triangleCount );
+	//The uv only depends on the position, so shared corners weld
+	for( uint32 y = 0; y < gridSize; ++y ) {
+		for( uint32 x = 0; x < gridSize; ++x ) {
+			uint32 a = y * rowLength + x;
+			uint32 quad[6] = { a, a + 1, a + rowLength + 1, a, a + rowLength + 1, a + rowLength };
+			for( uint32 corner = 0; corner < 6; ++corner ) {
+				length += snprintf( text + length, capacity - length, "%u 0 %u ", quad[ corner ], quad[ corner ] % 4 );
+			}
+		}
+	}
+	length += snprintf( text + length, capacity - length, "</p>\n</polylist>\n</mesh></geometry></library_geometries>\n</COLLADA>\n" );
+	assert( length < capacity );
+
+	bool written = WriteWholeFile( fileName, text, (int64)length );
+	FreeAssetMemory( text );
+	if( !written ) {
+		printf( "  could not write %s\n", fileName );
+	}
+	return written;
+}
+
+///A load that fails has to say so and leave the sub stack and storage the way it found them
+static uint32 CheckFailedMeshLoad( const char* fileName, SlabSubsection_Stack* meshStack, const char* situation ) {
+	MeshGeometryData mesh;
+	memset( &mesh, 0xCD, sizeof( MeshGeometryData ) );
+	void* stackBefore = meshStack->current;
+	bool loaded = LoadMeshDataFromDisk( fileName, meshStack, &mesh );
+	if( !loaded && meshStack->current == stackBefore && mesh.dataCount == 0 ) {
+		return 0;
+	}
+	printf( "  %s: loaded %d, %llu bytes left on the sub stack, %u indices\n", situation, loaded,
+		(unsigned long long)( (uint8*)meshStack->current - (uint8*)stackBefore ), mesh.dataCount );
+	return 1;
+}
+
+static uint32 CheckOversizedMeshLoads( MemorySlab* slab ) {
+	uint32 failures = 0;
+	//20 x 20 is 2400 indices, 9600 bytes, and 441 vertices at 32 bytes each
+	if( !WriteCheckGridCollada( CHECK_GRID_FILE, 20 ) ) {
+		return 1;
+	}
+	SlabSubsection_Stack indicesDontFit = CarveNewSubsection( slab, KILOBYTES( 4 ), "Loader Check Small" );
+	failures += CheckFailedMeshLoad( CHECK_GRID_FILE, &indicesDontFit, "indices bigger than the sub stack" );
+	SlabSubsection_Stack verticesDontFit = CarveNewSubsection( slab, KILOBYTES( 16 ), "Loader Check Medium" );
+	failures += CheckFailedMeshLoad( CHECK_GRID_FILE, &verticesDontFit, "vertices bigger than what's left" );
+	failures += CheckFailedMeshLoad( "loader_check_missing.dae", &verticesDontFit, "missing file" );
+	remove( CHECK_GRID_FILE );
+	printf( "Oversized mesh loads: %u of 3 didn't fail cleanly\n", failures );
+	return failures;
+}
+
+///Post transform cache misses per triangle, through the same VERTEX_CACHE_SIZE entry LRU the optimizer models
+static float MeasureLRUCacheACMR( const uint32* indices, uint32 indexCount ) {
+	uint32 cache[ VERTEX_CACHE_SIZE ];
+	uint32 cachedCount = 0;
+	uint32 misses = 0;
+	for( uint32 i = 0; i < indexCount; ++i ) {
+		uint32 position = 0;
+		while( position < cachedCount && cache[ position ] != indices[i] ) position++;
+		if( position == cachedCount ) {
+			misses++;
+			if( cachedCount < VERTEX_CACHE_SIZE ) cachedCount++;
+			position = cachedCount - 1;
+		}
+		memmove( &cache[1], &cache[0], sizeof( uint32 ) * position );
+		cache[0] = indices[i];
+	}
+	return (float)misses / (float)( indexCount / 3 );
+}
+
+///Rotated so the smallest id leads, which keeps the winding, ids fit in 21 bits each
+static uint64 CheckTriangleKey( uint32 a, uint32 b, uint32 c ) {
+	if( b < a && b < c ) {
+		uint32 first = b; b = c; c = a; a = first;
+	} else if( c < a && c < b ) {
+		uint32 first = c; c = b; b = a; a = first;
+	}
+	return ( (uint64)a << 42 ) | ( (uint64)b << 21 ) | (uint64)c;
+}
+
+static int CompareTriangleKeys( const void* left, const void* right ) {
+	uint64 a = *(const uint64*)left;
+	uint64 b = *(const uint64*)right;
+	return a < b ? -1 : ( a > b ? 1 : 0 );
+}
+
+///Shared grid corners have to weld to one vertex each, the triangles have to come out the same ones with the
+///same winding, and the optimized order has to beat the row by row order it was written in
+static uint32 CheckGridWeldAndCacheOrder( MemorySlab* slab ) {
+	const uint32 gridSize = 100;
+	const uint32 rowLength = gridSize + 1;
+	const uint32 triangleCount = gridSize * gridSize * 2;
+	if( !WriteCheckGridCollada( CHECK_GRID_FILE, gridSize ) ) {
+		return 1;
+	}
+	SlabSubsection_Stack meshStack = CarveNewSubsection( slab, MEGABYTES( 2 ), "Loader Check Grid" );
+	MeshGeometryData mesh = { };
+	bool loaded = LoadMeshDataFromDisk( CHECK_GRID_FILE, &meshStack, &mesh );
+	remove( CHECK_GRID_FILE );
+	if( !loaded ) {
+		printf( "  the %u x %u grid didn't load\n", gridSize, gridSize );
+		return 1;
+	}
+
+	uint32 failures = 0;
+	if( mesh.vertexCount != rowLength * rowLength || mesh.dataCount != triangleCount * 3 ) {
+		printf( "  grid welded to %u vertices and %u indices, should be %u and %u\n", mesh.vertexCount, mesh.dataCount,
+			rowLength * rowLength, triangleCount * 3 );
+		failures++;
+	}
+
+	//Positions map back to the grid ids they were written from, the loader turns COLLADA's y into -z.
+	//Input order is rebuilt the same way as the file
+	uint64* loadedKeys = (uint64*)AllocAssetMemory( sizeof( uint64 ) * triangleCount );
+	uint64* writtenKeys = (uint64*)AllocAssetMemory( sizeof( uint64 ) * triangleCount );
+	uint32* writtenIndices = (uint32*)AllocAssetMemory( sizeof( uint32 ) * triangleCount * 3 );
+	if( loadedKeys == NULL || writtenKeys == NULL || writtenIndices == NULL ) {
+		printf( "  no room in the asset heap to compare the grid's triangles\n" );
+		FreeAssetMemory( loadedKeys );
+		FreeAssetMemory( writtenKeys );
+		FreeAssetMemory( writtenIndices );
+		return failures + 1;
+	}
+	uint32 loadedTriangles = mesh.dataCount / 3 < triangleCount ? mesh.dataCount / 3 : triangleCount;
+	for( uint32 triangle = 0; triangle < loadedTriangles; ++triangle ) {
+		uint32 ids[3];
+		for( uint32 corner = 0; corner < 3; ++corner ) {
+			Vec3 position = mesh.vData[ mesh.iData[ triangle * 3 + corner ] ];
+			uint32 x = (uint32)( ( position.x + 1.0f ) * 0.5f * gridSize + 0.5f );
+			uint32 y = (uint32)( ( 1.0f - position.z ) * 0.5f * gridSize + 0.5f );
+			ids[ corner ] = y * rowLength + x;
+		}
+		loadedKeys[ triangle ] = CheckTriangleKey( ids[0], ids[1], ids[2] );
+	}
+	for( uint32 y = 0; y < gridSize; ++y ) {
+		for( uint32 x = 0; x < gridSize; ++x ) {
+			uint32 a = y * rowLength + x;
+			uint32 quad[6] = { a, a + 1, a + rowLength + 1, a, a + rowLength + 1, a + rowLength };
+			memcpy( &writtenIndices[ ( y * gridSize + x ) * 6 ], quad, sizeof( quad ) );
+		}
+	}
+	for( uint32 triangle = 0; triangle < triangleCount; ++triangle ) {
+		writtenKeys[ triangle ] = CheckTriangleKey( writtenIndices[ triangle * 3 ], writtenIndices[ triangle * 3 + 1 ], writtenIndices[ triangle * 3 + 2 ] );
+	}
+	qsort( loadedKeys, loadedTriangles, sizeof( uint64 ), CompareTriangleKeys );
+	qsort( writtenKeys, triangleCount, sizeof( uint64 ), CompareTriangleKeys );
+	if( loadedTriangles != triangleCount || memcmp( loadedKeys, writtenKeys, sizeof( uint64 ) * triangleCount ) != 0 ) {
+		printf( "  the grid's triangles or their winding changed on the way through the loader\n" );
+		failures++;
+	}
+
+	float writtenACMR = MeasureLRUCacheACMR( writtenIndices, triangleCount * 3 );
+	float loadedACMR = MeasureLRUCacheACMR( mesh.iData, mesh.dataCount );
+	printf( "Grid mesh: %u vertices, %u indices, LRU %u ACMR %.3f as written, %.3f as loaded\n", mesh.vertexCount,
+		mesh.dataCount, VERTEX_CACHE_SIZE, writtenACMR, loadedACMR );
+	//A regular grid can get close to 0.5 with a big cache, anything near the input order means the optimizer did nothing
+	if( !( loadedACMR < writtenACMR ) || loadedACMR > 0.75f ) {
+		printf( "  the optimized order should miss less than the written order, and under 0.75 per triangle\n" );
+		failures++;
+	}
+	FreeAssetMemory( loadedKeys );
+	FreeAssetMemory( writtenKeys );
+	FreeAssetMemory( writtenIndices );
+	return failures;
+}
+
+///Returns how many checks failed
+static uint32 RunLoaderChecks( MemorySlab* slab ) {
+	uint32 failures = 0;
+	failures += CheckFloatParsing();
+	failures += CheckOversizedMeshLoads( slab );
+	failures += CheckGridWeldAndCacheOrder( slab );
+	if( failures == 0 ) {
+		printf( "Loader checks passed\n" );
+	} else {
+		printf( "%u loader checks failed\n", failures );
+	}
+	return failures;
+}
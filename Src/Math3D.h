@@ -4,6 +4,12 @@
 
 //This whole thing is like 95% lifted code from Polycode, so credit there.
 
+//SSE paths for the hot Mat4 functions, define MATH3D_NO_SIMD to force the scalar versions
+#if !defined( MATH3D_NO_SIMD ) && ( defined( __SSE__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 1 ) )
+	#define MATH3D_SSE
+	#include <xmmintrin.h>
+#endif
+
 #define PI 3.14159265359
 
 struct Vec3 {
@@ -14,12 +20,17 @@ struct Quat {
 	float w, x, y, z;
 };
 
-struct Mat4 {
+//Aligned so each row can be loaded straight into an SSE register, anything holding a Mat4 has to respect this
+struct alignas( 16 ) Mat4 {
 	float m[4][4];
 
 	float* operator [] ( int i ) {
 		return m[i];
 	}
+
+	const float* operator [] ( int i ) const {
+		return m[i];
+	}
 };
 
 float InvSqrt(float x) {
@@ -121,7 +132,7 @@ void SetRotation( Mat4* mtx, float x, float y, float z, float angle) {
 	mtx->m[3][0] = 0.0f; mtx->m[3][1] = 0.0f; mtx->m[3][1] = 0.0f;	mtx->m[3][3] = 1.0f;
 }
 
-Mat4 TransposeMatrix( Mat4 m ) {
+Mat4 TransposeMatrix( const Mat4& m ) {
 	Mat4 r;
 	for( uint8 y = 0; y < 4; y++ ) {
 		for( uint8 x = 0; x < 4; x++ ) {
@@ -132,8 +143,22 @@ Mat4 TransposeMatrix( Mat4 m ) {
 	return r;
 }
 
-Mat4 MultMatrix(const Mat4 m, const Mat4 m2) {
+Mat4 MultMatrix( const Mat4& m, const Mat4& m2 ) {
 	Mat4 r;
+#ifdef MATH3D_SSE
+	__m128 row0 = _mm_load_ps( m2.m[0] );
+	__m128 row1 = _mm_load_ps( m2.m[1] );
+	__m128 row2 = _mm_load_ps( m2.m[2] );
+	__m128 row3 = _mm_load_ps( m2.m[3] );
+	for( int i = 0; i < 4; ++i ) {
+		//Row i of the result is row i of m used as weights on the rows of m2
+		__m128 sum = _mm_mul_ps( _mm_set1_ps( m.m[i][0] ), row0 );
+		sum = _mm_add_ps( sum, _mm_mul_ps( _mm_set1_ps( m.m[i][1] ), row1 ) );
+		sum = _mm_add_ps( sum, _mm_mul_ps( _mm_set1_ps( m.m[i][2] ), row2 ) );
+		sum = _mm_add_ps( sum, _mm_mul_ps( _mm_set1_ps( m.m[i][3] ), row3 ) );
+		_mm_store_ps( r.m[i], sum );
+	}
+#else
 	r.m[0][0] = m.m[0][0] * m2.m[0][0] + m.m[0][1] * m2.m[1][0] + m.m[0][2] * m2.m[2][0] + m.m[0][3] * m2.m[3][0];
 	r.m[0][1] = m.m[0][0] * m2.m[0][1] + m.m[0][1] * m2.m[1][1] + m.m[0][2] * m2.m[2][1] + m.m[0][3] * m2.m[3][1];
 	r.m[0][2] = m.m[0][0] * m2.m[0][2] + m.m[0][1] * m2.m[1][2] + m.m[0][2] * m2.m[2][2] + m.m[0][3] * m2.m[3][2];
@@ -153,11 +178,85 @@ Mat4 MultMatrix(const Mat4 m, const Mat4 m2) {
 	r.m[3][1] = m.m[3][0] * m2.m[0][1] + m.m[3][1] * m2.m[1][1] + m.m[3][2] * m2.m[2][1] + m.m[3][3] * m2.m[3][1];
 	r.m[3][2] = m.m[3][0] * m2.m[0][2] + m.m[3][1] * m2.m[1][2] + m.m[3][2] * m2.m[2][2] + m.m[3][3] * m2.m[3][2];
 	r.m[3][3] = m.m[3][0] * m2.m[0][3] + m.m[3][1] * m2.m[1][3] + m.m[3][2] * m2.m[2][3] + m.m[3][3] * m2.m[3][3];
+#endif
 
 	return r;
 }
 
-Mat4 InverseMatrix( Mat4 m ) {
+#ifdef MATH3D_SSE
+#define MATH3D_SHUFFLE( a, b, x, y, z, w ) _mm_shuffle_ps( a, b, _MM_SHUFFLE( w, z, y, x ) )
+#define MATH3D_SWIZZLE( v, x, y, z, w ) MATH3D_SHUFFLE( v, v, x, y, z, w )
+
+//The inverse works on 2x2 blocks packed into one register as ( m00, m01, m10, m11 )
+//A * B
+inline __m128 Mat2Mul( __m128 a, __m128 b ) {
+	return _mm_add_ps( _mm_mul_ps( a, MATH3D_SWIZZLE( b, 0, 3, 0, 3 ) ),
+	                   _mm_mul_ps( MATH3D_SWIZZLE( a, 1, 0, 3, 2 ), MATH3D_SWIZZLE( b, 2, 1, 2, 1 ) ) );
+}
+
+//adjugate( A ) * B
+inline __m128 Mat2AdjMul( __m128 a, __m128 b ) {
+	return _mm_sub_ps( _mm_mul_ps( MATH3D_SWIZZLE( a, 3, 3, 0, 0 ), b ),
+	                   _mm_mul_ps( MATH3D_SWIZZLE( a, 1, 1, 2, 2 ), MATH3D_SWIZZLE( b, 2, 3, 0, 1 ) ) );
+}
+
+//A * adjugate( B )
+inline __m128 Mat2MulAdj( __m128 a, __m128 b ) {
+	return _mm_sub_ps( _mm_mul_ps( a, MATH3D_SWIZZLE( b, 3, 0, 3, 0 ) ),
+	                   _mm_mul_ps( MATH3D_SWIZZLE( a, 1, 0, 3, 2 ), MATH3D_SWIZZLE( b, 2, 1, 2, 1 ) ) );
+}
+#endif
+
+Mat4 InverseMatrix( const Mat4& m ) {
+#ifdef MATH3D_SSE
+	//Block inversion, M = | A B | and every block's inverse is built from 2x2 adjugates and determinants
+	//                     | C D |
+	__m128 row0 = _mm_load_ps( m.m[0] );
+	__m128 row1 = _mm_load_ps( m.m[1] );
+	__m128 row2 = _mm_load_ps( m.m[2] );
+	__m128 row3 = _mm_load_ps( m.m[3] );
+	__m128 a = _mm_movelh_ps( row0, row1 );
+	__m128 b = _mm_movehl_ps( row1, row0 );
+	__m128 c = _mm_movelh_ps( row2, row3 );
+	__m128 d = _mm_movehl_ps( row3, row2 );
+
+	//( |A|, |B|, |C|, |D| )
+	__m128 detSub = _mm_sub_ps(
+		_mm_mul_ps( MATH3D_SHUFFLE( row0, row2, 0, 2, 0, 2 ), MATH3D_SHUFFLE( row1, row3, 1, 3, 1, 3 ) ),
+		_mm_mul_ps( MATH3D_SHUFFLE( row0, row2, 1, 3, 1, 3 ), MATH3D_SHUFFLE( row1, row3, 0, 2, 0, 2 ) ) );
+	__m128 detA = MATH3D_SWIZZLE( detSub, 0, 0, 0, 0 );
+	__m128 detB = MATH3D_SWIZZLE( detSub, 1, 1, 1, 1 );
+	__m128 detC = MATH3D_SWIZZLE( detSub, 2, 2, 2, 2 );
+	__m128 detD = MATH3D_SWIZZLE( detSub, 3, 3, 3, 3 );
+
+	__m128 dAdjC = Mat2AdjMul( d, c );
+	__m128 aAdjB = Mat2AdjMul( a, b );
+	__m128 x = _mm_sub_ps( _mm_mul_ps( detD, a ), Mat2Mul( b, dAdjC ) );
+	__m128 w = _mm_sub_ps( _mm_mul_ps( detA, d ), Mat2Mul( c, aAdjB ) );
+	__m128 y = _mm_sub_ps( _mm_mul_ps( detB, c ), Mat2MulAdj( d, aAdjB ) );
+	__m128 z = _mm_sub_ps( _mm_mul_ps( detC, b ), Mat2MulAdj( a, dAdjC ) );
+
+	//|M| = |A||D| + |B||C| - trace( adj(A)B * adj(D)C )
+	__m128 detM = _mm_add_ps( _mm_mul_ps( detA, detD ), _mm_mul_ps( detB, detC ) );
+	__m128 trace = _mm_mul_ps( aAdjB, MATH3D_SWIZZLE( dAdjC, 0, 2, 1, 3 ) );
+	trace = _mm_add_ps( trace, _mm_movehl_ps( trace, trace ) );
+	trace = _mm_add_ps( trace, MATH3D_SWIZZLE( trace, 1, 1, 1, 1 ) );
+	detM = _mm_sub_ps( detM, MATH3D_SWIZZLE( trace, 0, 0, 0, 0 ) );
+
+	__m128 invDetM = _mm_div_ps( _mm_setr_ps( 1.0f, -1.0f, -1.0f, 1.0f ), detM );
+	x = _mm_mul_ps( x, invDetM );
+	y = _mm_mul_ps( y, invDetM );
+	z = _mm_mul_ps( z, invDetM );
+	w = _mm_mul_ps( w, invDetM );
+
+	//Adjugate and un-pack the blocks back into rows in one shuffle
+	Mat4 retVal;
+	_mm_store_ps( retVal.m[0], MATH3D_SHUFFLE( x, y, 3, 1, 3, 1 ) );
+	_mm_store_ps( retVal.m[1], MATH3D_SHUFFLE( x, y, 2, 0, 2, 0 ) );
+	_mm_store_ps( retVal.m[2], MATH3D_SHUFFLE( z, w, 3, 1, 3, 1 ) );
+	_mm_store_ps( retVal.m[3], MATH3D_SHUFFLE( z, w, 2, 0, 2, 0 ) );
+	return retVal;
+#else
 	float m00 = m.m[0][0], m01 = m.m[0][1], m02 = m.m[0][2], m03 = m.m[0][3];
 	float m10 = m.m[1][0], m11 = m.m[1][1], m12 = m.m[1][2], m13 = m.m[1][3];
 	float m20 = m.m[2][0], m21 = m.m[2][1], m22 = m.m[2][2], m23 = m.m[2][3];
@@ -217,6 +316,7 @@ Mat4 InverseMatrix( Mat4 m ) {
     retVal.m[2][0] = d20; retVal.m[2][1] = d21; retVal.m[2][2] = d22; retVal.m[2][3] = d23;
     retVal.m[3][0] = d30; retVal.m[3][1] = d31; retVal.m[3][2] = d32; retVal.m[3][3] = d33;
     return retVal;
+#endif
 }
 
 Mat4 LookAtMatrix( Vec3 position, Vec3 target, Vec3 up ) {
@@ -235,17 +335,27 @@ Mat4 LookAtMatrix( Vec3 position, Vec3 target, Vec3 up ) {
 	return lookatMat;
 }
 
-Mat4 operator * ( const Mat4 m1, const Mat4 m2 ) {
+Mat4 operator * ( const Mat4& m1, const Mat4& m2 ) {
 	return MultMatrix(m1, m2);
 }
 
-Vec3 MultVec( Mat4 m, Vec3 v ) {
+Vec3 MultVec( const Mat4& m, Vec3 v ) {
+#ifdef MATH3D_SSE
+	__m128 r = _mm_load_ps( m.m[3] );
+	r = _mm_add_ps( r, _mm_mul_ps( _mm_set1_ps( v.x ), _mm_load_ps( m.m[0] ) ) );
+	r = _mm_add_ps( r, _mm_mul_ps( _mm_set1_ps( v.y ), _mm_load_ps( m.m[1] ) ) );
+	r = _mm_add_ps( r, _mm_mul_ps( _mm_set1_ps( v.z ), _mm_load_ps( m.m[2] ) ) );
+	float out[4];
+	_mm_storeu_ps( out, r );
+	return { out[0], out[1], out[2] };
+#else
 	return { v.x * m.m[0][0] + v.y * m.m[1][0] + v.z * m.m[2][0] + m.m[3][0],
 		     v.x * m.m[0][1] + v.y * m.m[1][1] + v.z * m.m[2][1] + m.m[3][1],
 		     v.x * m.m[0][2] + v.y * m.m[1][2] + v.z * m.m[2][2] + m.m[3][2] };
+#endif
 }
 
-Vec3 GetEulersFromMat4( Mat4 m ) {
+Vec3 GetEulersFromMat4( const Mat4& m ) {
 	Vec3 r1 = { m[0][0], m[0][1], m[0][2] };
 	Vec3 r2 = { m[1][0], m[1][1], m[1][2] };
 	Vec3 r3 = { m[2][0], m[2][1], m[2][2] };
@@ -373,6 +483,26 @@ Quat Slerp( const Quat q1, const Quat q2, float weight ) {
 	return qr;
 }
 
+///Normalized lerp along the shorter arc, close enough to slerp for the small steps between simulation states
+Quat Nlerp( const Quat q1, const Quat q2, float weight ) {
+	float dotproduct = q1.x * q2.x + q1.y * q2.y + q1.z * q2.z + q1.w * q2.w;
+	float w2 = dotproduct < 0.0f ? -weight : weight;
+	float w1 = 1.0f - weight;
+
+	Quat qr;
+	qr.w = w1 * q1.w + w2 * q2.w;
+	qr.x = w1 * q1.x + w2 * q2.x;
+	qr.y = w1 * q1.y + w2 * q2.y;
+	qr.z = w1 * q1.z + w2 * q2.z;
+
+	float leninv = 1.0f / sqrtf( qr.x * qr.x + qr.y * qr.y + qr.z * qr.z + qr.w * qr.w );
+	qr.w *= leninv;
+	qr.x *= leninv;
+	qr.y *= leninv;
+	qr.z *= leninv;
+	return qr;
+}
+
 Vec3 ApplyQuatToVec( Quat q, Vec3 v ) {
 	//Credit to Casey Muratori
 	Vec3 t = Cross( {q.x, q.y, q.z }, v ) * 2.0f;
@@ -418,7 +548,7 @@ Mat4 MatrixFromQuat(const Quat quat) {
 	return matx;
 }
 
-Quat QuatFromMatrix( const Mat4 matrix ) {
+Quat QuatFromMatrix( const Mat4& matrix ) {
 	Quat quat;
 	float tr, s, q[4];
 	int i, j, k;
@@ -465,6 +595,19 @@ Quat QuatFromMatrix( const Mat4 matrix ) {
 	return quat;
 }
 
+///Rotation about y, then x, then z. Closed form of MultQuats( z, MultQuats( x, y ) ) without building the three quats
+Quat QuatFromEulersYXZ( Vec3 angles ) {
+	float cx = cosf( angles.x * 0.5f ), sx = sinf( angles.x * 0.5f );
+	float cy = cosf( angles.y * 0.5f ), sy = sinf( angles.y * 0.5f );
+	float cz = cosf( angles.z * 0.5f ), sz = sinf( angles.z * 0.5f );
+	return {
+		cz * cx * cy - sz * sx * sy,
+		cz * sx * cy - sz * cx * sy,
+		cz * cx * sy + sz * sx * cy,
+		cz * sx * sy + sz * cx * cy
+	};
+}
+
 Vec3 QuatToEuler( const Quat q ) {
 	return {
 		atan2( 2.0f * ( q.w * q.x + q.y * q.z ), 1.0f - 2.0f * ( q.x * q.x + q.y * q.y ) ),
@@ -504,7 +647,7 @@ Mat4 Mat4FromComponents( Vec3 scale, Quat rotation, Vec3 translation ) {
 }
 
 //Sets scale scale and translation to 0 and rotation to { 1,0,0,0 } if it cannot be decomposed
-void DecomposeMat4( Mat4 m, Vec3* scale, Quat* rotation, Vec3* translation ) {
+void DecomposeMat4( const Mat4& m, Vec3* scale, Quat* rotation, Vec3* translation ) {
 	//TODO: simpler decomposition code
 	Vec3 p = { 0.0f, 0.0f, 0.0f };
 	Vec3 xp = { 1.0f, 0.0f, 0.0f };
@@ -531,4 +674,195 @@ void DecomposeMat4( Mat4 m, Vec3* scale, Quat* rotation, Vec3* translation ) {
 	*rotation = MultQuats( rot2, rot1 );
 }
 
-#endif
\ No newline at end of file
+/*---------------------------------------------------------------------------------------------------
+                                           Batch Functions
+    Pointer + count versions of the above for whole arrays at once. Strides are in bytes, 0 means
+    tightly packed, and must keep every Mat4 16 byte aligned (any struct holding a Mat4 already does)
+-----------------------------------------------------------------------------------------------------*/
+
+#ifdef MATH3D_SSE
+//Row-vector times the four rows of a matrix already sitting in registers
+inline __m128 MultRowByRows( const float* row, __m128 r0, __m128 r1, __m128 r2, __m128 r3 ) {
+	__m128 sum = _mm_mul_ps( _mm_set1_ps( row[0] ), r0 );
+	sum = _mm_add_ps( sum, _mm_mul_ps( _mm_set1_ps( row[1] ), r1 ) );
+	sum = _mm_add_ps( sum, _mm_mul_ps( _mm_set1_ps( row[2] ), r2 ) );
+	return _mm_add_ps( sum, _mm_mul_ps( _mm_set1_ps( row[3] ), r3 ) );
+}
+
+//Four packed Vec3s ( 3 registers ) to one register per component and back
+inline void Vec3x4ToSoA( const Vec3* v, __m128* xs, __m128* ys, __m128* zs ) {
+	__m128 p0 = _mm_loadu_ps( &v[0].x );	// x0 y0 z0 x1
+	__m128 p1 = _mm_loadu_ps( &v[1].y );	// y1 z1 x2 y2
+	__m128 p2 = _mm_loadu_ps( &v[2].z );	// z2 x3 y3 z3
+	__m128 xy23 = MATH3D_SHUFFLE( p1, p2, 2, 3, 1, 2 );
+	__m128 yz01 = MATH3D_SHUFFLE( p0, p1, 1, 2, 0, 1 );
+	*xs = MATH3D_SHUFFLE( p0, xy23, 0, 3, 0, 2 );
+	*ys = MATH3D_SHUFFLE( yz01, xy23, 0, 2, 1, 3 );
+	*zs = MATH3D_SHUFFLE( yz01, p2, 1, 3, 0, 3 );
+}
+
+inline void Vec3x4FromSoA( __m128 xs, __m128 ys, __m128 zs, Vec3* v ) {
+	__m128 p0 = MATH3D_SHUFFLE( MATH3D_SHUFFLE( xs, ys, 0, 0, 0, 0 ), MATH3D_SHUFFLE( zs, xs, 0, 0, 1, 1 ), 0, 2, 0, 2 );
+	__m128 p1 = MATH3D_SHUFFLE( MATH3D_SHUFFLE( ys, zs, 1, 1, 1, 1 ), MATH3D_SHUFFLE( xs, ys, 2, 2, 2, 2 ), 0, 2, 0, 2 );
+	__m128 p2 = MATH3D_SHUFFLE( MATH3D_SHUFFLE( zs, xs, 2, 2, 3, 3 ), MATH3D_SHUFFLE( ys, zs, 3, 3, 3, 3 ), 0, 2, 0, 2 );
+	_mm_storeu_ps( &v[0].x, p0 );
+	_mm_storeu_ps( &v[1].y, p1 );
+	_mm_storeu_ps( &v[2].z, p2 );
+}
+#endif
+
+///out[i] = matrices[i] * m, out may alias matrices
+void MultMatrixArray( const Mat4* matrices, const Mat4& m, Mat4* out, uint32 count ) {
+#ifdef MATH3D_SSE
+	__m128 r0 = _mm_load_ps( m.m[0] );
+	__m128 r1 = _mm_load_ps( m.m[1] );
+	__m128 r2 = _mm_load_ps( m.m[2] );
+	__m128 r3 = _mm_load_ps( m.m[3] );
+	for( uint32 i = 0; i < count; ++i ) {
+		__m128 o0 = MultRowByRows( matrices[i].m[0], r0, r1, r2, r3 );
+		__m128 o1 = MultRowByRows( matrices[i].m[1], r0, r1, r2, r3 );
+		__m128 o2 = MultRowByRows( matrices[i].m[2], r0, r1, r2, r3 );
+		__m128 o3 = MultRowByRows( matrices[i].m[3], r0, r1, r2, r3 );
+		_mm_store_ps( out[i].m[0], o0 );
+		_mm_store_ps( out[i].m[1], o1 );
+		_mm_store_ps( out[i].m[2], o2 );
+		_mm_store_ps( out[i].m[3], o3 );
+	}
+#else
+	for( uint32 i = 0; i < count; ++i ) {
+		out[i] = MultMatrix( matrices[i], m );
+	}
+#endif
+}
+
+///out[i] = a[i] * b[i], for when the matrices live inside bigger structs (bones, keyframes, render params)
+void MultMatrixArrays( const Mat4* a, const Mat4* b, Mat4* out, uint32 count, uint32 aStride = 0, uint32 bStride = 0, uint32 outStride = 0 ) {
+	if( aStride == 0 ) aStride = sizeof( Mat4 );
+	if( bStride == 0 ) bStride = sizeof( Mat4 );
+	if( outStride == 0 ) outStride = sizeof( Mat4 );
+
+	for( uint32 i = 0; i < count; ++i ) {
+		const Mat4* ai = (const Mat4*)( (const uint8*)a + i * aStride );
+		const Mat4* bi = (const Mat4*)( (const uint8*)b + i * bStride );
+		Mat4* outi = (Mat4*)( (uint8*)out + i * outStride );
+		*outi = MultMatrix( *ai, *bi );
+	}
+}
+
+///Transforms count points by m ( w = 1 ), out may alias points
+void MultVecArray( const Mat4& m, const Vec3* points, Vec3* out, uint32 count ) {
+	uint32 i = 0;
+#ifdef MATH3D_SSE
+	//Splat the matrix once so four points go through as plain multiply-adds
+	__m128 m00 = _mm_set1_ps( m.m[0][0] ), m01 = _mm_set1_ps( m.m[0][1] ), m02 = _mm_set1_ps( m.m[0][2] );
+	__m128 m10 = _mm_set1_ps( m.m[1][0] ), m11 = _mm_set1_ps( m.m[1][1] ), m12 = _mm_set1_ps( m.m[1][2] );
+	__m128 m20 = _mm_set1_ps( m.m[2][0] ), m21 = _mm_set1_ps( m.m[2][1] ), m22 = _mm_set1_ps( m.m[2][2] );
+	__m128 m30 = _mm_set1_ps( m.m[3][0] ), m31 = _mm_set1_ps( m.m[3][1] ), m32 = _mm_set1_ps( m.m[3][2] );
+	for( ; i + 4 <= count; i += 4 ) {
+		__m128 xs, ys, zs;
+		Vec3x4ToSoA( &points[i], &xs, &ys, &zs );
+		__m128 rx = _mm_add_ps( _mm_add_ps( _mm_mul_ps( xs, m00 ), _mm_mul_ps( ys, m10 ) ), _mm_add_ps( _mm_mul_ps( zs, m20 ), m30 ) );
+		__m128 ry = _mm_add_ps( _mm_add_ps( _mm_mul_ps( xs, m01 ), _mm_mul_ps( ys, m11 ) ), _mm_add_ps( _mm_mul_ps( zs, m21 ), m31 ) );
+		__m128 rz = _mm_add_ps( _mm_add_ps( _mm_mul_ps( xs, m02 ), _mm_mul_ps( ys, m12 ) ), _mm_add_ps( _mm_mul_ps( zs, m22 ), m32 ) );
+		Vec3x4FromSoA( rx, ry, rz, &out[i] );
+	}
+#endif
+	for( ; i < count; ++i ) {
+		out[i] = MultVec( m, points[i] );
+	}
+}
+
+///QuatFromEulersYXZ for count angle sets
+void QuatArrayFromEulersYXZ( const Vec3* angles, Quat* out, uint32 count ) {
+	uint32 i = 0;
+#ifdef MATH3D_SSE
+	for( ; i + 4 <= count; i += 4 ) {
+		//sin/cos stay scalar, the products are done four quats at a time
+		alignas( 16 ) float halfSines[12];
+		alignas( 16 ) float halfCosines[12];
+		for( uint8 lane = 0; lane < 4; ++lane ) {
+			const Vec3* a = &angles[ i + lane ];
+			halfSines[ lane ] = sinf( a->x * 0.5f ); halfCosines[ lane ] = cosf( a->x * 0.5f );
+			halfSines[ 4 + lane ] = sinf( a->y * 0.5f ); halfCosines[ 4 + lane ] = cosf( a->y * 0.5f );
+			halfSines[ 8 + lane ] = sinf( a->z * 0.5f ); halfCosines[ 8 + lane ] = cosf( a->z * 0.5f );
+		}
+		__m128 sx = _mm_load_ps( &halfSines[0] ), cx = _mm_load_ps( &halfCosines[0] );
+		__m128 sy = _mm_load_ps( &halfSines[4] ), cy = _mm_load_ps( &halfCosines[4] );
+		__m128 sz = _mm_load_ps( &halfSines[8] ), cz = _mm_load_ps( &halfCosines[8] );
+
+		__m128 cxcy = _mm_mul_ps( cx, cy ), sxsy = _mm_mul_ps( sx, sy );
+		__m128 sxcy = _mm_mul_ps( sx, cy ), cxsy = _mm_mul_ps( cx, sy );
+		__m128 w = _mm_sub_ps( _mm_mul_ps( cz, cxcy ), _mm_mul_ps( sz, sxsy ) );
+		__m128 x = _mm_sub_ps( _mm_mul_ps( cz, sxcy ), _mm_mul_ps( sz, cxsy ) );
+		__m128 y = _mm_add_ps( _mm_mul_ps( cz, cxsy ), _mm_mul_ps( sz, sxcy ) );
+		__m128 z = _mm_add_ps( _mm_mul_ps( cz, sxsy ), _mm_mul_ps( sz, cxcy ) );
+		_MM_TRANSPOSE4_PS( w, x, y, z );
+		_mm_storeu_ps( &out[ i + 0 ].w, w );
+		_mm_storeu_ps( &out[ i + 1 ].w, x );
+		_mm_storeu_ps( &out[ i + 2 ].w, y );
+		_mm_storeu_ps( &out[ i + 3 ].w, z );
+	}
+#endif
+	for( ; i < count; ++i ) {
+		out[i] = QuatFromEulersYXZ( angles[i] );
+	}
+}
+
+///Scale, then rotate, then translate, for count transforms. Unlike Mat4FromComponents the scale is applied to whole rows,
+///so non-uniform scale on a rotated transform comes out right
+void Mat4ArrayFromComponents( const Vec3* scales, const Quat* rotations, const Vec3* translations, Mat4* out, uint32 count ) {
+	uint32 i = 0;
+#ifdef MATH3D_SSE
+	const __m128 one = _mm_set1_ps( 1.0f );
+	const __m128 two = _mm_set1_ps( 2.0f );
+	for( ; i + 4 <= count; i += 4 ) {
+		//Four transforms at a time, one lane each
+		__m128 qw = _mm_loadu_ps( &rotations[i + 0].w );
+		__m128 qx = _mm_loadu_ps( &rotations[i + 1].w );
+		__m128 qy = _mm_loadu_ps( &rotations[i + 2].w );
+		__m128 qz = _mm_loadu_ps( &rotations[i + 3].w );
+		_MM_TRANSPOSE4_PS( qw, qx, qy, qz );
+		__m128 sx, sy, sz, tx, ty, tz;
+		Vec3x4ToSoA( &scales[i], &sx, &sy, &sz );
+		Vec3x4ToSoA( &translations[i], &tx, &ty, &tz );
+
+		__m128 x2 = _mm_mul_ps( qx, two ), y2 = _mm_mul_ps( qy, two ), z2 = _mm_mul_ps( qz, two );
+		__m128 xx = _mm_mul_ps( qx, x2 ), yy = _mm_mul_ps( qy, y2 ), zz = _mm_mul_ps( qz, z2 );
+		__m128 xy = _mm_mul_ps( qx, y2 ), xz = _mm_mul_ps( qx, z2 ), yz = _mm_mul_ps( qy, z2 );
+		__m128 wx = _mm_mul_ps( qw, x2 ), wy = _mm_mul_ps( qw, y2 ), wz = _mm_mul_ps( qw, z2 );
+
+		//Row n is the rotated basis axis n, same as ApplyQuatToVec gives, times its scale
+		__m128 row0[4] = { _mm_mul_ps( _mm_sub_ps( one, _mm_add_ps( yy, zz ) ), sx ), _mm_mul_ps( _mm_add_ps( xy, wz ), sx ), _mm_mul_ps( _mm_sub_ps( xz, wy ), sx ), _mm_setzero_ps() };
+		__m128 row1[4] = { _mm_mul_ps( _mm_sub_ps( xy, wz ), sy ), _mm_mul_ps( _mm_sub_ps( one, _mm_add_ps( xx, zz ) ), sy ), _mm_mul_ps( _mm_add_ps( yz, wx ), sy ), _mm_setzero_ps() };
+		__m128 row2[4] = { _mm_mul_ps( _mm_add_ps( xz, wy ), sz ), _mm_mul_ps( _mm_sub_ps( yz, wx ), sz ), _mm_mul_ps( _mm_sub_ps( one, _mm_add_ps( xx, yy ) ), sz ), _mm_setzero_ps() };
+		__m128 row3[4] = { tx, ty, tz, one };
+		_MM_TRANSPOSE4_PS( row0[0], row0[1], row0[2], row0[3] );
+		_MM_TRANSPOSE4_PS( row1[0], row1[1], row1[2], row1[3] );
+		_MM_TRANSPOSE4_PS( row2[0], row2[1], row2[2], row2[3] );
+		_MM_TRANSPOSE4_PS( row3[0], row3[1], row3[2], row3[3] );
+		for( uint8 lane = 0; lane < 4; ++lane ) {
+			_mm_store_ps( out[i + lane].m[0], row0[ lane ] );
+			_mm_store_ps( out[i + lane].m[1], row1[ lane ] );
+			_mm_store_ps( out[i + lane].m[2], row2[ lane ] );
+			_mm_store_ps( out[i + lane].m[3], row3[ lane ] );
+		}
+	}
+#endif
+	for( ; i < count; ++i ) {
+		Quat q = rotations[i];
+		Vec3 s = scales[i];
+		Vec3 t = translations[i];
+		float x2 = q.x * 2.0f, y2 = q.y * 2.0f, z2 = q.z * 2.0f;
+		float xx = q.x * x2, yy = q.y * y2, zz = q.z * z2;
+		float xy = q.x * y2, xz = q.x * z2, yz = q.y * z2;
+		float wx = q.w * x2, wy = q.w * y2, wz = q.w * z2;
+
+		Mat4* m = &out[i];
+		m->m[0][0] = ( 1.0f - ( yy + zz ) ) * s.x; m->m[0][1] = ( xy + wz ) * s.x; m->m[0][2] = ( xz - wy ) * s.x; m->m[0][3] = 0.0f;
+		m->m[1][0] = ( xy - wz ) * s.y; m->m[1][1] = ( 1.0f - ( xx + zz ) ) * s.y; m->m[1][2] = ( yz + wx ) * s.y; m->m[1][3] = 0.0f;
+		m->m[2][0] = ( xz + wy ) * s.z; m->m[2][1] = ( yz - wx ) * s.z; m->m[2][2] = ( 1.0f - ( xx + yy ) ) * s.z; m->m[2][3] = 0.0f;
+		m->m[3][0] = t.x; m->m[3][1] = t.y; m->m[3][2] = t.z; m->m[3][3] = 1.0f;
+	}
+}
+
+#endif
@@ -1,23 +1,159 @@
-#define KILOBYTES(value) value * 1024
-#define MEGABYTES(value) KILOBYTES(value) * 1024
-#define GIGABYTES(value) MEGABYTES(value) * 1024
+#define KILOBYTES(value) ( (uint64)(value) * 1024 )
+#define MEGABYTES(value) ( KILOBYTES(value) * 1024 )
+#define GIGABYTES(value) ( MEGABYTES(value) * 1024 )
+
+enum SlabPageMode {
+	SLAB_PAGES_DEFAULT,
+	//Linux only, asks for transparent huge pages on the range and keeps commits 2MB aligned so they can be used
+	SLAB_PAGES_TRANSPARENT_HUGE,
+	//Linux only, MAP_HUGETLB from the preallocated pool, committed up front. Falls back to transparent if the pool is short
+	SLAB_PAGES_EXPLICIT_HUGE
+};
 
 struct MemorySlab {
 	void* slabStart;
 	void* current;
+	//Reserved address space, only the first committedSize bytes are backed
 	uint64 slabSize;
+	uint64 committedSize;
+	//Commits are rounded up to this so carving doesn't call into the OS every time
+	uint64 commitGranularity;
+	SlabPageMode pageMode;
 };
 
+/*------------------------------------------------------------------------------------------------------------------
+												Slab Reservation
+    The platform layer reserves a big address range once with ReserveMemorySlab, CarveNewSubsection commits pages
+    as it moves into them. Nothing is ever decommitted, subsections live as long as the slab
+-------------------------------------------------------------------------------------------------------------------*/
+
+#define SLAB_COMMIT_GRANULARITY KILOBYTES( 64 )
+#define SLAB_HUGE_PAGE_SIZE MEGABYTES( 2 )
+
+#if defined( WIN32_ENTRY )
+
+//Large pages on Windows need SeLockMemoryPrivilege and have to be committed with the reservation, so every mode
+//gets regular pages here
+MemorySlab ReserveMemorySlab( uint64 bytes, SlabPageMode pageMode = SLAB_PAGES_DEFAULT ) {
+	MemorySlab slab = { };
+	slab.slabStart = VirtualAlloc( NULL, bytes, MEM_RESERVE, PAGE_NOACCESS );
+	if( slab.slabStart == NULL ) {
+		printf( "Couldn't reserve %llu bytes of address space\n", (unsigned long long)bytes );
+		return slab;
+	}
+	slab.current = slab.slabStart;
+	slab.slabSize = bytes;
+	slab.committedSize = 0;
+	slab.commitGranularity = SLAB_COMMIT_GRANULARITY;
+	slab.pageMode = SLAB_PAGES_DEFAULT;
+	return slab;
+}
+
+static bool CommitSlabPages( MemorySlab* slab, uint64 offset, uint64 bytes ) {
+	return VirtualAlloc( (uint8*)slab->slabStart + offset, bytes, MEM_COMMIT, PAGE_READWRITE ) != NULL;
+}
+
+#elif defined( LINUX_ENTRY )
+#include <sys/mman.h>
+
+MemorySlab ReserveMemorySlab( uint64 bytes, SlabPageMode pageMode = SLAB_PAGES_DEFAULT ) {
+	MemorySlab slab = { };
+	slab.commitGranularity = SLAB_COMMIT_GRANULARITY;
+	slab.pageMode = pageMode;
+
+	if( pageMode == SLAB_PAGES_EXPLICIT_HUGE ) {
+		uint64 hugeBytes = ( bytes + SLAB_HUGE_PAGE_SIZE - 1 ) & ~( SLAB_HUGE_PAGE_SIZE - 1 );
+		void* hugeRange = mmap( NULL, hugeBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0 );
+		if( hugeRange != MAP_FAILED ) {
+			slab.slabStart = hugeRange;
+			slab.current = hugeRange;
+			slab.slabSize = hugeBytes;
+			slab.committedSize = hugeBytes;
+			return slab;
+		}
+		printf( "No explicit huge pages for %llu bytes, falling back to transparent ones\n", (unsigned long long)hugeBytes );
+		slab.pageMode = SLAB_PAGES_TRANSPARENT_HUGE;
+	}
+
+	//Over reserve by a huge page so the start can be moved up to a 2MB boundary, THP only maps aligned 2MB runs
+	bool wantsHugePages = slab.pageMode == SLAB_PAGES_TRANSPARENT_HUGE;
+	uint64 reserveBytes = wantsHugePages ? bytes + SLAB_HUGE_PAGE_SIZE : bytes;
+	void* range = mmap( NULL, reserveBytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0 );
+	if( range == MAP_FAILED ) {
+		printf( "Couldn't reserve %llu bytes of address space\n", (unsigned long long)reserveBytes );
+		return slab;
+	}
+
+	uintptr start = (uintptr)range;
+	if( wantsHugePages ) {
+		start = ( start + SLAB_HUGE_PAGE_SIZE - 1 ) & ~(uintptr)( SLAB_HUGE_PAGE_SIZE - 1 );
+		if( start > (uintptr)range ) munmap( range, start - (uintptr)range );
+		uintptr reserveEnd = (uintptr)range + reserveBytes;
+		if( reserveEnd > start + bytes ) munmap( (void*)( start + bytes ), reserveEnd - ( start + bytes ) );
+		slab.commitGranularity = SLAB_HUGE_PAGE_SIZE;
+#ifdef MADV_HUGEPAGE
+		madvise( (void*)start, bytes, MADV_HUGEPAGE );
+#endif
+	}
+
+	slab.slabStart = (void*)start;
+	slab.current = slab.slabStart;
+	slab.slabSize = bytes;
+	slab.committedSize = 0;
+	return slab;
+}
+
+static bool CommitSlabPages( MemorySlab* slab, uint64 offset, uint64 bytes ) {
+	return mprotect( (uint8*)slab->slabStart + offset, bytes, PROT_READ | PROT_WRITE ) == 0;
+}
+
+#else
+
+//No platform to ask, everything is backed up front
+MemorySlab ReserveMemorySlab( uint64 bytes, SlabPageMode pageMode = SLAB_PAGES_DEFAULT ) {
+	MemorySlab slab = { };
+	slab.slabStart = calloc( 1, bytes );
+	slab.current = slab.slabStart;
+	slab.slabSize = slab.slabStart != NULL ? bytes : 0;
+	slab.committedSize = slab.slabSize;
+	slab.commitGranularity = SLAB_COMMIT_GRANULARITY;
+	slab.pageMode = SLAB_PAGES_DEFAULT;
+	return slab;
+}
+
+static bool CommitSlabPages( MemorySlab* slab, uint64 offset, uint64 bytes ) {
+	return false;
+}
+
+#endif
+
+///Makes sure the first usedBytes of the slab are backed, committing whole granules past what already is
+static bool CommitSlabUpTo( MemorySlab* slab, uint64 usedBytes ) {
+	if( usedBytes <= slab->committedSize ) return true;
+
+	uint64 granularity = slab->commitGranularity;
+	uint64 newCommitted = ( usedBytes + granularity - 1 ) & ~( granularity - 1 );
+	if( newCommitted > slab->slabSize ) newCommitted = slab->slabSize;
+	if( !CommitSlabPages( slab, slab->committedSize, newCommitted - slab->committedSize ) ) {
+		printf( "Couldn't commit slab pages up to %llu bytes\n", (unsigned long long)newCommitted );
+		return false;
+	}
+	slab->committedSize = newCommitted;
+	return true;
+}
+
 struct SlabSubsection_Stack {
 	void* start;
 	void* end;
 	void* current;
 };
 
-SlabSubsection_Stack CarveNewSubsection( MemorySlab* slab, uint64 bytes ) {
+///Tag only shows up in memory reports, it's ignored unless MEMORY_TRACKING is defined
+SlabSubsection_Stack CarveNewSubsection( MemorySlab* slab, uint64 bytes, const char* = "Untagged" ) {
 	SlabSubsection_Stack slabSub = { 0, 0, 0 };
-	ptrdiff_t bytesLeft = slab->slabSize - ((uintptr)slab->current - (uintptr)slab->slabStart);
-	if( bytesLeft > bytes ) {
+	uint64 bytesUsed = (uintptr)slab->current - (uintptr)slab->slabStart;
+	uint64 bytesLeft = slab->slabSize - bytesUsed;
+	if( bytesLeft >= bytes && CommitSlabUpTo( slab, bytesUsed + bytes ) ) {
 		slabSub.start = slab->current;
 		slabSub.current = slab->current;
 		slab->current = (void*)( (intptr)slab->current + bytes );
@@ -28,9 +164,9 @@ SlabSubsection_Stack CarveNewSubsection( MemorySlab* slab, uint64 bytes ) {
 
 void* AllocOnSubStack( SlabSubsection_Stack* subStack, uint64 sizeInBytes ) {
 	//Check how much space is left in the sub stack
-	ptrdiff_t bytesLeft = (intptr)subStack->end - (intptr)subStack->current;
+	uint64 bytesLeft = (uintptr)subStack->end - (uintptr)subStack->current;
 	//Allocate if there's enough space left
-	if( bytesLeft > sizeInBytes ) {
+	if( bytesLeft >= sizeInBytes ) {
 		void* returnValue = subStack->current;
 		subStack->current = (void*)( (intptr)subStack->current + sizeInBytes );
 		return returnValue;
@@ -46,6 +182,9 @@ void* AllocOnSubStack_Aligned( SlabSubsection_Stack* subStack, uint64 size, uint
 
 	//Determine how "off" the basic allocated pointer is
 	uintptr rawAddress = (uintptr)AllocOnSubStack( subStack, expandedSize );
+	if( rawAddress == 0 ) {
+		return NULL;
+	}
 	uintptr alignmentMask = ( alignment - 1 );
 	uintptr misalignment = ( rawAddress & alignmentMask );
 
@@ -59,10 +198,646 @@ void ClearSubStack( SlabSubsection_Stack* subStack ) {
 	subStack->current = subStack->start;
 }
 
-void FreeStub( void* ptr ) {
+/*------------------------------------------------------------------------------------------------------------------
+												Memory Tracking
+    With MEMORY_TRACKING defined, every carve and sub stack alloc goes through a wrapper that records the call site,
+    tag, size and alignment, keeps per subsection high water marks and shouts about failures. Without it the macros
+    below don't exist and the report functions are empty
+-------------------------------------------------------------------------------------------------------------------*/
+
+#ifdef MEMORY_TRACKING
+#include <mutex>
+
+#define MEMORY_TRACKING_MAX_SUBSECTIONS 64
+#define MEMORY_TRACKING_MAX_RECORDS 2048
+
+struct AllocationRecord {
+	const char* file;
+	uint32 line;
+	uint8 alignment;
+	uint64 size;
+	void* address;
+	//Index into memoryTracking.subsections, -1 if the sub stack was never carved through the tracker
+	int32 subsectionIndex;
+};
+
+struct SubsectionRecord {
+	const char* tag;
+	const char* file;
+	uint32 line;
+	void* start;
+	void* end;
+	uint64 highWaterMark;
+	uint32 allocCount;
+	uint32 failedAllocCount;
+};
+
+static struct {
+	MemorySlab* slab;
+	SubsectionRecord subsections[ MEMORY_TRACKING_MAX_SUBSECTIONS ];
+	uint32 subsectionCount;
+	uint32 failedCarveCount;
+	AllocationRecord records[ MEMORY_TRACKING_MAX_RECORDS ];
+	uint32 recordCount;
+	//Allocs that happened after the record table filled up, still counted per subsection
+	uint32 droppedRecordCount;
+	//Asset load workers alloc and carve alongside the main thread
+	std::mutex lock;
+} memoryTracking;
+
+static int32 FindTrackedSubsection( SlabSubsection_Stack* subStack ) {
+	for( uint32 subIndex = 0; subIndex < memoryTracking.subsectionCount; ++subIndex ) {
+		if( memoryTracking.subsections[ subIndex ].start == subStack->start ) return subIndex;
+	}
+	return -1;
+}
+
+SlabSubsection_Stack TrackedCarveNewSubsection( const char* file, uint32 line, MemorySlab* slab, uint64 bytes, const char* tag = "Untagged" ) {
+	SlabSubsection_Stack slabSub = CarveNewSubsection( slab, bytes, tag );
+	std::lock_guard<std::mutex> guard( memoryTracking.lock );
+	memoryTracking.slab = slab;
+	if( slabSub.start == NULL ) {
+		printf( "%s(%u): couldn't carve %llu bytes for %s, %llu of %llu slab bytes already used\n", file, line,
+			(unsigned long long)bytes, tag, (unsigned long long)( (uintptr)slab->current - (uintptr)slab->slabStart ),
+			(unsigned long long)slab->slabSize );
+		memoryTracking.failedCarveCount++;
+		return slabSub;
+	}
+
+	if( memoryTracking.subsectionCount < MEMORY_TRACKING_MAX_SUBSECTIONS ) {
+		SubsectionRecord* record = &memoryTracking.subsections[ memoryTracking.subsectionCount++ ];
+		record->tag = tag;
+		record->file = file;
+		record->line = line;
+		record->start = slabSub.start;
+		record->end = slabSub.end;
+		record->highWaterMark = 0;
+		record->allocCount = 0;
+		record->failedAllocCount = 0;
+	}
+	return slabSub;
+}
+
+static void RecordSubStackAlloc( const char* file, uint32 line, SlabSubsection_Stack* subStack, uint64 size, uint8 alignment, void* address ) {
+	std::lock_guard<std::mutex> guard( memoryTracking.lock );
+	int32 subIndex = FindTrackedSubsection( subStack );
+	if( subIndex >= 0 ) {
+		SubsectionRecord* sub = &memoryTracking.subsections[ subIndex ];
+		if( address != NULL ) {
+			sub->allocCount++;
+			uint64 used = (uintptr)subStack->current - (uintptr)subStack->start;
+			if( used > sub->highWaterMark ) sub->highWaterMark = used;
+		} else {
+			sub->failedAllocCount++;
+		}
+	}
+
+	if( address == NULL ) {
+		printf( "%s(%u): couldn't alloc %llu bytes on %s, %llu of %llu bytes left\n", file, line, (unsigned long long)size,
+			subIndex >= 0 ? memoryTracking.subsections[ subIndex ].tag : "an untracked sub stack",
+			(unsigned long long)( (uintptr)subStack->end - (uintptr)subStack->current ),
+			(unsigned long long)( (uintptr)subStack->end - (uintptr)subStack->start ) );
+	}
+
+	if( memoryTracking.recordCount < MEMORY_TRACKING_MAX_RECORDS ) {
+		AllocationRecord* record = &memoryTracking.records[ memoryTracking.recordCount++ ];
+		record->file = file;
+		record->line = line;
+		record->alignment = alignment;
+		record->size = size;
+		record->address = address;
+		record->subsectionIndex = subIndex;
+	} else {
+		memoryTracking.droppedRecordCount++;
+	}
+}
+
+void* TrackedAllocOnSubStack( const char* file, uint32 line, SlabSubsection_Stack* subStack, uint64 sizeInBytes ) {
+	void* address = AllocOnSubStack( subStack, sizeInBytes );
+	RecordSubStackAlloc( file, line, subStack, sizeInBytes, 1, address );
+	return address;
+}
 
+void* TrackedAllocOnSubStack_Aligned( const char* file, uint32 line, SlabSubsection_Stack* subStack, uint64 size, uint8 alignment = 8 ) {
+	void* address = AllocOnSubStack_Aligned( subStack, size, alignment );
+	RecordSubStackAlloc( file, line, subStack, size, alignment, address );
+	return address;
+}
+
+///For allocators that move memory around inside a subsection themselves instead of going through AllocOnSubStack
+void TrackSubsectionUsage( void* subsectionStart, uint64 bytesInUse ) {
+	std::lock_guard<std::mutex> guard( memoryTracking.lock );
+	for( uint32 subIndex = 0; subIndex < memoryTracking.subsectionCount; ++subIndex ) {
+		SubsectionRecord* sub = &memoryTracking.subsections[ subIndex ];
+		if( sub->start == subsectionStart ) {
+			if( bytesInUse > sub->highWaterMark ) sub->highWaterMark = bytesInUse;
+			return;
+		}
+	}
+}
+
+///One line per subsection: how big it is, how much it has ever had in use at once, and where it was carved
+void PrintMemoryReport() {
+	std::lock_guard<std::mutex> guard( memoryTracking.lock );
+	MemorySlab* slab = memoryTracking.slab;
+	if( slab != NULL ) {
+		printf( "Slab: %llu of %llu bytes carved, %llu committed\n", (unsigned long long)( (uintptr)slab->current - (uintptr)slab->slabStart ),
+			(unsigned long long)slab->slabSize, (unsigned long long)slab->committedSize );
+	}
+	for( uint32 subIndex = 0; subIndex < memoryTracking.subsectionCount; ++subIndex ) {
+		SubsectionRecord* sub = &memoryTracking.subsections[ subIndex ];
+		uint64 size = (uintptr)sub->end - (uintptr)sub->start;
+		printf( "  %-16s %10llu bytes, high water %10llu (%5.1f%%), %u allocs, %u failed  [%s(%u)]\n", sub->tag,
+			(unsigned long long)size, (unsigned long long)sub->highWaterMark, size > 0 ? 100.0 * sub->highWaterMark / size : 0.0,
+			sub->allocCount, sub->failedAllocCount, sub->file, sub->line );
+	}
+	if( memoryTracking.failedCarveCount > 0 ) {
+		printf( "  %u carves failed\n", memoryTracking.failedCarveCount );
+	}
+}
+
+///Every recorded alloc in order, for when the summary isn't enough to tell who is eating a budget
+void DumpMemoryRecords( FILE* out ) {
+	std::lock_guard<std::mutex> guard( memoryTracking.lock );
+	for( uint32 recordIndex = 0; recordIndex < memoryTracking.recordCount; ++recordIndex ) {
+		AllocationRecord* record = &memoryTracking.records[ recordIndex ];
+		const char* tag = record->subsectionIndex >= 0 ? memoryTracking.subsections[ record->subsectionIndex ].tag : "Untracked";
+		fprintf( out, "%s(%u): %s %llu bytes align %u at %p\n", record->file, record->line, tag,
+			(unsigned long long)record->size, record->alignment, record->address );
+	}
+	if( memoryTracking.droppedRecordCount > 0 ) {
+		fprintf( out, "%u more allocs not recorded\n", memoryTracking.droppedRecordCount );
+	}
 }
 
-void ReallocStub( void* ptr ) {
-	
-}
\ No newline at end of file
+//Everything below this point, and every file included after it, goes through the trackers
+#define CarveNewSubsection( ... ) TrackedCarveNewSubsection( __FILE__, __LINE__, __VA_ARGS__ )
+#define AllocOnSubStack( ... ) TrackedAllocOnSubStack( __FILE__, __LINE__, __VA_ARGS__ )
+#define AllocOnSubStack_Aligned( ... ) TrackedAllocOnSubStack_Aligned( __FILE__, __LINE__, __VA_ARGS__ )
+
+#else
+
+void TrackSubsectionUsage( void* subsectionStart, uint64 bytesInUse ) { }
+void PrintMemoryReport() { }
+void DumpMemoryRecords( FILE* out ) { }
+
+#endif //MEMORY_TRACKING
+
+/*------------------------------------------------------------------------------------------------------------------
+												Frame Arena
+    Two stacks carved from the slab, the platform layer flips between them once per loop iteration. Anything pushed
+    during a frame stays valid through the next one, then gets overwritten. Nothing is ever freed individually
+-------------------------------------------------------------------------------------------------------------------*/
+
+#ifndef FRAME_ARENA_SIZE
+	//Per buffer, the arena takes twice this out of the slab
+	#define FRAME_ARENA_SIZE MEGABYTES( 4 )
+#endif
+
+struct FrameArena {
+	SlabSubsection_Stack buffers[2];
+	uint8 currentBuffer;
+	//Most bytes in use at once in a single buffer since creation
+	uint64 highWaterMark;
+	//Same per buffer, so each one's tracked subsection gets its own usage
+	uint64 bufferHighWaterMarks[2];
+	uint64 frameCount;
+};
+
+FrameArena CreateFrameArena( MemorySlab* slab, uint64 bytesPerBuffer ) {
+	FrameArena arena = { };
+	arena.buffers[0] = CarveNewSubsection( slab, bytesPerBuffer, "Frame Arena A" );
+	arena.buffers[1] = CarveNewSubsection( slab, bytesPerBuffer, "Frame Arena B" );
+	assert( arena.buffers[0].start != NULL && arena.buffers[1].start != NULL );
+	return arena;
+}
+
+///Called by the platform layer at the top of every loop iteration
+void ResetFrameArena( FrameArena* arena ) {
+	arena->currentBuffer ^= 1;
+	ClearSubStack( &arena->buffers[ arena->currentBuffer ] );
+	arena->frameCount++;
+}
+
+///Returns NULL (and asserts) if the current buffer is out of room
+void* PushSize( FrameArena* arena, uint64 size, uint64 alignment = 8 ) {
+	SlabSubsection_Stack* buffer = &arena->buffers[ arena->currentBuffer ];
+	uintptr alignedAddress = ( (uintptr)buffer->current + ( alignment - 1 ) ) & ~( (uintptr)alignment - 1 );
+	if( alignedAddress + size > (uintptr)buffer->end ) {
+		printf( "Frame arena out of space, wanted %llu bytes\n", (unsigned long long)size );
+		assert( false );
+		return NULL;
+	}
+	buffer->current = (void*)( alignedAddress + size );
+
+	uint64 bytesUsed = (uintptr)buffer->current - (uintptr)buffer->start;
+	if( bytesUsed > arena->bufferHighWaterMarks[ arena->currentBuffer ] ) {
+		arena->bufferHighWaterMarks[ arena->currentBuffer ] = bytesUsed;
+		TrackSubsectionUsage( buffer->start, bytesUsed );
+		if( bytesUsed > arena->highWaterMark ) arena->highWaterMark = bytesUsed;
+	}
+	return (void*)alignedAddress;
+}
+
+///Uninitialized, aligned for T
+template< typename T >
+T* PushArray( FrameArena* arena, uint64 count ) {
+	return (T*)PushSize( arena, sizeof( T ) * count, alignof( T ) );
+}
+
+template< typename T >
+T* PushStruct( FrameArena* arena ) {
+	return (T*)PushSize( arena, sizeof( T ), alignof( T ) );
+}
+
+///For scratch that shouldn't outlive a function, pop back to the mark once done with it
+void* GetFrameArenaMark( FrameArena* arena ) {
+	return arena->buffers[ arena->currentBuffer ].current;
+}
+
+void PopFrameArenaToMark( FrameArena* arena, void* mark ) {
+	arena->buffers[ arena->currentBuffer ].current = mark;
+}
+
+/*------------------------------------------------------------------------------------------------------------------
+												Pool Allocator
+    Fixed count of same sized slots carved from a sub stack. Free slots are threaded into a list through their own
+    storage, so alloc and free are both just a pointer swap. Only for plain data, no constructors/destructors are run
+-------------------------------------------------------------------------------------------------------------------*/
+
+template< typename T >
+struct Pool {
+	void* start;
+	void* end;
+	//Each free slot's first bytes hold the address of the next free slot
+	void* freeList;
+	uint64 slotSize;
+	uint32 capacity;
+	uint32 liveCount;
+};
+
+///Every slot starts out free, capacity is 0 if the sub stack couldn't fit them all
+template< typename T >
+Pool<T> CreatePool( SlabSubsection_Stack* allocater, uint32 capacity ) {
+	Pool<T> pool = { };
+	uint64 alignment = alignof( T ) > alignof( void* ) ? alignof( T ) : alignof( void* );
+	uint64 slotSize = sizeof( T ) > sizeof( void* ) ? sizeof( T ) : sizeof( void* );
+	slotSize = ( slotSize + ( alignment - 1 ) ) & ~( alignment - 1 );
+
+	uint8* slots = (uint8*)AllocOnSubStack_Aligned( allocater, slotSize * capacity, alignment );
+	if( slots == NULL ) {
+		printf( "Couldn't fit a pool of %u slots\n", capacity );
+		return pool;
+	}
+
+	pool.start = slots;
+	pool.end = slots + slotSize * capacity;
+	pool.slotSize = slotSize;
+	pool.capacity = capacity;
+	//Thread the list back to front so slots get handed out in address order
+	pool.freeList = NULL;
+	for( uint32 slotIndex = capacity; slotIndex > 0; --slotIndex ) {
+		void** slot = (void**)( slots + slotSize * ( slotIndex - 1 ) );
+		*slot = pool.freeList;
+		pool.freeList = slot;
+	}
+	return pool;
+}
+
+///Returns a zeroed slot, or NULL if the pool is full
+template< typename T >
+T* AllocFromPool( Pool<T>* pool ) {
+	void** slot = (void**)pool->freeList;
+	if( slot == NULL ) {
+		return NULL;
+	}
+	pool->freeList = *slot;
+	pool->liveCount++;
+	memset( slot, 0, sizeof( T ) );
+	return (T*)slot;
+}
+
+template< typename T >
+void FreeToPool( Pool<T>* pool, T* item ) {
+	if( item == NULL ) return;
+	assert( (uintptr)item >= (uintptr)pool->start && (uintptr)item < (uintptr)pool->end );
+	assert( ( (uintptr)item - (uintptr)pool->start ) % pool->slotSize == 0 );
+	assert( pool->liveCount > 0 );
+
+	void** slot = (void**)item;
+	*slot = pool->freeList;
+	pool->freeList = slot;
+	pool->liveCount--;
+}
+
+/*------------------------------------------------------------------------------------------------------------------
+												General Heap
+    Two level segregated fit (TLSF) heap inside one slab subsection. Free blocks are bucketed by a power of two first
+    level and a linear second level split of that power, each with a bitmap, so finding a fit and freeing (with
+    neighbour coalescing) are both constant time. Everything handed out is 16 byte aligned
+-------------------------------------------------------------------------------------------------------------------*/
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#ifndef ASSET_HEAP_SIZE
+	#define ASSET_HEAP_SIZE MEGABYTES( 40 )
+#endif
+
+#define HEAP_ALIGNMENT 16
+#define HEAP_SL_COUNT_LOG2 4
+#define HEAP_SL_COUNT ( 1 << HEAP_SL_COUNT_LOG2 )
+//Blocks under HEAP_SMALL_BLOCK all sit in first level 0, split into HEAP_SL_COUNT evenly sized lists
+#define HEAP_FL_SHIFT ( HEAP_SL_COUNT_LOG2 + 4 )
+#define HEAP_SMALL_BLOCK ( 1 << HEAP_FL_SHIFT )
+//Largest block is just under 4GB
+#define HEAP_FL_COUNT ( 32 - HEAP_FL_SHIFT + 1 )
+#define HEAP_BLOCK_FREE 1
+
+struct HeapBlockHeader {
+	HeapBlockHeader* prevPhysical;
+	//Payload bytes, always a multiple of HEAP_ALIGNMENT so the low bit is free for HEAP_BLOCK_FREE
+	uint64 sizeAndFlags;
+	//Only valid while the block is free, these live in the first bytes of the payload
+	HeapBlockHeader* nextFree;
+	HeapBlockHeader* prevFree;
+};
+#define HEAP_HEADER_SIZE ( sizeof( HeapBlockHeader* ) + sizeof( uint64 ) )
+//Payload has to be able to hold the two free list links
+#define HEAP_MIN_BLOCK 16
+
+struct SlabHeap {
+	void* start;
+	void* end;
+	//Start of the carved subsection, start above may have been bumped forward for alignment
+	void* regionStart;
+	uint32 flBitmap;
+	uint32 slBitmap[ HEAP_FL_COUNT ];
+	HeapBlockHeader* freeLists[ HEAP_FL_COUNT ][ HEAP_SL_COUNT ];
+	uint64 usedBytes;
+	uint64 peakUsedBytes;
+};
+
+struct SlabHeapStats {
+	uint64 totalBytes;
+	uint64 usedBytes;
+	uint64 peakUsedBytes;
+	uint64 freeBytes;
+	uint64 largestFreeBlock;
+	uint32 usedBlockCount;
+	uint32 freeBlockCount;
+	//0 when all free space is one block, heads towards 1 as it gets chopped into pieces
+	float fragmentation;
+};
+
+static inline uint32 HeapHighestSetBit( uint64 value ) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanReverse64( &index, value );
+	return index;
+#else
+	return 63 - __builtin_clzll( value );
+#endif
+}
+
+static inline uint32 HeapLowestSetBit( uint32 value ) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward( &index, value );
+	return index;
+#else
+	return __builtin_ctz( value );
+#endif
+}
+
+static inline uint64 HeapBlockSize( HeapBlockHeader* block ) {
+	return block->sizeAndFlags & ~(uint64)( HEAP_ALIGNMENT - 1 );
+}
+
+static inline bool HeapBlockIsFree( HeapBlockHeader* block ) {
+	return ( block->sizeAndFlags & HEAP_BLOCK_FREE ) != 0;
+}
+
+static inline void* HeapBlockPayload( HeapBlockHeader* block ) {
+	return (uint8*)block + HEAP_HEADER_SIZE;
+}
+
+static inline HeapBlockHeader* HeapBlockFromPayload( void* ptr ) {
+	return (HeapBlockHeader*)( (uint8*)ptr - HEAP_HEADER_SIZE );
+}
+
+static inline HeapBlockHeader* HeapNextPhysical( HeapBlockHeader* block ) {
+	return (HeapBlockHeader*)( (uint8*)HeapBlockPayload( block ) + HeapBlockSize( block ) );
+}
+
+static void HeapMapping( uint64 size, uint32* fl, uint32* sl ) {
+	if( size < HEAP_SMALL_BLOCK ) {
+		*fl = 0;
+		*sl = (uint32)size / ( HEAP_SMALL_BLOCK / HEAP_SL_COUNT );
+	} else {
+		uint32 highBit = HeapHighestSetBit( size );
+		*sl = (uint32)( size >> ( highBit - HEAP_SL_COUNT_LOG2 ) ) ^ HEAP_SL_COUNT;
+		*fl = highBit - ( HEAP_FL_SHIFT - 1 );
+	}
+}
+
+static void HeapInsertFreeBlock( SlabHeap* heap, HeapBlockHeader* block ) {
+	uint32 fl, sl;
+	HeapMapping( HeapBlockSize( block ), &fl, &sl );
+	HeapBlockHeader* head = heap->freeLists[ fl ][ sl ];
+	block->nextFree = head;
+	block->prevFree = NULL;
+	if( head != NULL ) head->prevFree = block;
+	heap->freeLists[ fl ][ sl ] = block;
+	heap->flBitmap |= 1u << fl;
+	heap->slBitmap[ fl ] |= 1u << sl;
+}
+
+static void HeapRemoveFreeBlock( SlabHeap* heap, HeapBlockHeader* block ) {
+	uint32 fl, sl;
+	HeapMapping( HeapBlockSize( block ), &fl, &sl );
+	if( block->prevFree != NULL ) {
+		block->prevFree->nextFree = block->nextFree;
+	} else {
+		heap->freeLists[ fl ][ sl ] = block->nextFree;
+	}
+	if( block->nextFree != NULL ) block->nextFree->prevFree = block->prevFree;
+
+	if( heap->freeLists[ fl ][ sl ] == NULL ) {
+		heap->slBitmap[ fl ] &= ~( 1u << sl );
+		if( heap->slBitmap[ fl ] == 0 ) heap->flBitmap &= ~( 1u << fl );
+	}
+}
+
+///Rounds the request up to the next list boundary, so any block in the list found is guaranteed to fit
+static HeapBlockHeader* HeapFindFreeBlock( SlabHeap* heap, uint64 size ) {
+	if( size >= HEAP_SMALL_BLOCK ) {
+		size += ( (uint64)1 << ( HeapHighestSetBit( size ) - HEAP_SL_COUNT_LOG2 ) ) - 1;
+	}
+	uint32 fl, sl;
+	HeapMapping( size, &fl, &sl );
+	if( fl >= HEAP_FL_COUNT ) return NULL;
+
+	uint32 slMap = heap->slBitmap[ fl ] & ( ~0u << sl );
+	if( slMap == 0 ) {
+		uint32 flMap = ( fl + 1 < 32 ) ? heap->flBitmap & ( ~0u << ( fl + 1 ) ) : 0;
+		if( flMap == 0 ) return NULL;
+		fl = HeapLowestSetBit( flMap );
+		slMap = heap->slBitmap[ fl ];
+	}
+	sl = HeapLowestSetBit( slMap );
+	return heap->freeLists[ fl ][ sl ];
+}
+
+///Splits anything past size off into a new free block, if there's enough left over to be worth one
+static void HeapTrimBlock( SlabHeap* heap, HeapBlockHeader* block, uint64 size ) {
+	uint64 blockSize = HeapBlockSize( block );
+	if( blockSize < size + HEAP_HEADER_SIZE + HEAP_MIN_BLOCK ) return;
+
+	HeapBlockHeader* remainder = (HeapBlockHeader*)( (uint8*)HeapBlockPayload( block ) + size );
+	remainder->prevPhysical = block;
+	remainder->sizeAndFlags = ( blockSize - size - HEAP_HEADER_SIZE ) | HEAP_BLOCK_FREE;
+	HeapNextPhysical( remainder )->prevPhysical = remainder;
+	block->sizeAndFlags = size | ( block->sizeAndFlags & HEAP_BLOCK_FREE );
+	HeapInsertFreeBlock( heap, remainder );
+}
+
+static inline uint64 HeapAdjustRequest( uint64 size ) {
+	size = ( size + ( HEAP_ALIGNMENT - 1 ) ) & ~(uint64)( HEAP_ALIGNMENT - 1 );
+	return size < HEAP_MIN_BLOCK ? HEAP_MIN_BLOCK : size;
+}
+
+///Heap starts as one free block running up to a zero sized, never free, sentinel block at the end
+SlabHeap CreateSlabHeap( MemorySlab* slab, uint64 bytes ) {
+	SlabHeap heap = { };
+	SlabSubsection_Stack region = CarveNewSubsection( slab, bytes, "Asset Heap" );
+	if( region.start == NULL ) {
+		printf( "Couldn't carve a %llu byte heap from the slab\n", (unsigned long long)bytes );
+		assert( false );
+		return heap;
+	}
+
+	uintptr alignedStart = ( (uintptr)region.start + ( HEAP_ALIGNMENT - 1 ) ) & ~(uintptr)( HEAP_ALIGNMENT - 1 );
+	uintptr alignedEnd = (uintptr)region.end & ~(uintptr)( HEAP_ALIGNMENT - 1 );
+	heap.regionStart = region.start;
+	heap.start = (void*)alignedStart;
+	heap.end = (void*)alignedEnd;
+
+	HeapBlockHeader* first = (HeapBlockHeader*)alignedStart;
+	first->prevPhysical = NULL;
+	first->sizeAndFlags = ( alignedEnd - alignedStart - HEAP_HEADER_SIZE * 2 ) | HEAP_BLOCK_FREE;
+	HeapBlockHeader* sentinel = HeapNextPhysical( first );
+	sentinel->prevPhysical = first;
+	sentinel->sizeAndFlags = 0;
+	HeapInsertFreeBlock( &heap, first );
+	return heap;
+}
+
+///Returns NULL if nothing big enough is free
+void* SlabHeapAlloc( SlabHeap* heap, uint64 size ) {
+	uint64 adjustedSize = HeapAdjustRequest( size );
+	HeapBlockHeader* block = HeapFindFreeBlock( heap, adjustedSize );
+	if( block == NULL ) {
+		printf( "Heap couldn't fit %llu bytes\n", (unsigned long long)size );
+		return NULL;
+	}
+	HeapRemoveFreeBlock( heap, block );
+	HeapTrimBlock( heap, block, adjustedSize );
+	block->sizeAndFlags &= ~(uint64)HEAP_BLOCK_FREE;
+
+	heap->usedBytes += HeapBlockSize( block );
+	if( heap->usedBytes > heap->peakUsedBytes ) {
+		heap->peakUsedBytes = heap->usedBytes;
+		TrackSubsectionUsage( heap->regionStart, heap->peakUsedBytes );
+	}
+	return HeapBlockPayload( block );
+}
+
+void SlabHeapFree( SlabHeap* heap, void* ptr ) {
+	if( ptr == NULL ) return;
+	assert( (uintptr)ptr > (uintptr)heap->start && (uintptr)ptr < (uintptr)heap->end );
+	HeapBlockHeader* block = HeapBlockFromPayload( ptr );
+	assert( !HeapBlockIsFree( block ) );
+	heap->usedBytes -= HeapBlockSize( block );
+	block->sizeAndFlags |= HEAP_BLOCK_FREE;
+
+	//Never two free blocks in a row, so one merge each way is all it takes
+	HeapBlockHeader* prev = block->prevPhysical;
+	if( prev != NULL && HeapBlockIsFree( prev ) ) {
+		HeapRemoveFreeBlock( heap, prev );
+		prev->sizeAndFlags += HEAP_HEADER_SIZE + HeapBlockSize( block );
+		block = prev;
+		HeapNextPhysical( block )->prevPhysical = block;
+	}
+	HeapBlockHeader* next = HeapNextPhysical( block );
+	if( HeapBlockIsFree( next ) ) {
+		HeapRemoveFreeBlock( heap, next );
+		block->sizeAndFlags += HEAP_HEADER_SIZE + HeapBlockSize( next );
+		HeapNextPhysical( block )->prevPhysical = block;
+	}
+	HeapInsertFreeBlock( heap, block );
+}
+
+///Grows in place when the next block is free and big enough, otherwise moves. Shrinking never moves
+void* SlabHeapRealloc( SlabHeap* heap, void* ptr, uint64 size ) {
+	if( ptr == NULL ) return SlabHeapAlloc( heap, size );
+	if( size == 0 ) {
+		SlabHeapFree( heap, ptr );
+		return NULL;
+	}
+
+	HeapBlockHeader* block = HeapBlockFromPayload( ptr );
+	uint64 currentSize = HeapBlockSize( block );
+	uint64 adjustedSize = HeapAdjustRequest( size );
+	if( adjustedSize <= currentSize ) {
+		return ptr;
+	}
+
+	HeapBlockHeader* next = HeapNextPhysical( block );
+	if( HeapBlockIsFree( next ) && currentSize + HEAP_HEADER_SIZE + HeapBlockSize( next ) >= adjustedSize ) {
+		HeapRemoveFreeBlock( heap, next );
+		block->sizeAndFlags += HEAP_HEADER_SIZE + HeapBlockSize( next );
+		HeapNextPhysical( block )->prevPhysical = block;
+		HeapTrimBlock( heap, block, adjustedSize );
+		heap->usedBytes += HeapBlockSize( block ) - currentSize;
+		if( heap->usedBytes > heap->peakUsedBytes ) {
+			heap->peakUsedBytes = heap->usedBytes;
+			TrackSubsectionUsage( heap->regionStart, heap->peakUsedBytes );
+		}
+		return ptr;
+	}
+
+	void* newPtr = SlabHeapAlloc( heap, size );
+	if( newPtr == NULL ) return NULL;
+	memcpy( newPtr, ptr, currentSize );
+	SlabHeapFree( heap, ptr );
+	return newPtr;
+}
+
+///Walks every block, meant for occasional reporting rather than per frame
+SlabHeapStats GetSlabHeapStats( SlabHeap* heap ) {
+	SlabHeapStats stats = { };
+	stats.totalBytes = (uintptr)heap->end - (uintptr)heap->start;
+	stats.usedBytes = heap->usedBytes;
+	stats.peakUsedBytes = heap->peakUsedBytes;
+	for( HeapBlockHeader* block = (HeapBlockHeader*)heap->start; HeapBlockSize( block ) != 0; block = HeapNextPhysical( block ) ) {
+		uint64 blockSize = HeapBlockSize( block );
+		if( HeapBlockIsFree( block ) ) {
+			stats.freeBytes += blockSize;
+			stats.freeBlockCount++;
+			if( blockSize > stats.largestFreeBlock ) stats.largestFreeBlock = blockSize;
+		} else {
+			stats.usedBlockCount++;
+		}
+	}
+	stats.fragmentation = stats.freeBytes > 0 ? 1.0f - (float)stats.largestFreeBlock / (float)stats.freeBytes : 0.0f;
+	return stats;
+}
+
+void PrintSlabHeapStats( SlabHeap* heap ) {
+	SlabHeapStats stats = GetSlabHeapStats( heap );
+	printf( "Heap: %llu / %llu bytes used (peak %llu) in %u blocks\n", (unsigned long long)stats.usedBytes,
+		(unsigned long long)stats.totalBytes, (unsigned long long)stats.peakUsedBytes, stats.usedBlockCount );
+	printf( "Heap: %llu bytes free in %u blocks, largest %llu, fragmentation %.2f\n", (unsigned long long)stats.freeBytes,
+		stats.freeBlockCount, (unsigned long long)stats.largestFreeBlock, stats.fragmentation );
+}
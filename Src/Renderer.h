@@ -10,7 +10,12 @@ struct MeshGeometryData {
 	float* boneWeightData;
 	uint32* boneIndexData;
 	uint32* iData;
+	//Number of indices in iData, the vertex arrays above hold vertexCount entries
 	uint32 dataCount;
+	uint32 vertexCount;
+	//Set when the arrays point into a mapped mesh cache, hand it back with ReleaseMeshCache
+	void* mappedFile;
+	int64 mappedSize;
 };
 
 struct TextureData {
@@ -50,6 +55,20 @@ struct ArmatureKeyFrame {
 	BoneKeyFrame targetBoneTransforms[ MAXBONES ];
 };
 
+enum VertexBufferLayout {
+    VERTEX_BUFFERS_SEPARATE, VERTEX_BUFFERS_INTERLEAVED
+};
+
+///Where each attribute sits inside one vertex of an interleaved buffer. A separate layout is all zeros (tightly packed, own buffer)
+struct InterleavedVertexFormat {
+    uint32 stride;
+    uint32 positionOffset;
+    uint32 normalOffset;
+    uint32 uvOffset;
+    uint32 boneWeightOffset;
+    uint32 boneIndexOffset;
+};
+
 struct MeshGPUBinding {
 	uint32 dataCount;
 	uint32 vertexDataPtr;
@@ -60,45 +79,148 @@ struct MeshGPUBinding {
 	bool hasBoneData;
 	uint32 boneWeightDataPtr;
 	uint32 boneIndexDataPtr;
+
+    //When interleaved, every data ptr above except the index ptr names the same buffer
+    VertexBufferLayout layout;
+    InterleavedVertexFormat format;
 };
 
+///Packs position, normal, uv then (optionally) bone data. Stride is padded up to minStride if that is larger
+InterleavedVertexFormat MakeInterleavedVertexFormat( bool includeBoneData, uint32 minStride = 0 ) {
+    InterleavedVertexFormat format = { };
+    uint32 offset = 0;
+    format.positionOffset = offset; offset += sizeof( Vec3 );
+    format.normalOffset = offset; offset += sizeof( Vec3 );
+    format.uvOffset = offset; offset += sizeof( float ) * 2;
+    if( includeBoneData ) {
+        format.boneWeightOffset = offset; offset += sizeof( float ) * MAXBONESPERVERT;
+        format.boneIndexOffset = offset; offset += sizeof( uint32 ) * MAXBONESPERVERT;
+    }
+    format.stride = ( offset > minStride ) ? offset : minStride;
+    return format;
+}
+
+///Writes vertexCount vertices of format->stride bytes each into out, which must be at least that big
+void InterleaveMeshData( MeshGeometryData* mesh, InterleavedVertexFormat* format, uint8* out ) {
+    bool includeBoneData = format->boneIndexOffset != 0 && mesh->boneWeightData != NULL && mesh->boneIndexData != NULL;
+    for( uint32 vertexIndex = 0; vertexIndex < mesh->vertexCount; ++vertexIndex ) {
+        uint8* vertex = out + vertexIndex * format->stride;
+        memcpy( vertex + format->positionOffset, &mesh->vData[ vertexIndex ], sizeof( Vec3 ) );
+        memcpy( vertex + format->normalOffset, &mesh->normalData[ vertexIndex ], sizeof( Vec3 ) );
+        memcpy( vertex + format->uvOffset, &mesh->uvData[ vertexIndex * 2 ], sizeof( float ) * 2 );
+        if( includeBoneData ) {
+            memcpy( vertex + format->boneWeightOffset, &mesh->boneWeightData[ vertexIndex * MAXBONESPERVERT ], sizeof( float ) * MAXBONESPERVERT );
+            memcpy( vertex + format->boneIndexOffset, &mesh->boneIndexData[ vertexIndex * MAXBONESPERVERT ], sizeof( uint32 ) * MAXBONESPERVERT );
+        }
+    }
+}
+
 #define MAX_SUPPORTED_VERT_INPUTS 16
 #define MAX_SUPPORTED_UNIFORMS 16
 #define MAX_SUPPORTED_TEX_SAMPLERS 4
+#define MAX_SUPPORTED_UNIFORM_BLOCKS 4
+//Must be a power of 2, kept at least twice the total number of names so probe chains stay short
+#define SHADER_NAME_TABLE_SIZE 64
+
+///FNV-1a, constexpr so names written as literals can be hashed at compile time
+constexpr uint32 HashShaderName( const char* str, uint32 hash = 2166136261u ) {
+    return ( *str == 0 ) ? hash : HashShaderName( str + 1, ( hash ^ (uint32)(uint8)*str ) * 16777619u );
+}
+
+///Implicitly built from a string literal, so call sites keep passing "modelMatrix" but only an integer is compared
+struct ShaderName {
+    uint32 hash;
+    const char* str;
+
+    constexpr ShaderName( const char* name ) : hash( HashShaderName( name ) ), str( name ) { }
+};
+
+enum ShaderNameKind {
+    SHADER_NAME_EMPTY = 0, SHADER_NAME_VERTEX_INPUT, SHADER_NAME_UNIFORM, SHADER_NAME_SAMPLER, SHADER_NAME_UNIFORM_BLOCK
+};
+
+struct ShaderNameTableEntry {
+    uint32 hash;
+    uint8 kind;
+    uint8 index;
+};
+
 struct ShaderProgram {
 	uint32 programID;
     char nameBuffer [512];
     char* vertexInputNames[ MAX_SUPPORTED_VERT_INPUTS ];
     char* uniformNames[ MAX_SUPPORTED_UNIFORMS ];
     char* samplerNames[ MAX_SUPPORTED_TEX_SAMPLERS ];
+    char* uniformBlockNames[ MAX_SUPPORTED_UNIFORM_BLOCKS ];
+    ShaderNameTableEntry nameTable[ SHADER_NAME_TABLE_SIZE ];
 
     int32 vertexInputPtrs[ MAX_SUPPORTED_VERT_INPUTS ];
     int32 uniformPtrs[ MAX_SUPPORTED_UNIFORMS ];
     int32 samplerPtrs[ MAX_SUPPORTED_TEX_SAMPLERS ];
+    uint32 uniformBlockIndices[ MAX_SUPPORTED_UNIFORM_BLOCKS ];
+    int32 uniformBlockSizes[ MAX_SUPPORTED_UNIFORM_BLOCKS ];
+    uint32 uniformBlockBindings[ MAX_SUPPORTED_UNIFORM_BLOCKS ];
 
     int32 vertexInputTypes[ MAX_SUPPORTED_VERT_INPUTS ];
     int32 uniformTypes[ MAX_SUPPORTED_UNIFORMS ];
-    uint8 vertInputCount, uniformCount, samplerCount;
+    uint8 vertInputCount, uniformCount, samplerCount, uniformBlockCount;
 };
 
-int32 GetShaderProgramInputPtr( ShaderProgram* shader, char* inputName ) {
-    for( int i = 0; i < shader->vertInputCount; ++i ) {
-        if( strcmp( shader->vertexInputNames[i] , inputName ) == 0 ) {
-            return shader->vertexInputPtrs[i];
-        }
-    }
+void ClearShaderNameTable( ShaderProgram* program ) {
+    memset( &program->nameTable[0], 0, sizeof( ShaderNameTableEntry ) * SHADER_NAME_TABLE_SIZE );
+}
 
-    for( int i = 0; i < shader->uniformCount; ++i ) {
-        if( strcmp( shader->uniformNames[i] , inputName ) == 0 ) {
-            return shader->uniformPtrs[i];
+///Linear probing, names in a single program are unique across kinds so the hash alone is the key
+void InsertShaderName( ShaderProgram* program, const char* name, ShaderNameKind kind, uint8 index ) {
+    uint32 hash = HashShaderName( name );
+    uint32 slot = hash & ( SHADER_NAME_TABLE_SIZE - 1 );
+    for( uint32 probeCount = 0; probeCount < SHADER_NAME_TABLE_SIZE; ++probeCount ) {
+        ShaderNameTableEntry* entry = &program->nameTable[ slot ];
+        if( entry->kind == SHADER_NAME_EMPTY ) {
+            entry->hash = hash;
+            entry->kind = kind;
+            entry->index = index;
+            return;
         }
+        if( entry->hash == hash ) {
+            printf( "Shader name hash collision on: %s\n", name );
+            assert( false );
+            return;
+        }
+        slot = ( slot + 1 ) & ( SHADER_NAME_TABLE_SIZE - 1 );
     }
 
-    for( int i = 0; i < shader->samplerCount; ++i ) {
-        if( strcmp( shader->samplerNames[i] , inputName ) == 0 ) {
-            return shader->samplerPtrs[i];
+    printf( "Shader name table is full, could not insert: %s\n", name );
+    assert( false );
+}
+
+///Returns -1 if no name of the given kind hashes to the given value
+int32 FindShaderName( ShaderProgram* program, uint32 hash, ShaderNameKind kind ) {
+    uint32 slot = hash & ( SHADER_NAME_TABLE_SIZE - 1 );
+    for( uint32 probeCount = 0; probeCount < SHADER_NAME_TABLE_SIZE; ++probeCount ) {
+        ShaderNameTableEntry* entry = &program->nameTable[ slot ];
+        if( entry->kind == SHADER_NAME_EMPTY ) {
+            return -1;
         }
+        if( entry->hash == hash ) {
+            return ( entry->kind == kind ) ? entry->index : -1;
+        }
+        slot = ( slot + 1 ) & ( SHADER_NAME_TABLE_SIZE - 1 );
     }
+    return -1;
+}
+
+int32 GetShaderProgramInputPtr( ShaderProgram* shader, ShaderName inputName ) {
+    int32 index = FindShaderName( shader, inputName.hash, SHADER_NAME_VERTEX_INPUT );
+    if( index >= 0 ) return shader->vertexInputPtrs[ index ];
+
+    index = FindShaderName( shader, inputName.hash, SHADER_NAME_UNIFORM );
+    if( index >= 0 ) return shader->uniformPtrs[ index ];
+
+    index = FindShaderName( shader, inputName.hash, SHADER_NAME_SAMPLER );
+    if( index >= 0 ) return shader->samplerPtrs[ index ];
+
+    return -1;
 }
 
 struct ShaderProgramParams {
@@ -108,6 +230,15 @@ struct ShaderProgramParams {
     uint32 indiciesToDraw;
 
     uint32 vertexInputData [ MAX_SUPPORTED_VERT_INPUTS ];
+    //Stride of 0 means the buffer is tightly packed with only this input
+    uint32 vertexInputStrides[ MAX_SUPPORTED_VERT_INPUTS ];
+    uint32 vertexInputOffsets[ MAX_SUPPORTED_VERT_INPUTS ];
+    //0 advances per vertex, 1 advances once per instance
+    uint8 vertexInputDivisors[ MAX_SUPPORTED_VERT_INPUTS ];
+    //Vertex array built from the inputs above on first draw, rebuilt after any of them change
+    uint32 vertexArrayPtr;
+    uint32 vertexArrayIndexPtr;
+    bool vertexArrayDirty;
     void* uniformData[ MAX_SUPPORTED_UNIFORMS ];
     TextureBindingID samplerData[ MAX_SUPPORTED_TEX_SAMPLERS ];
 };
@@ -118,42 +249,204 @@ ShaderProgramParams CreateShaderParamSet( ShaderProgram* baseProgram ) {
     returnParams.indexDataPtr = 0;
     returnParams.indiciesToDraw = 0;
     memset( &returnParams.vertexInputData[0], 0, sizeof( uint32 ) * MAX_SUPPORTED_VERT_INPUTS );
+    memset( &returnParams.vertexInputStrides[0], 0, sizeof( uint32 ) * MAX_SUPPORTED_VERT_INPUTS );
+    memset( &returnParams.vertexInputOffsets[0], 0, sizeof( uint32 ) * MAX_SUPPORTED_VERT_INPUTS );
+    memset( &returnParams.vertexInputDivisors[0], 0, sizeof( uint8 ) * MAX_SUPPORTED_VERT_INPUTS );
+    returnParams.vertexArrayPtr = 0;
+    returnParams.vertexArrayIndexPtr = 0;
+    returnParams.vertexArrayDirty = true;
     memset( &returnParams.uniformData[0], 0, sizeof( void* ) * MAX_SUPPORTED_UNIFORMS );
     memset( &returnParams.samplerData[0], 0, sizeof( TextureBindingID ) * MAX_SUPPORTED_TEX_SAMPLERS );
     return returnParams;
 }
 
-void SetUniform( ShaderProgramParams* params, const char* uniformName, void* newData ) {
-    for( int uniformNamesIndex = 0; uniformNamesIndex < params->baseProgram->uniformCount; ++uniformNamesIndex ) {
-        if( strcmp( params->baseProgram->uniformNames[ uniformNamesIndex ], uniformName ) == 0 ) {
-            params->uniformData[ uniformNamesIndex ] = newData;
-            return;
-        }
+///Resolved once at setup so per-draw uniform/sampler updates don't have to search by name
+struct UniformHandle {
+    int32 index;
+};
+
+struct SamplerHandle {
+    int32 index;
+};
+
+UniformHandle GetUniformHandle( ShaderProgram* program, ShaderName uniformName ) {
+    UniformHandle handle = { FindShaderName( program, uniformName.hash, SHADER_NAME_UNIFORM ) };
+    if( handle.index < 0 ) {
+        printf( "Cannot find uniform named: %s\n", uniformName.str );
     }
+    return handle;
+}
 
-    printf( "Cannot set uniform named: %s because it couldn't be found\n", uniformName );
+SamplerHandle GetSamplerHandle( ShaderProgram* program, ShaderName samplerName ) {
+    SamplerHandle handle = { FindShaderName( program, samplerName.hash, SHADER_NAME_SAMPLER ) };
+    if( handle.index < 0 ) {
+        printf( "Cannot find sampler named: %s\n", samplerName.str );
+    }
+    return handle;
 }
 
-void SetSampler( ShaderProgramParams* params, const char* targetSamplerName, TextureBindingID texBinding ) {
-    for( int samplerIndex = 0; samplerIndex < params->baseProgram->samplerCount; ++samplerIndex ) {
-        if( strcmp( params->baseProgram->samplerNames[ samplerIndex ], targetSamplerName ) == 0 ) {
-            params->samplerData[ samplerIndex ] = texBinding;
-            return;
-        }
+///Handles that failed to resolve are ignored, the lookup already reported them
+void SetUniformByHandle( ShaderProgramParams* params, UniformHandle handle, void* newData ) {
+    if( handle.index < 0 ) return;
+    params->uniformData[ handle.index ] = newData;
+}
+
+void SetSamplerByHandle( ShaderProgramParams* params, SamplerHandle handle, TextureBindingID texBinding ) {
+    if( handle.index < 0 ) return;
+    params->samplerData[ handle.index ] = texBinding;
+}
+
+///Name based setters, meant for setup code. Per-draw code should resolve a handle once and use the ByHandle versions
+void SetUniform( ShaderProgramParams* params, ShaderName uniformName, void* newData ) {
+    SetUniformByHandle( params, GetUniformHandle( params->baseProgram, uniformName ), newData );
+}
+
+void SetSampler( ShaderProgramParams* params, ShaderName targetSamplerName, TextureBindingID texBinding ) {
+    SetSamplerByHandle( params, GetSamplerHandle( params->baseProgram, targetSamplerName ), texBinding );
+}
+
+///Stride and offset are in bytes, leave them 0 for a buffer holding only this input
+void SetVertexInput( ShaderProgramParams* params, ShaderName targetInputName, uint32 gpuDataPtr, uint32 stride = 0, uint32 byteOffset = 0 ) {
+    int32 vertexInputIndex = FindShaderName( params->baseProgram, targetInputName.hash, SHADER_NAME_VERTEX_INPUT );
+    if( vertexInputIndex < 0 ) {
+        printf( "Cannot set vertex input named: %s because it couldn't be found\n", targetInputName.str );
+        return;
     }
+    params->vertexInputData[ vertexInputIndex ] = gpuDataPtr;
+    params->vertexInputStrides[ vertexInputIndex ] = stride;
+    params->vertexInputOffsets[ vertexInputIndex ] = byteOffset;
+    params->vertexInputDivisors[ vertexInputIndex ] = 0;
+    params->vertexArrayDirty = true;
+}
+
+///GPU side storage for per-instance attributes, every instance's data is packed together with a stride of instanceSize
+struct InstanceBuffer {
+    uint32 bufferPtr;
+    uint32 instanceSize;
+    uint32 maxInstances;
+};
+
+///GPU side storage for a uniform block. Stays attached to bindingPoint, programs are pointed at the binding point once
+struct UniformBuffer {
+    uint32 bufferPtr;
+    uint32 size;
+    uint32 bindingPoint;
+};
 
-    printf( "Cannot set sampler named: %s because it couldn't be found\n", targetSamplerName );
+///Points a vertex input at a field of an instance buffer, byteOffset is the field's offset inside one instance's data
+void SetInstanceInput( ShaderProgramParams* params, ShaderName targetInputName, InstanceBuffer* instanceBuffer, uint32 byteOffset ) {
+    int32 vertexInputIndex = FindShaderName( params->baseProgram, targetInputName.hash, SHADER_NAME_VERTEX_INPUT );
+    if( vertexInputIndex < 0 ) {
+        printf( "Cannot set instance input named: %s because it couldn't be found\n", targetInputName.str );
+        return;
+    }
+    params->vertexInputData[ vertexInputIndex ] = instanceBuffer->bufferPtr;
+    params->vertexInputStrides[ vertexInputIndex ] = instanceBuffer->instanceSize;
+    params->vertexInputOffsets[ vertexInputIndex ] = byteOffset;
+    params->vertexInputDivisors[ vertexInputIndex ] = 1;
+    params->vertexArrayDirty = true;
 }
 
-void SetVertexInput( ShaderProgramParams* params, const char* targetInputName, uint32 gpuDataPtr ) {
-    for( int vertexInputIndex = 0; vertexInputIndex < params->baseProgram->vertInputCount; ++vertexInputIndex ) {
-        if( strcmp( params->baseProgram->vertexInputNames[ vertexInputIndex ], targetInputName ) == 0 ) {
-            params->vertexInputData[ vertexInputIndex ] = gpuDataPtr;
-            return;
+///Counts of state binds actually sent to the driver vs. skipped because the state was already current
+struct RenderStats {
+    uint32 drawCalls;
+    uint32 programBindsIssued, programBindsSkipped;
+    uint32 vertexBindsIssued, vertexBindsSkipped;
+    uint32 textureBindsIssued, textureBindsSkipped;
+};
+
+///One deferred draw. params is referenced, not copied, so it has to stay alive until the list is submitted
+struct RenderCommand {
+    uint64 sortKey;
+    ShaderProgram* program;
+    ShaderProgramParams* params;
+    //0 means a regular, non instanced draw
+    uint32 instanceCount;
+};
+
+struct RenderCommandList {
+    RenderCommand* commands;
+    RenderCommand* sortScratch;
+    uint32 commandCount;
+    uint32 maxCommands;
+    RenderStats stats;
+};
+
+RenderCommandList CreateRenderCommandList( SlabSubsection_Stack* allocater, uint32 maxCommands ) {
+    RenderCommandList list;
+    list.commands = (RenderCommand*)AllocOnSubStack_Aligned( allocater, sizeof( RenderCommand ) * maxCommands, 8 );
+    list.sortScratch = (RenderCommand*)AllocOnSubStack_Aligned( allocater, sizeof( RenderCommand ) * maxCommands, 8 );
+    list.commandCount = 0;
+    list.maxCommands = maxCommands;
+    memset( &list.stats, 0, sizeof( RenderStats ) );
+    return list;
+}
+
+///Most expensive state change in the highest bits: program, then texture, then mesh, then depth (0 is nearest)
+uint64 MakeRenderSortKey( ShaderProgram* program, ShaderProgramParams* params, float depth ) {
+    if( depth < 0.0f ) depth = 0.0f;
+    if( depth > 1.0f ) depth = 1.0f;
+    uint64 programBits = program->programID & 0xFFFF;
+    uint64 textureBits = params->samplerData[0] & 0xFFFF;
+    uint64 meshBits = params->indexDataPtr & 0xFFFF;
+    uint64 depthBits = (uint64)( depth * 65535.0f );
+    return ( programBits << 48 ) | ( textureBits << 32 ) | ( meshBits << 16 ) | depthBits;
+}
+
+void PushRenderCommand( RenderCommandList* list, ShaderProgram* program, ShaderProgramParams* params, uint32 instanceCount = 0, float depth = 0.0f ) {
+    if( list->commandCount >= list->maxCommands ) {
+        printf( "Render command list is full, dropping draw\n" );
+        assert( false );
+        return;
+    }
+    RenderCommand* command = &list->commands[ list->commandCount++ ];
+    command->sortKey = MakeRenderSortKey( program, params, depth );
+    command->program = program;
+    command->params = params;
+    command->instanceCount = instanceCount;
+}
+
+void PrintRenderStats( RenderStats* stats ) {
+    printf( "Draws: %u\n", stats->drawCalls );
+    printf( "Program binds issued: %u skipped: %u\n", stats->programBindsIssued, stats->programBindsSkipped );
+    printf( "Vertex array binds issued: %u skipped: %u\n", stats->vertexBindsIssued, stats->vertexBindsSkipped );
+    printf( "Texture binds issued: %u skipped: %u\n", stats->textureBindsIssued, stats->textureBindsSkipped );
+}
+
+///LSD radix sort on the 64 bit key, a byte per pass. Passes where every key has the same byte are skipped
+void SortRenderCommands( RenderCommandList* list ) {
+    RenderCommand* src = list->commands;
+    RenderCommand* dst = list->sortScratch;
+    uint32 count = list->commandCount;
+
+    for( uint32 shift = 0; shift < 64; shift += 8 ) {
+        uint32 bucketOffsets[256];
+        memset( &bucketOffsets[0], 0, sizeof( uint32 ) * 256 );
+        for( uint32 i = 0; i < count; ++i ) {
+            bucketOffsets[ ( src[i].sortKey >> shift ) & 0xFF ]++;
         }
+        if( count == 0 || bucketOffsets[ ( src[0].sortKey >> shift ) & 0xFF ] == count ) {
+            continue;
+        }
+
+        uint32 total = 0;
+        for( uint32 bucket = 0; bucket < 256; ++bucket ) {
+            uint32 bucketCount = bucketOffsets[ bucket ];
+            bucketOffsets[ bucket ] = total;
+            total += bucketCount;
+        }
+        for( uint32 i = 0; i < count; ++i ) {
+            dst[ bucketOffsets[ ( src[i].sortKey >> shift ) & 0xFF ]++ ] = src[i];
+        }
+
+        RenderCommand* swap = src;
+        src = dst;
+        dst = swap;
     }
 
-    printf( "Cannot set vertex input named: %s because it couldn't be found\n", targetInputName );
+    if( src != list->commands ) {
+        memcpy( list->commands, src, sizeof( RenderCommand ) * count );
+    }
 }
 
 struct Framebuffer {
@@ -174,6 +467,7 @@ struct RendererStorage{
 	uint32 quadVDataPtr;
 	uint32 quadUVDataPtr;
 	uint32 quadIDataPtr;
+	uint32 quadVertexArrayPtr;
     int32 quadPosAttribPtr;
     int32 quadUVAttribPtr;
     int32 quadMat4UniformPtr;
@@ -192,7 +486,7 @@ struct RendererStorage{
 -----------------------------------------------------------------------------------------------------------------*/
 
 void CreateEmptyTexture( TextureData* texData, uint16 width, uint16 height ) {
-	texData->data = ( uint8* )malloc( sizeof( uint8 ) * 4 * width * height );
+	texData->data = ( uint8* )AllocAssetMemory( sizeof( uint8 ) * 4 * width * height );
     texData->width = width;
     texData->height = height;
     texData->channelsPerPixel = 4;
@@ -216,20 +510,20 @@ void SetRendererCameraTransform( RendererStorage* rStorage, Vec3 position, Vec3
 }
 
 void ApplyKeyFrameToArmature( ArmatureKeyFrame* pose, Armature* armature ) {
-    for( uint8 boneIndex = 0; boneIndex < armature->boneCount; ++boneIndex ) {
-        Bone* bone = &armature->bones[ boneIndex ];
-        *bone->currentTransform = MultMatrix( bone->invBindPose, pose->targetBoneTransforms[ boneIndex ].combinedMatrix );
-    }
+    //Each bone's currentTransform points at boneTransforms[ boneIndex ], so the whole pose goes in one pass
+    MultMatrixArrays( &armature->bones[0].invBindPose, &pose->targetBoneTransforms[0].combinedMatrix, &armature->boneTransforms[0],
+                      armature->boneCount, sizeof( Bone ), sizeof( BoneKeyFrame ), sizeof( Mat4 ) );
 }
 
-ArmatureKeyFrame BlendKeyFrames( ArmatureKeyFrame* keyframeA, ArmatureKeyFrame* keyframeB, float weight, uint8 boneCount ) {
+///Result lives in the frame arena, good until the arena comes back around to this frame's buffer
+ArmatureKeyFrame* BlendKeyFrames( ArmatureKeyFrame* keyframeA, ArmatureKeyFrame* keyframeB, float weight, uint8 boneCount, FrameArena* frameArena ) {
     float keyAWeight, keyBWeight;
-    ArmatureKeyFrame out;
+    ArmatureKeyFrame* out = PushStruct<ArmatureKeyFrame>( frameArena );
     keyAWeight = weight;
     keyBWeight = 1.0f - keyAWeight;
 
     for( uint8 boneIndex = 0; boneIndex < boneCount; ++boneIndex ) {
-        BoneKeyFrame* netBoneKey = &out.targetBoneTransforms[ boneIndex ];
+        BoneKeyFrame* netBoneKey = &out->targetBoneTransforms[ boneIndex ];
         BoneKeyFrame* bonekeyA = &keyframeA->targetBoneTransforms[ boneIndex ];
         BoneKeyFrame* bonekeyB = &keyframeB->targetBoneTransforms[ boneIndex ];
 
@@ -262,17 +556,39 @@ ArmatureKeyFrame BlendKeyFrames( ArmatureKeyFrame* keyframeA, ArmatureKeyFrame*
 ------------------------------------------------------------------------------------------------------------------*/
 
 void CreateTextureBinding( TextureData* textureData, TextureBindingID* texBindID );
-void CreateShaderProgram( const char* vertProgramFilePath, const char* fragProgramFilePath, SlabSubsection_Stack* allocater, ShaderProgram* bindData );
-void CreateRenderBinding( MeshGeometryData* geometryStorage, MeshGPUBinding* bindData );
+void CreateShaderProgram( const char* vertProgramFilePath, const char* fragProgramFilePath, ShaderProgram* bindData );
+///Same as CreateShaderProgram with the sources already in memory, the paths are only used in messages
+void CreateShaderProgramFromSource( const char* vertProgramFilePath, const char* vertSrc, const char* fragProgramFilePath, const char* fragSrc, ShaderProgram* bindData );
+void CreateRenderBinding( MeshGeometryData* geometryStorage, MeshGPUBinding* bindData, VertexBufferLayout layout = VERTEX_BUFFERS_SEPARATE );
+///Frees the GPU buffers behind the binding, the struct itself is left for the caller to reuse or give back to its pool
+void DestroyRenderBinding( MeshGPUBinding* bindData );
+///Frees any GPU side objects the param set built up while drawing
+void DestroyShaderParamSet( ShaderProgramParams* params );
 
 RendererStorage* InitRenderer( uint16 screen_w, uint16 screen_h, SlabSubsection_Stack* systemsMemory );
-
-void RenderBoundData( ShaderProgram* program, ShaderProgramParams params );
+Framebuffer CreateFramebuffer( uint32 pixelWidth, uint32 pixelHeight, Framebuffer::FramebufferType type );
+///NULL goes back to drawing on the screen
+void SetCurrentFramebuffer( Framebuffer* framebuffer );
+///Clears color and depth of whatever framebuffer is current
+void ClearCurrentFramebuffer();
+
+void RenderBoundData( ShaderProgram* program, ShaderProgramParams* params );
+///Draws the bound mesh instanceCount times in a single call, inputs set with SetInstanceInput advance once per instance
+void RenderBoundDataInstanced( ShaderProgram* program, ShaderProgramParams* params, uint32 instanceCount );
+InstanceBuffer CreateInstanceBuffer( uint32 instanceSize, uint32 maxInstances );
+void UpdateInstanceBuffer( InstanceBuffer* instanceBuffer, void* instanceData, uint32 instanceCount );
+UniformBuffer CreateUniformBuffer( uint32 size, uint32 bindingPoint );
+///Meant to be called at most once per frame per buffer, every program reading the block sees the new data
+void UpdateUniformBuffer( UniformBuffer* uniformBuffer, void* data, uint32 size );
+///Setup time, connects a program's uniform block to the buffer's binding point
+void SetUniformBlock( ShaderProgram* program, ShaderName blockName, UniformBuffer* uniformBuffer );
+///Sorts the list, draws every command while skipping redundant binds, then empties the list. Stats accumulate until cleared
+void SubmitRenderCommands( RenderCommandList* list );
 void RenderTexturedQuad( RendererStorage* rendererStorage, TextureBindingID texture, float width, float height, float x, float y );
 
 void RenderDebugCircle( Vec3 position, float radius = 1.0f , Vec3 color = { 1.0f, 1.0f, 1.0f} );
-void RenderDebugLines( float* vertexData, uint8 vertexCount, Mat4 transform, Vec3 color = { 1.0f, 1.0f, 1.0f } );
-void RenderArmatureAsLines(  Armature* armature, Mat4 transform, Vec3 color = { 1.0f, 1.0f, 1.0f } );
+void RenderDebugLines( float* vertexData, uint8 vertexCount, const Mat4& transform, Vec3 color = { 1.0f, 1.0f, 1.0f } );
+void RenderArmatureAsLines(  Armature* armature, const Mat4& transform, Vec3 color = { 1.0f, 1.0f, 1.0f } );
 
 //TODO: figure out if this is useful or not
 //Hypothetical ease-of-use idea, you always want renderbinding but only sometimes care to store the mesh data anywhere other
@@ -285,7 +601,16 @@ void RenderArmatureAsLines(  Armature* armature, Mat4 transform, Vec3 color = {
 
 ///Return 0 on success, required buffer length if buffer is too small, or -1 on other OS failure
 char* ReadShaderSrcFileFromDisk( const char* fileName );
-void LoadMeshDataFromDisk( const char* fileName, SlabSubsection_Stack* allocater, MeshGeometryData* storage, Armature* armature = NULL );
+///Streams the COLLADA file once, geometry goes into allocater. False, with an empty mesh, if the file or its geometry is missing
+bool LoadMeshDataFromDisk( const char* fileName, SlabSubsection_Stack* allocater, MeshGeometryData* storage, Armature* armature = NULL );
+///Maps fileName's binary cache if it is current, otherwise parses the COLLADA into allocater and writes the cache for next time
+void LoadMeshData( const char* fileName, SlabSubsection_Stack* allocater, MeshGeometryData* storage, Armature* armature = NULL );
+bool WriteMeshCache( const char* cacheFileName, int64 sourceModifiedTime, const MeshGeometryData* mesh, const Armature* armature );
+///False if the cache is missing, stale, or was cooked without the armature when one is asked for. storage points into the mapping on success
+bool LoadMeshCache( const char* cacheFileName, int64 sourceModifiedTime, MeshGeometryData* storage, Armature* armature );
+void ReleaseMeshCache( MeshGeometryData* storage );
+///Offline cooking, always parses and rewrites fileName's cache. The parsed mesh is left in allocater
+bool CookMeshCache( const char* fileName, SlabSubsection_Stack* allocater );
 void LoadAnimationDataFromCollada( const char* fileName, ArmatureKeyFrame* pose, Armature* armature );
 void LoadTextureDataFromDisk( const char* fileName, TextureData* texDataStorage );
 
@@ -320,6 +645,10 @@ void SetCurrentFramebuffer( Framebuffer* framebuffer ) {
     }
 }
 
+void ClearCurrentFramebuffer() {
+    glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+}
+
 void CreateTextureBinding( TextureData* texData, TextureBindingID* texBindID ) {
 	GLenum pixelFormat;
     if( texData->channelsPerPixel == 3 ) {
@@ -368,14 +697,11 @@ void PrintGLShaderLog( GLuint shader ) {
     }
 }
 
-void CreateShaderProgram( char* vertProgramFilePath, char* fragProgramFilePath, ShaderProgram* bindDataStorage ) {
+void CreateShaderProgramFromSource( const char* vertProgramFilePath, const char* vertSrc, const char* fragProgramFilePath, const char* fragSrc, ShaderProgram* bindDataStorage ) {
     bindDataStorage->programID = glCreateProgram();
 
     GLuint vertexShader = glCreateShader( GL_VERTEX_SHADER );
-
-    int64 bytesRead = 0;
-    char* srcDataPtr = ReadShaderSrcFileFromDisk( vertProgramFilePath );
-    glShaderSource( vertexShader, 1, &srcDataPtr, NULL );
+    glShaderSource( vertexShader, 1, &vertSrc, NULL );
 
     glCompileShader( vertexShader );
     GLint compiled = GL_FALSE;
@@ -387,12 +713,9 @@ void CreateShaderProgram( char* vertProgramFilePath, char* fragProgramFilePath,
         printf( "Vertex Shader %s compiled\n", vertProgramFilePath );
         glAttachShader( bindDataStorage->programID, vertexShader );
     }
-    free( srcDataPtr );
 
     GLuint fragShader = glCreateShader( GL_FRAGMENT_SHADER );
-    bytesRead = 0;
-    srcDataPtr = ReadShaderSrcFileFromDisk( fragProgramFilePath );
-    glShaderSource( fragShader, 1, &srcDataPtr, NULL );
+    glShaderSource( fragShader, 1, &fragSrc, NULL );
 
     glCompileShader( fragShader );
     //Check for errors
@@ -406,7 +729,6 @@ void CreateShaderProgram( char* vertProgramFilePath, char* fragProgramFilePath,
         //Actually attach it if it compiled
         glAttachShader( bindDataStorage->programID, fragShader );
     }
-    free( srcDataPtr );
 
     glLinkProgram( bindDataStorage->programID );
     //Check for errors
@@ -425,6 +747,8 @@ void CreateShaderProgram( char* vertProgramFilePath, char* fragProgramFilePath,
     GLint attribSize;
     GLenum attribType;
 
+    ClearShaderNameTable( bindDataStorage );
+
     //Record All vertex inputs
     bindDataStorage->vertInputCount = 0;
     GLint activeGLAttributeCount;
@@ -435,26 +759,56 @@ void CreateShaderProgram( char* vertProgramFilePath, char* fragProgramFilePath,
         bindDataStorage->vertexInputPtrs[ attributeIndex ] = glGetAttribLocation( bindDataStorage->programID, nameWriteTarget );
         bindDataStorage->vertexInputNames[ attributeIndex ] = nameWriteTarget;
         bindDataStorage->vertexInputTypes[ attributeIndex ] = attribType;
+        InsertShaderName( bindDataStorage, nameWriteTarget, SHADER_NAME_VERTEX_INPUT, attributeIndex );
         nameWriteTargetOffset += nameLen + 1;
         bindDataStorage->vertInputCount++;
     }
 
+    //Record all uniform block info
+    bindDataStorage->uniformBlockCount = 0;
+    GLint activeGLUniformBlockCount;
+    glGetProgramiv( bindDataStorage->programID, GL_ACTIVE_UNIFORM_BLOCKS, &activeGLUniformBlockCount );
+    if( activeGLUniformBlockCount > MAX_SUPPORTED_UNIFORM_BLOCKS ) {
+        printf( "Shader %s has %d uniform blocks, only the first %d are recorded\n", vertProgramFilePath, activeGLUniformBlockCount, MAX_SUPPORTED_UNIFORM_BLOCKS );
+        assert( false );
+        activeGLUniformBlockCount = MAX_SUPPORTED_UNIFORM_BLOCKS;
+    }
+    for( GLuint blockIndex = 0; blockIndex < activeGLUniformBlockCount; ++blockIndex ) {
+        char* nameWriteTarget = &bindDataStorage->nameBuffer[ nameWriteTargetOffset ];
+        glGetActiveUniformBlockName( bindDataStorage->programID, blockIndex, 512 - nameWriteTargetOffset, &nameLen, nameWriteTarget );
+        bindDataStorage->uniformBlockIndices[ blockIndex ] = blockIndex;
+        glGetActiveUniformBlockiv( bindDataStorage->programID, blockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &bindDataStorage->uniformBlockSizes[ blockIndex ] );
+        bindDataStorage->uniformBlockNames[ blockIndex ] = nameWriteTarget;
+        InsertShaderName( bindDataStorage, nameWriteTarget, SHADER_NAME_UNIFORM_BLOCK, blockIndex );
+        nameWriteTargetOffset += nameLen + 1;
+        bindDataStorage->uniformBlockCount++;
+    }
+
     //Record all uniform info
     bindDataStorage->uniformCount = 0;
     bindDataStorage->samplerCount = 0;
     GLint activeGLUniformCount;
     glGetProgramiv( bindDataStorage->programID, GL_ACTIVE_UNIFORMS, &activeGLUniformCount );
     for( GLuint uniformIndex = 0; uniformIndex < activeGLUniformCount; ++uniformIndex ) {
+        //Members of uniform blocks are fed by their buffer, not by glUniform*
+        GLint owningBlockIndex;
+        glGetActiveUniformsiv( bindDataStorage->programID, 1, &uniformIndex, GL_UNIFORM_BLOCK_INDEX, &owningBlockIndex );
+        if( owningBlockIndex != -1 ) {
+            continue;
+        }
+
         char* nameWriteTarget = &bindDataStorage->nameBuffer[ nameWriteTargetOffset ];
         glGetActiveUniform( bindDataStorage->programID, uniformIndex, 512 - nameWriteTargetOffset, &nameLen, &attribSize, &attribType, nameWriteTarget );
         if( attribType == GL_SAMPLER_2D ) {
             bindDataStorage->samplerPtrs[ bindDataStorage->samplerCount ] = glGetUniformLocation( bindDataStorage->programID, nameWriteTarget );
             glUniform1i( bindDataStorage->samplerPtrs[ bindDataStorage->samplerCount ], bindDataStorage->samplerCount );
+            InsertShaderName( bindDataStorage, nameWriteTarget, SHADER_NAME_SAMPLER, bindDataStorage->samplerCount );
             bindDataStorage->samplerNames[ bindDataStorage->samplerCount++ ] = nameWriteTarget;
         } else {
-            bindDataStorage->uniformPtrs[ uniformIndex - bindDataStorage->samplerCount ] = glGetUniformLocation( bindDataStorage->programID, nameWriteTarget );
-            bindDataStorage->uniformNames[ uniformIndex - bindDataStorage->samplerCount ] = nameWriteTarget;
-            bindDataStorage->uniformTypes[ uniformIndex - bindDataStorage->samplerCount ] = attribType;
+            bindDataStorage->uniformPtrs[ bindDataStorage->uniformCount ] = glGetUniformLocation( bindDataStorage->programID, nameWriteTarget );
+            bindDataStorage->uniformNames[ bindDataStorage->uniformCount ] = nameWriteTarget;
+            bindDataStorage->uniformTypes[ bindDataStorage->uniformCount ] = attribType;
+            InsertShaderName( bindDataStorage, nameWriteTarget, SHADER_NAME_UNIFORM, bindDataStorage->uniformCount );
             ++bindDataStorage->uniformCount;
         }
         nameWriteTargetOffset += nameLen + 1;       
@@ -465,23 +819,76 @@ void CreateShaderProgram( char* vertProgramFilePath, char* fragProgramFilePath,
     glDeleteShader( fragShader );
 }
 
-void CreateRenderBinding( MeshGeometryData* meshDataStorage, MeshGPUBinding* bindDataStorage ) {
+void CreateShaderProgram( const char* vertProgramFilePath, const char* fragProgramFilePath, ShaderProgram* bindDataStorage ) {
+    char* vertSrc = ReadShaderSrcFileFromDisk( vertProgramFilePath );
+    char* fragSrc = ReadShaderSrcFileFromDisk( fragProgramFilePath );
+    CreateShaderProgramFromSource( vertProgramFilePath, vertSrc, fragProgramFilePath, fragSrc, bindDataStorage );
+    FreeAssetMemory( vertSrc );
+    FreeAssetMemory( fragSrc );
+}
+
+static void CreateInterleavedRenderBinding( MeshGeometryData* meshDataStorage, MeshGPUBinding* bindDataStorage ) {
+    bool includeBoneData = meshDataStorage->boneWeightData != NULL && meshDataStorage->boneIndexData != NULL;
+    InterleavedVertexFormat format = MakeInterleavedVertexFormat( includeBoneData );
+
+    size_t interleavedSize = meshDataStorage->vertexCount * format.stride;
+    uint8* interleavedData = (uint8*)AllocAssetMemory( interleavedSize );
+    if( interleavedData == NULL ) {
+        printf( "Not enough asset memory to interleave %llu bytes of vertex data, skipping the binding\n", (unsigned long long)interleavedSize );
+        memset( bindDataStorage, 0, sizeof( MeshGPUBinding ) );
+        return;
+    }
+    memset( interleavedData, 0, interleavedSize );
+    InterleaveMeshData( meshDataStorage, &format, interleavedData );
+
+    GLuint glVBOPtr;
+    glGenBuffers( 1, &glVBOPtr );
+    glBindBuffer( GL_ARRAY_BUFFER, glVBOPtr );
+    glBufferData( GL_ARRAY_BUFFER, interleavedSize, interleavedData, GL_STATIC_DRAW );
+    FreeAssetMemory( interleavedData );
+
+    bindDataStorage->vertexDataPtr = glVBOPtr;
+    bindDataStorage->nrmlDataPtr = glVBOPtr;
+    bindDataStorage->uvDataPtr = glVBOPtr;
+    bindDataStorage->hasBoneData = includeBoneData;
+    bindDataStorage->boneWeightDataPtr = includeBoneData ? glVBOPtr : 0;
+    bindDataStorage->boneIndexDataPtr = includeBoneData ? glVBOPtr : 0;
+    bindDataStorage->layout = VERTEX_BUFFERS_INTERLEAVED;
+    bindDataStorage->format = format;
+
+    GLuint glIBOPtr;
+    glGenBuffers( 1, &glIBOPtr );
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, glIBOPtr );
+    glBufferData( GL_ELEMENT_ARRAY_BUFFER, meshDataStorage->dataCount * sizeof(uint32), meshDataStorage->iData, GL_STATIC_DRAW );
+    bindDataStorage->indexDataPtr = glIBOPtr;
+
+    bindDataStorage->dataCount = meshDataStorage->dataCount;
+}
+
+void CreateRenderBinding( MeshGeometryData* meshDataStorage, MeshGPUBinding* bindDataStorage, VertexBufferLayout layout ) {
+    if( layout == VERTEX_BUFFERS_INTERLEAVED ) {
+        CreateInterleavedRenderBinding( meshDataStorage, bindDataStorage );
+        return;
+    }
+    bindDataStorage->layout = VERTEX_BUFFERS_SEPARATE;
+    memset( &bindDataStorage->format, 0, sizeof( InterleavedVertexFormat ) );
+
 	GLuint glVBOPtr;
 	glGenBuffers( 1, &glVBOPtr );
 	glBindBuffer( GL_ARRAY_BUFFER, glVBOPtr );
-	glBufferData( GL_ARRAY_BUFFER, meshDataStorage->dataCount  * 3 * sizeof(float), meshDataStorage->vData, GL_STATIC_DRAW );
+	glBufferData( GL_ARRAY_BUFFER, meshDataStorage->vertexCount * 3 * sizeof(float), meshDataStorage->vData, GL_STATIC_DRAW );
 	bindDataStorage->vertexDataPtr = glVBOPtr;
 
     GLuint glNormalPtr;
     glGenBuffers( 1, &glNormalPtr );
     glBindBuffer( GL_ARRAY_BUFFER, glNormalPtr );
-    glBufferData( GL_ARRAY_BUFFER, meshDataStorage->dataCount * 3 * sizeof(float), meshDataStorage->normalData, GL_STATIC_DRAW );
+    glBufferData( GL_ARRAY_BUFFER, meshDataStorage->vertexCount * 3 * sizeof(float), meshDataStorage->normalData, GL_STATIC_DRAW );
     bindDataStorage->nrmlDataPtr = glNormalPtr;
 
     GLuint glUVPtr;
     glGenBuffers( 1, &glUVPtr );
     glBindBuffer( GL_ARRAY_BUFFER, glUVPtr );
-    glBufferData( GL_ARRAY_BUFFER, meshDataStorage->dataCount * 2 * sizeof(float), meshDataStorage->uvData, GL_STATIC_DRAW );
+    glBufferData( GL_ARRAY_BUFFER, meshDataStorage->vertexCount * 2 * sizeof(float), meshDataStorage->uvData, GL_STATIC_DRAW );
     bindDataStorage->uvDataPtr = glUVPtr;
 
 	GLuint glIBOPtr;
@@ -496,23 +903,54 @@ void CreateRenderBinding( MeshGeometryData* meshDataStorage, MeshGPUBinding* bin
         GLuint glBoneWeightBufferPtr;
         glGenBuffers( 1, &glBoneWeightBufferPtr );
         glBindBuffer( GL_ARRAY_BUFFER, glBoneWeightBufferPtr );
-        glBufferData( GL_ARRAY_BUFFER, meshDataStorage->dataCount * MAXBONESPERVERT * sizeof(float), meshDataStorage->boneWeightData, GL_STATIC_DRAW );
+        glBufferData( GL_ARRAY_BUFFER, meshDataStorage->vertexCount * MAXBONESPERVERT * sizeof(float), meshDataStorage->boneWeightData, GL_STATIC_DRAW );
         bindDataStorage->boneWeightDataPtr = glBoneWeightBufferPtr;
 
         GLuint glBoneIndexBufferPtr;
         glGenBuffers( 1, &glBoneIndexBufferPtr );
         glBindBuffer( GL_ARRAY_BUFFER, glBoneIndexBufferPtr );
-        glBufferData( GL_ARRAY_BUFFER, meshDataStorage->dataCount * MAXBONESPERVERT * sizeof(uint32), meshDataStorage->boneIndexData, GL_STATIC_DRAW );
+        glBufferData( GL_ARRAY_BUFFER, meshDataStorage->vertexCount * MAXBONESPERVERT * sizeof(uint32), meshDataStorage->boneIndexData, GL_STATIC_DRAW );
         bindDataStorage->boneIndexDataPtr = glBoneIndexBufferPtr;
     } else {
         bindDataStorage->hasBoneData = false;
+        bindDataStorage->boneWeightDataPtr = 0;
+        bindDataStorage->boneIndexDataPtr = 0;
     }
 
 	bindDataStorage->dataCount = meshDataStorage->dataCount;
 }
 
+void DestroyRenderBinding( MeshGPUBinding* bindDataStorage ) {
+    //Interleaved bindings name the same buffer from several fields, only delete each buffer once
+    GLuint buffers[6];
+    uint32 bufferCount = 0;
+    uint32 candidates[6] = {
+        bindDataStorage->vertexDataPtr, bindDataStorage->nrmlDataPtr, bindDataStorage->uvDataPtr,
+        bindDataStorage->indexDataPtr, bindDataStorage->boneWeightDataPtr, bindDataStorage->boneIndexDataPtr
+    };
+    for( uint32 candidateIndex = 0; candidateIndex < 6; ++candidateIndex ) {
+        uint32 buffer = candidates[ candidateIndex ];
+        bool seen = buffer == 0;
+        for( uint32 bufferIndex = 0; bufferIndex < bufferCount && !seen; ++bufferIndex ) {
+            seen = buffers[ bufferIndex ] == buffer;
+        }
+        if( !seen ) buffers[ bufferCount++ ] = buffer;
+    }
+    glDeleteBuffers( bufferCount, buffers );
+    memset( bindDataStorage, 0, sizeof( MeshGPUBinding ) );
+}
+
+void DestroyShaderParamSet( ShaderProgramParams* params ) {
+    if( params->vertexArrayPtr != 0 ) {
+        glDeleteVertexArrays( 1, &params->vertexArrayPtr );
+    }
+    params->vertexArrayPtr = 0;
+    params->vertexArrayIndexPtr = 0;
+    params->vertexArrayDirty = true;
+}
+
 RendererStorage* InitRenderer( uint16 screen_w, uint16 screen_h, SlabSubsection_Stack* systemsMemory ) {
-    RendererStorage* rendererStorage = (RendererStorage*)AllocOnSubStack_Aligned( systemsMemory, sizeof( RendererStorage ), 4 );
+    RendererStorage* rendererStorage = (RendererStorage*)AllocOnSubStack_Aligned( systemsMemory, sizeof( RendererStorage ), alignof( RendererStorage ) );
 
 	printf( "Vendor: %s\n", glGetString( GL_VENDOR ) );
     printf( "Renderer: %s\n", glGetString( GL_RENDERER ) );
@@ -558,6 +996,20 @@ RendererStorage* InitRenderer( uint16 screen_w, uint16 screen_h, SlabSubsection_
     rendererStorage->quadUVAttribPtr = GetShaderProgramInputPtr( &rendererStorage->texturedQuadShader, "texCoord" );
     rendererStorage->quadMat4UniformPtr = GetShaderProgramInputPtr( &rendererStorage->texturedQuadShader, "modelMatrix" );
 
+    //Quad inputs never change, so they are recorded once into a vertex array here
+    GLuint glQuadVertexArrayPtr;
+    glGenVertexArrays( 1, &glQuadVertexArrayPtr );
+    glBindVertexArray( glQuadVertexArrayPtr );
+    glBindBuffer( GL_ARRAY_BUFFER, rendererStorage->quadVDataPtr );
+    glEnableVertexAttribArray( rendererStorage->quadPosAttribPtr );
+    glVertexAttribPointer( rendererStorage->quadPosAttribPtr, 3, GL_FLOAT, GL_FALSE, 0, 0 );
+    glBindBuffer( GL_ARRAY_BUFFER, rendererStorage->quadUVDataPtr );
+    glEnableVertexAttribArray( rendererStorage->quadUVAttribPtr );
+    glVertexAttribPointer( rendererStorage->quadUVAttribPtr, 2, GL_FLOAT, GL_FALSE, 0, 0 );
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, rendererStorage->quadIDataPtr );
+    glBindVertexArray( 0 );
+    rendererStorage->quadVertexArrayPtr = glQuadVertexArrayPtr;
+
     //Check for error
     GLenum error = glGetError();
     if( error != GL_NO_ERROR ) {
@@ -611,13 +1063,66 @@ RendererStorage* InitRenderer( uint16 screen_w, uint16 screen_h, SlabSubsection_
     return rendererStorage;
 }
 
-void RenderBoundData( ShaderProgram* programBinding, ShaderProgramParams* params ) {
-	//Flush errors
-    //while( glGetError() != GL_NO_ERROR ){};
+InstanceBuffer CreateInstanceBuffer( uint32 instanceSize, uint32 maxInstances ) {
+    InstanceBuffer instanceBuffer;
+    instanceBuffer.instanceSize = instanceSize;
+    instanceBuffer.maxInstances = maxInstances;
 
-    //Bind Shader
-    glUseProgram( programBinding->programID );
+    GLuint glInstanceBufferPtr;
+    glGenBuffers( 1, &glInstanceBufferPtr );
+    glBindBuffer( GL_ARRAY_BUFFER, glInstanceBufferPtr );
+    glBufferData( GL_ARRAY_BUFFER, instanceSize * maxInstances, NULL, GL_STREAM_DRAW );
+    instanceBuffer.bufferPtr = glInstanceBufferPtr;
+
+    return instanceBuffer;
+}
+
+void UpdateInstanceBuffer( InstanceBuffer* instanceBuffer, void* instanceData, uint32 instanceCount ) {
+    assert( instanceCount <= instanceBuffer->maxInstances );
+    glBindBuffer( GL_ARRAY_BUFFER, instanceBuffer->bufferPtr );
+    //Orphan the old storage so the driver doesn't stall waiting on last frame's draws
+    glBufferData( GL_ARRAY_BUFFER, instanceBuffer->instanceSize * instanceBuffer->maxInstances, NULL, GL_STREAM_DRAW );
+    glBufferSubData( GL_ARRAY_BUFFER, 0, instanceBuffer->instanceSize * instanceCount, instanceData );
+}
+
+UniformBuffer CreateUniformBuffer( uint32 size, uint32 bindingPoint ) {
+    UniformBuffer uniformBuffer;
+    uniformBuffer.size = size;
+    uniformBuffer.bindingPoint = bindingPoint;
 
+    GLuint glUniformBufferPtr;
+    glGenBuffers( 1, &glUniformBufferPtr );
+    glBindBuffer( GL_UNIFORM_BUFFER, glUniformBufferPtr );
+    glBufferData( GL_UNIFORM_BUFFER, size, NULL, GL_DYNAMIC_DRAW );
+    glBindBufferBase( GL_UNIFORM_BUFFER, bindingPoint, glUniformBufferPtr );
+    glBindBuffer( GL_UNIFORM_BUFFER, 0 );
+    uniformBuffer.bufferPtr = glUniformBufferPtr;
+
+    return uniformBuffer;
+}
+
+void UpdateUniformBuffer( UniformBuffer* uniformBuffer, void* data, uint32 size ) {
+    assert( size <= uniformBuffer->size );
+    glBindBuffer( GL_UNIFORM_BUFFER, uniformBuffer->bufferPtr );
+    glBufferSubData( GL_UNIFORM_BUFFER, 0, size, data );
+    glBindBuffer( GL_UNIFORM_BUFFER, 0 );
+}
+
+void SetUniformBlock( ShaderProgram* program, ShaderName blockName, UniformBuffer* uniformBuffer ) {
+    int32 blockIndex = FindShaderName( program, blockName.hash, SHADER_NAME_UNIFORM_BLOCK );
+    if( blockIndex < 0 ) {
+        printf( "Cannot find uniform block named: %s\n", blockName.str );
+        return;
+    }
+    if( program->uniformBlockSizes[ blockIndex ] > (int32)uniformBuffer->size ) {
+        printf( "Uniform buffer for block %s is %u bytes, block needs %d\n", blockName.str, uniformBuffer->size, program->uniformBlockSizes[ blockIndex ] );
+    }
+    glUniformBlockBinding( program->programID, program->uniformBlockIndices[ blockIndex ], uniformBuffer->bindingPoint );
+    program->uniformBlockBindings[ blockIndex ] = uniformBuffer->bindingPoint;
+}
+
+///Records every vertex input and the index buffer into whatever vertex array is currently bound
+static void SetupVertexInputs( ShaderProgram* programBinding, ShaderProgramParams* params ) {
     for( int attributeIndex = 0; attributeIndex < programBinding->vertInputCount; ++attributeIndex ) {
         GLuint attribPtr = programBinding->vertexInputPtrs[ attributeIndex ];
         GLenum type = programBinding->vertexInputTypes[ attributeIndex ];
@@ -627,18 +1132,68 @@ void RenderBoundData( ShaderProgram* programBinding, ShaderProgramParams* params
             continue;
         }
 
-        int count;
-        uint32 attributeDataPtr = params->vertexInputData[ attributeIndex ];
-        if( type == GL_FLOAT_VEC3 ) {
-            count = 3;
-        } else if( type == GL_FLOAT_VEC2 ) {
+        //Matrix inputs take up one attribute slot per column
+        int count = 1;
+        int columnCount = 1;
+        bool isInteger = false;
+        if( type == GL_FLOAT_VEC2 ) {
             count = 2;
+        } else if( type == GL_FLOAT_VEC3 ) {
+            count = 3;
+        } else if( type == GL_FLOAT_VEC4 ) {
+            count = 4;
+        } else if( type == GL_FLOAT_MAT4 ) {
+            count = 4;
+            columnCount = 4;
+        } else if( type == GL_INT_VEC4 || type == GL_UNSIGNED_INT_VEC4 ) {
+            //Bone indices, read straight as integers rather than converted to float
+            count = 4;
+            isInteger = true;
+        }
+
+        GLsizei stride = params->vertexInputStrides[ attributeIndex ];
+        if( stride == 0 && columnCount > 1 ) {
+            stride = count * columnCount * sizeof( float );
+        }
+        uintptr offset = params->vertexInputOffsets[ attributeIndex ];
+
+        glBindBuffer( GL_ARRAY_BUFFER, attribBufferPtr );
+        for( int column = 0; column < columnCount; ++column ) {
+            glEnableVertexAttribArray( attribPtr + column );
+            if( isInteger ) {
+                glVertexAttribIPointer( attribPtr + column, count, GL_UNSIGNED_INT, stride, (void*)offset );
+            } else {
+                glVertexAttribPointer( attribPtr + column, count, GL_FLOAT, GL_FALSE, stride, (void*)( offset + column * count * sizeof( float ) ) );
+            }
+            glVertexAttribDivisor( attribPtr + column, params->vertexInputDivisors[ attributeIndex ] );
         }
-        glBindBuffer( GL_ARRAY_BUFFER, attributeDataPtr );
-        glEnableVertexAttribArray( attribPtr );
-        glVertexAttribPointer( attribPtr, count, GL_FLOAT, GL_FALSE, 0, 0 );
     }
 
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, params->indexDataPtr );
+}
+
+///Returns the cached vertex array for this mesh/program pair, building it the first time and again whenever an input changed.
+///A freshly built array is left bound
+static uint32 GetVertexArray( ShaderProgram* programBinding, ShaderProgramParams* params ) {
+    if( params->vertexArrayPtr != 0 && !params->vertexArrayDirty && params->vertexArrayIndexPtr == params->indexDataPtr ) {
+        return params->vertexArrayPtr;
+    }
+
+    if( params->vertexArrayPtr != 0 ) {
+        glDeleteVertexArrays( 1, &params->vertexArrayPtr );
+    }
+    GLuint glVertexArrayPtr;
+    glGenVertexArrays( 1, &glVertexArrayPtr );
+    glBindVertexArray( glVertexArrayPtr );
+    SetupVertexInputs( programBinding, params );
+
+    params->vertexArrayPtr = glVertexArrayPtr;
+    params->vertexArrayIndexPtr = params->indexDataPtr;
+    params->vertexArrayDirty = false;
+    return glVertexArrayPtr;
+}
+
+static void UploadUniforms( ShaderProgram* programBinding, ShaderProgramParams* params ) {
     for( int uniformIndex = 0; uniformIndex < programBinding->uniformCount; ++uniformIndex ) {
         GLuint uniformPtr = programBinding->uniformPtrs[ uniformIndex ];
         GLenum type = programBinding->uniformTypes[ uniformIndex ];
@@ -658,6 +1213,15 @@ void RenderBoundData( ShaderProgram* programBinding, ShaderProgramParams* params
             glUniform3fv( uniformPtr, 1, (float*)uniformData );
         }
     }
+}
+
+static void BindShaderParams( ShaderProgram* programBinding, ShaderProgramParams* params ) {
+    uint32 vertexArrayPtr = GetVertexArray( programBinding, params );
+
+    //Bind Shader
+    glUseProgram( programBinding->programID );
+    glBindVertexArray( vertexArrayPtr );
+    UploadUniforms( programBinding, params );
 
     for( int samplerIndex = 0; samplerIndex < programBinding->samplerCount; ++samplerIndex ){
         if( params->samplerData == 0 ) {
@@ -666,10 +1230,11 @@ void RenderBoundData( ShaderProgram* programBinding, ShaderProgramParams* params
         glActiveTexture( GL_TEXTURE0 + samplerIndex );
         glBindTexture( GL_TEXTURE_2D, params->samplerData[ samplerIndex ] );
     }
+}
 
-    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, params->indexDataPtr );
-    glDrawElements( GL_TRIANGLES, params->indiciesToDraw, GL_UNSIGNED_INT, NULL );
-
+static void UnbindShaderParams( ShaderProgram* programBinding ) {
+    //Attribute divisors and pointers are vertex array state, unbinding it is enough to keep them from leaking into other draws
+    glBindVertexArray( 0 );
     for( int samplerIndex = 0; samplerIndex < programBinding->samplerCount; ++samplerIndex ) {
         glActiveTexture( GL_TEXTURE0 + samplerIndex );
         glBindTexture( GL_TEXTURE_2D, 0 );
@@ -677,6 +1242,95 @@ void RenderBoundData( ShaderProgram* programBinding, ShaderProgramParams* params
     glUseProgram( 0 );
 }
 
+void RenderBoundData( ShaderProgram* programBinding, ShaderProgramParams* params ) {
+	//Flush errors
+    //while( glGetError() != GL_NO_ERROR ){};
+
+    BindShaderParams( programBinding, params );
+    glDrawElements( GL_TRIANGLES, params->indiciesToDraw, GL_UNSIGNED_INT, NULL );
+    UnbindShaderParams( programBinding );
+}
+
+void RenderBoundDataInstanced( ShaderProgram* programBinding, ShaderProgramParams* params, uint32 instanceCount ) {
+    if( instanceCount == 0 ) return;
+
+    BindShaderParams( programBinding, params );
+    glDrawElementsInstanced( GL_TRIANGLES, params->indiciesToDraw, GL_UNSIGNED_INT, NULL, instanceCount );
+    UnbindShaderParams( programBinding );
+}
+
+///Mirror of the GL state the command submission has set, so packets only send what differs from the previous one
+struct GLStateCache {
+    uint32 program;
+    uint32 vertexArray;
+    TextureBindingID textures[ MAX_SUPPORTED_TEX_SAMPLERS ];
+};
+
+void SubmitRenderCommands( RenderCommandList* list ) {
+    SortRenderCommands( list );
+
+    GLStateCache cache;
+    memset( &cache, 0, sizeof( GLStateCache ) );
+    RenderStats* stats = &list->stats;
+
+    for( uint32 commandIndex = 0; commandIndex < list->commandCount; ++commandIndex ) {
+        RenderCommand* command = &list->commands[ commandIndex ];
+        ShaderProgram* programBinding = command->program;
+        ShaderProgramParams* params = command->params;
+
+        if( cache.program != programBinding->programID ) {
+            glUseProgram( programBinding->programID );
+            cache.program = programBinding->programID;
+            stats->programBindsIssued++;
+        } else {
+            stats->programBindsSkipped++;
+        }
+
+        //Vertex attributes and the index buffer both live in the vertex array, so this one bind covers the whole mesh
+        uint32 vertexArrayPtr = GetVertexArray( programBinding, params );
+        if( cache.vertexArray != vertexArrayPtr ) {
+            glBindVertexArray( vertexArrayPtr );
+            cache.vertexArray = vertexArrayPtr;
+            stats->vertexBindsIssued++;
+        } else {
+            stats->vertexBindsSkipped++;
+        }
+
+        //Uniform values live behind pointers and may have changed since the last packet, so they are always sent
+        UploadUniforms( programBinding, params );
+
+        for( int samplerIndex = 0; samplerIndex < programBinding->samplerCount; ++samplerIndex ) {
+            if( cache.textures[ samplerIndex ] == params->samplerData[ samplerIndex ] ) {
+                stats->textureBindsSkipped++;
+                continue;
+            }
+            glActiveTexture( GL_TEXTURE0 + samplerIndex );
+            glBindTexture( GL_TEXTURE_2D, params->samplerData[ samplerIndex ] );
+            cache.textures[ samplerIndex ] = params->samplerData[ samplerIndex ];
+            stats->textureBindsIssued++;
+        }
+
+        if( command->instanceCount > 0 ) {
+            glDrawElementsInstanced( GL_TRIANGLES, params->indiciesToDraw, GL_UNSIGNED_INT, NULL, command->instanceCount );
+        } else {
+            glDrawElements( GL_TRIANGLES, params->indiciesToDraw, GL_UNSIGNED_INT, NULL );
+        }
+        stats->drawCalls++;
+    }
+
+    //Leave GL the way the immediate RenderBoundData path expects to find it
+    glBindVertexArray( 0 );
+    for( int samplerIndex = 0; samplerIndex < MAX_SUPPORTED_TEX_SAMPLERS; ++samplerIndex ) {
+        if( cache.textures[ samplerIndex ] != 0 ) {
+            glActiveTexture( GL_TEXTURE0 + samplerIndex );
+            glBindTexture( GL_TEXTURE_2D, 0 );
+        }
+    }
+    glUseProgram( 0 );
+
+    list->commandCount = 0;
+}
+
 void RenderTexturedQuad( RendererStorage* rendererStorage, TextureBindingID texture, float width, float height, float x, float y ) {
     Mat4 transform, translation, scale; SetToIdentity( &translation ); SetToIdentity( &scale );
     SetScale( &scale, width, height, 1.0f  ); SetTranslation( &translation, x, y, 0.0f );
@@ -685,21 +1339,13 @@ void RenderTexturedQuad( RendererStorage* rendererStorage, TextureBindingID text
     glUseProgram( rendererStorage->texturedQuadShader.programID );
     glUniformMatrix4fv( rendererStorage->quadMat4UniformPtr, 1, false, (float*)&transform );
 
-    //Set vertex data
-    glBindBuffer( GL_ARRAY_BUFFER, rendererStorage->quadVDataPtr );
-    glEnableVertexAttribArray( rendererStorage->quadPosAttribPtr );
-    glVertexAttribPointer( rendererStorage->quadPosAttribPtr, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-    //Set UV data
-    glBindBuffer( GL_ARRAY_BUFFER, rendererStorage->quadUVDataPtr );
-    glEnableVertexAttribArray( rendererStorage->quadUVAttribPtr );
-    glVertexAttribPointer( rendererStorage->quadUVAttribPtr, 2, GL_FLOAT, GL_FALSE, 0, 0 );
+    glBindVertexArray( rendererStorage->quadVertexArrayPtr );
 
     glActiveTexture( GL_TEXTURE0 );
     glBindTexture( GL_TEXTURE_2D, (GLuint)texture );
 
-    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, rendererStorage->quadIDataPtr );
     glDrawElements( GL_TRIANGLES, 6, GL_UNSIGNED_INT, NULL );
+    glBindVertexArray( 0 );
 }
 
 void RenderDebugCircle( RendererStorage* rendererStorage, Vec3 position, float radius, Vec3 color ) {
@@ -720,7 +1366,7 @@ void RenderDebugCircle( RendererStorage* rendererStorage, Vec3 position, float r
     // glDrawElements( GL_TRIANGLE_FAN, 18, GL_UNSIGNED_INT, NULL );
 }
 
-void RenderDebugLines( RendererStorage* rendererStorage, float* vertexData, uint8 dataCount, Mat4 transform, Vec3 color ) {
+void RenderDebugLines( RendererStorage* rendererStorage, float* vertexData, uint8 dataCount, const Mat4& transform, Vec3 color ) {
     glUseProgram( rendererStorage->pShader.programID );
 
     assert(false);
@@ -737,7 +1383,7 @@ void RenderDebugLines( RendererStorage* rendererStorage, float* vertexData, uint
     // glDrawElements( GL_LINES, dataCount, GL_UNSIGNED_INT, NULL );
 }
 
-void RenderArmatureAsLines( RendererStorage* rStorage, Armature* armature, Mat4 transform, Vec3 color ) {
+void RenderArmatureAsLines( RendererStorage* rStorage, Armature* armature, const Mat4& transform, Vec3 color ) {
     bool isDepthTesting;
     glGetBooleanv( GL_DEPTH_TEST, ( GLboolean* )&isDepthTesting );
     if( isDepthTesting ) {
@@ -800,4 +1446,8 @@ void RenderArmatureAsLines( RendererStorage* rStorage, Armature* armature, Mat4
         glEnable( GL_DEPTH_TEST );
     }
 }
-#endif
\ No newline at end of file
+#endif
+
+#ifdef SOFTWARE_RENDERER_IMPLEMENTATION
+    #include "SoftwareRenderer.h"
+#endif
@@ -0,0 +1,108 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+/*------------------------------------------------------------------------------------------------------------------
+                                                 SCENE STORE
+    Per object data kept as parallel arrays (structure of arrays) so passes only touch the fields they need,
+    object i is index i in every array
+-------------------------------------------------------------------------------------------------------------------*/
+
+struct SceneStore {
+    Vec3* positions;
+    Quat* rotations;
+    Vec3* scales;
+    //Transforms as of the start of the last simulation step, rendering blends from these toward the current ones
+    Vec3* previousPositions;
+    Quat* previousRotations;
+    Vec3* previousScales;
+    //Output of UpdateSceneWorldMatrices, tightly packed so it can go to an instance buffer as is
+    Mat4* worldMatrices;
+    //Float because that's what the instance attribute reads, same reason as above
+    float* materialIndices;
+    uint32 count;
+    uint32 capacity;
+};
+
+///Pointers to one object's fields, only valid until the store is recreated
+struct SceneObjectRef {
+    Vec3* position;
+    Quat* rotation;
+    Vec3* scale;
+    float* materialIndex;
+};
+
+SceneStore CreateSceneStore( SlabSubsection_Stack* allocater, uint32 capacity ) {
+    SceneStore scene = { };
+    scene.positions = (Vec3*)AllocOnSubStack_Aligned( allocater, sizeof( Vec3 ) * capacity, 16 );
+    scene.rotations = (Quat*)AllocOnSubStack_Aligned( allocater, sizeof( Quat ) * capacity, 16 );
+    scene.scales = (Vec3*)AllocOnSubStack_Aligned( allocater, sizeof( Vec3 ) * capacity, 16 );
+    scene.previousPositions = (Vec3*)AllocOnSubStack_Aligned( allocater, sizeof( Vec3 ) * capacity, 16 );
+    scene.previousRotations = (Quat*)AllocOnSubStack_Aligned( allocater, sizeof( Quat ) * capacity, 16 );
+    scene.previousScales = (Vec3*)AllocOnSubStack_Aligned( allocater, sizeof( Vec3 ) * capacity, 16 );
+    scene.worldMatrices = (Mat4*)AllocOnSubStack_Aligned( allocater, sizeof( Mat4 ) * capacity, alignof( Mat4 ) );
+    scene.materialIndices = (float*)AllocOnSubStack_Aligned( allocater, sizeof( float ) * capacity, 16 );
+    scene.capacity = capacity;
+    scene.count = 0;
+    return scene;
+}
+
+///Returns the new object's index, world matrix is identity until the next UpdateSceneWorldMatrices
+uint32 AddSceneObject( SceneStore* scene, Vec3 position, Quat rotation, Vec3 scale, float materialIndex ) {
+    assert( scene->count < scene->capacity );
+    uint32 index = scene->count++;
+    scene->positions[ index ] = position;
+    scene->rotations[ index ] = rotation;
+    scene->scales[ index ] = scale;
+    scene->previousPositions[ index ] = position;
+    scene->previousRotations[ index ] = rotation;
+    scene->previousScales[ index ] = scale;
+    scene->materialIndices[ index ] = materialIndex;
+    SetToIdentity( &scene->worldMatrices[ index ] );
+    return index;
+}
+
+SceneObjectRef GetSceneObject( SceneStore* scene, uint32 index ) {
+    assert( index < scene->count );
+    SceneObjectRef ref;
+    ref.position = &scene->positions[ index ];
+    ref.rotation = &scene->rotations[ index ];
+    ref.scale = &scene->scales[ index ];
+    ref.materialIndex = &scene->materialIndices[ index ];
+    return ref;
+}
+
+///Calls fn( index ) for every object in order, meant for lambdas that index straight into the arrays they need
+template< typename Fn >
+void ForEachSceneObject( SceneStore* scene, Fn fn ) {
+    for( uint32 index = 0; index < scene->count; ++index ) {
+        fn( index );
+    }
+}
+
+///Rebuilds every world matrix from position, rotation and scale in one batched pass
+void UpdateSceneWorldMatrices( SceneStore* scene ) {
+    Mat4ArrayFromComponents( scene->scales, scene->rotations, scene->positions, scene->worldMatrices, scene->count );
+}
+
+///Call at the top of each simulation step, before anything moves
+void SaveSceneTransforms( SceneStore* scene ) {
+    memcpy( scene->previousPositions, scene->positions, sizeof( Vec3 ) * scene->count );
+    memcpy( scene->previousRotations, scene->rotations, sizeof( Quat ) * scene->count );
+    memcpy( scene->previousScales, scene->scales, sizeof( Vec3 ) * scene->count );
+}
+
+///World matrices for a point alpha of the way from the saved transforms to the current ones, blended copies come from scratch
+void UpdateSceneWorldMatricesInterpolated( SceneStore* scene, float alpha, FrameArena* scratch ) {
+    Vec3* positions = PushArray<Vec3>( scratch, scene->count );
+    Quat* rotations = PushArray<Quat>( scratch, scene->count );
+    Vec3* scales = PushArray<Vec3>( scratch, scene->count );
+    float previousWeight = 1.0f - alpha;
+    ForEachSceneObject( scene, [&]( uint32 i ) {
+        positions[i] = scene->previousPositions[i] * previousWeight + scene->positions[i] * alpha;
+        rotations[i] = Nlerp( scene->previousRotations[i], scene->rotations[i], alpha );
+        scales[i] = scene->previousScales[i] * previousWeight + scene->scales[i] * alpha;
+    } );
+    Mat4ArrayFromComponents( scales, rotations, positions, scene->worldMatrices, scene->count );
+}
+
+#endif
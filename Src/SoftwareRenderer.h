@@ -0,0 +1,989 @@
+/*------------------------------------------------------------------------------------------------------------------
+                                       SOFTWARE RASTERIZER IMPLEMENTATION
+    Headless stand in for the OpenGL backend, renders into an in-memory RGBA/depth buffer. GLSL can't run here, so
+    every shader program the game creates has to have a C++ port registered in softwareShaders below.
+-------------------------------------------------------------------------------------------------------------------*/
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+#define SOFTWARE_MAX_BUFFERS 1024
+#define SOFTWARE_MAX_TEXTURES 256
+#define SOFTWARE_MAX_FRAMEBUFFERS 16
+#define SOFTWARE_MAX_UNIFORM_BINDINGS 16
+#define SOFTWARE_MAX_VARYINGS 40
+#define SOFTWARE_TILE_SIZE 64
+
+struct SoftwareBuffer {
+    uint8* data;
+    uint32 size;
+};
+
+struct SoftwareRenderTarget {
+    //RGBA8, row 0 is the bottom of the image like GL window coordinates
+    uint8* color;
+    float* depth;
+    uint16 width;
+    uint16 height;
+};
+
+///Everything a ported shader can read during a draw
+struct SoftwareShaderContext {
+    ShaderProgram* program;
+    ShaderProgramParams* params;
+    uint32 instanceIndex;
+};
+
+typedef void (*SoftwareVertexShader)( SoftwareShaderContext* ctx, uint32 vertexIndex, float* clipPositionOut, float* varyingsOut );
+///depth comes in as the interpolated window depth and may be overwritten, return false to discard the fragment
+typedef bool (*SoftwareFragmentShader)( SoftwareShaderContext* ctx, float* varyings, float fragCoordX, float fragCoordY, float* depth, float* colorOut );
+
+struct SoftwareShaderInput {
+    const char* name;
+    //Floats per element, 16 for a mat4
+    uint8 floatCount;
+};
+
+///C++ port of a GLSL program. Input, sampler and block order here is the order reflection reports them in
+struct SoftwareShaderDesc {
+    const char* vertProgramFileName;
+    SoftwareShaderInput vertexInputs[ MAX_SUPPORTED_VERT_INPUTS ];
+    uint8 vertexInputCount;
+    const char* uniformNames[ MAX_SUPPORTED_UNIFORMS ];
+    uint8 uniformCount;
+    const char* samplerNames[ MAX_SUPPORTED_TEX_SAMPLERS ];
+    uint8 samplerCount;
+    const char* uniformBlockNames[ MAX_SUPPORTED_UNIFORM_BLOCKS ];
+    uint32 uniformBlockSizes[ MAX_SUPPORTED_UNIFORM_BLOCKS ];
+    uint8 uniformBlockCount;
+    //Varyings [0, smoothVaryingCount) are interpolated, the rest up to varyingCount are flat
+    uint8 smoothVaryingCount;
+    uint8 varyingCount;
+    SoftwareVertexShader vertexShader;
+    SoftwareFragmentShader fragmentShader;
+};
+
+struct SoftwareVertexOut {
+    float clip[4];
+    float varyings[ SOFTWARE_MAX_VARYINGS ];
+};
+
+struct SoftwareTriangle {
+    float x[3], y[3], z[3], invW[3];
+    float area;
+    int32 minX, minY, maxX, maxY;
+    SoftwareVertexOut* verts[3];
+};
+
+static struct {
+    SoftwareRenderTarget screen;
+    SoftwareRenderTarget* currentTarget;
+    SoftwareRenderTarget framebufferTargets[ SOFTWARE_MAX_FRAMEBUFFERS ];
+    uint32 framebufferCount;
+
+    SoftwareBuffer buffers[ SOFTWARE_MAX_BUFFERS ];
+    uint32 bufferCount;
+    //Pixel data is shared with the TextureData it was created from, not copied
+    TextureData textures[ SOFTWARE_MAX_TEXTURES ];
+    uint32 textureCount;
+    uint32 uniformBindings[ SOFTWARE_MAX_UNIFORM_BINDINGS ];
+    float clearColor[4];
+
+    //Scratch reused between draws, grown as needed
+    SoftwareVertexOut* vertexScratch;
+    uint32 vertexScratchSize;
+    SoftwareTriangle* triangleScratch;
+    uint32 triangleScratchSize;
+} softwareRenderer;
+
+/*------------------------------------------------------------------------------------------------------------------
+                                                 Worker threads
+-------------------------------------------------------------------------------------------------------------------*/
+
+typedef void (*SoftwareJob)( void* jobData, uint32 jobIndex );
+
+static struct {
+    uint32 workerCount;
+    //Heap allocated and never freed, the detached workers are still waiting on these during static destruction
+    std::mutex* lock;
+    std::condition_variable* wakeCondition;
+    std::condition_variable* doneCondition;
+    uint32 generation;
+    uint32 busyWorkers;
+
+    SoftwareJob job;
+    void* jobData;
+    uint32 jobCount;
+    std::atomic<uint32> nextJob;
+} softwareJobs;
+
+static void RunSoftwareJobs() {
+    for(;;) {
+        uint32 jobIndex = softwareJobs.nextJob.fetch_add( 1 );
+        if( jobIndex >= softwareJobs.jobCount ) return;
+        softwareJobs.job( softwareJobs.jobData, jobIndex );
+    }
+}
+
+static void SoftwareWorkerLoop() {
+    uint32 seenGeneration = 0;
+    for(;;) {
+        {
+            std::unique_lock<std::mutex> guard( *softwareJobs.lock );
+            softwareJobs.wakeCondition->wait( guard, [&]{ return softwareJobs.generation != seenGeneration; } );
+            seenGeneration = softwareJobs.generation;
+        }
+
+        RunSoftwareJobs();
+
+        std::unique_lock<std::mutex> guard( *softwareJobs.lock );
+        if( --softwareJobs.busyWorkers == 0 ) {
+            softwareJobs.doneCondition->notify_one();
+        }
+    }
+}
+
+static void StartSoftwareWorkers() {
+    uint32 hardwareThreads = std::thread::hardware_concurrency();
+    softwareJobs.workerCount = ( hardwareThreads > 1 ) ? hardwareThreads - 1 : 0;
+    softwareJobs.lock = new std::mutex();
+    softwareJobs.wakeCondition = new std::condition_variable();
+    softwareJobs.doneCondition = new std::condition_variable();
+    softwareJobs.generation = 0;
+    softwareJobs.busyWorkers = 0;
+    for( uint32 workerIndex = 0; workerIndex < softwareJobs.workerCount; ++workerIndex ) {
+        std::thread( SoftwareWorkerLoop ).detach();
+    }
+    printf( "Software renderer using %u worker threads\n", softwareJobs.workerCount );
+}
+
+///Runs job for every index in [0, jobCount) across the workers and the calling thread, returns once all are done
+static void SoftwareParallelFor( uint32 jobCount, SoftwareJob job, void* jobData ) {
+    if( softwareJobs.workerCount == 0 || jobCount <= 1 ) {
+        for( uint32 jobIndex = 0; jobIndex < jobCount; ++jobIndex ) {
+            job( jobData, jobIndex );
+        }
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> guard( *softwareJobs.lock );
+        softwareJobs.job = job;
+        softwareJobs.jobData = jobData;
+        softwareJobs.jobCount = jobCount;
+        softwareJobs.nextJob = 0;
+        softwareJobs.busyWorkers = softwareJobs.workerCount;
+        softwareJobs.generation++;
+    }
+    softwareJobs.wakeCondition->notify_all();
+
+    RunSoftwareJobs();
+
+    std::unique_lock<std::mutex> guard( *softwareJobs.lock );
+    softwareJobs.doneCondition->wait( guard, []{ return softwareJobs.busyWorkers == 0; } );
+}
+
+/*------------------------------------------------------------------------------------------------------------------
+                                          Helpers for ported shaders
+-------------------------------------------------------------------------------------------------------------------*/
+
+static SoftwareBuffer* GetSoftwareBuffer( uint32 bufferID ) {
+    if( bufferID == 0 || bufferID > softwareRenderer.bufferCount ) return NULL;
+    return &softwareRenderer.buffers[ bufferID - 1 ];
+}
+
+///Reads one element of a vertex input, honouring its stride, offset and divisor. Missing data reads as zeros
+static void SoftwareFetchInput( SoftwareShaderContext* ctx, uint32 inputIndex, uint32 vertexIndex, float* out ) {
+    ShaderProgramParams* params = ctx->params;
+    uint32 floatCount = ctx->program->vertexInputTypes[ inputIndex ];
+    SoftwareBuffer* buffer = GetSoftwareBuffer( params->vertexInputData[ inputIndex ] );
+
+    uint32 element = ( params->vertexInputDivisors[ inputIndex ] != 0 ) ? ctx->instanceIndex / params->vertexInputDivisors[ inputIndex ] : vertexIndex;
+    uint32 stride = params->vertexInputStrides[ inputIndex ];
+    if( stride == 0 ) stride = floatCount * sizeof( float );
+    uint32 start = params->vertexInputOffsets[ inputIndex ] + element * stride;
+
+    if( buffer == NULL || start + floatCount * sizeof( float ) > buffer->size ) {
+        memset( out, 0, floatCount * sizeof( float ) );
+        return;
+    }
+    memcpy( out, buffer->data + start, floatCount * sizeof( float ) );
+}
+
+static void* SoftwareUniformBlockData( SoftwareShaderContext* ctx, uint32 blockIndex ) {
+    uint32 bindingPoint = ctx->program->uniformBlockBindings[ blockIndex ];
+    SoftwareBuffer* buffer = GetSoftwareBuffer( softwareRenderer.uniformBindings[ bindingPoint ] );
+    return ( buffer != NULL ) ? buffer->data : NULL;
+}
+
+///GL_LINEAR filtering with GL_REPEAT wrapping, matching what CreateTextureBinding asks GL for
+static void SoftwareSampleTexture( TextureBindingID texture, float u, float v, float* colorOut ) {
+    if( texture == 0 || texture > softwareRenderer.textureCount ) {
+        colorOut[0] = 0.0f; colorOut[1] = 0.0f; colorOut[2] = 0.0f; colorOut[3] = 1.0f;
+        return;
+    }
+    TextureData* tex = &softwareRenderer.textures[ texture - 1 ];
+
+    float x = u * tex->width - 0.5f;
+    float y = v * tex->height - 0.5f;
+    float floorX = floorf( x );
+    float floorY = floorf( y );
+    float fracX = x - floorX;
+    float fracY = y - floorY;
+    int32 x0 = ( (int32)floorX % tex->width + tex->width ) % tex->width;
+    int32 y0 = ( (int32)floorY % tex->height + tex->height ) % tex->height;
+    int32 x1 = ( x0 + 1 ) % tex->width;
+    int32 y1 = ( y0 + 1 ) % tex->height;
+
+    uint8* texels[4] = {
+        &tex->data[ ( y0 * tex->width + x0 ) * tex->channelsPerPixel ],
+        &tex->data[ ( y0 * tex->width + x1 ) * tex->channelsPerPixel ],
+        &tex->data[ ( y1 * tex->width + x0 ) * tex->channelsPerPixel ],
+        &tex->data[ ( y1 * tex->width + x1 ) * tex->channelsPerPixel ]
+    };
+    float weights[4] = {
+        ( 1.0f - fracX ) * ( 1.0f - fracY ), fracX * ( 1.0f - fracY ),
+        ( 1.0f - fracX ) * fracY, fracX * fracY
+    };
+
+    for( uint8 channel = 0; channel < 4; ++channel ) {
+        if( channel >= tex->channelsPerPixel ) {
+            colorOut[ channel ] = 1.0f;
+            continue;
+        }
+        float value = 0.0f;
+        for( uint8 texelIndex = 0; texelIndex < 4; ++texelIndex ) {
+            value += weights[ texelIndex ] * texels[ texelIndex ][ channel ];
+        }
+        colorOut[ channel ] = value / 255.0f;
+    }
+}
+
+///GLSL style m * v, m laid out the way glUniformMatrix4fv reads a Mat4 (each m[i] is a column)
+static void SoftwareTransform( const float* m, const float* v, float* out ) {
+    for( uint8 row = 0; row < 4; ++row ) {
+        out[ row ] = m[ 0 * 4 + row ] * v[0] + m[ 1 * 4 + row ] * v[1] + m[ 2 * 4 + row ] * v[2] + m[ 3 * 4 + row ] * v[3];
+    }
+}
+
+static void SoftwareMix( const float* a, const float* b, float t, float* out ) {
+    for( uint8 i = 0; i < 4; ++i ) {
+        out[i] = a[i] + ( b[i] - a[i] ) * t;
+    }
+}
+
+/*------------------------------------------------------------------------------------------------------------------
+                                        Basic.vert / Basic.frag port
+-------------------------------------------------------------------------------------------------------------------*/
+
+//std140 layouts of the blocks declared in Basic.vert/Basic.frag
+struct SoftwareBasicFrameConstants {
+    float cameraMatrix[16];
+    float lightColor[4];
+    float shadowColor[4];
+    float lightDirection[4];
+    float screenSize[2];
+};
+
+struct SoftwareBasicMaterial {
+    float outerColor1[4];
+    float outerColor2[4];
+    float innerColor1[4];
+    float innerColor2[4];
+    float innerBorderColor[4];
+    float outerBorderColor[4];
+    float widthsAndTypes[4];
+};
+
+enum {
+    BASIC_VARYING_BARY = 0, BASIC_VARYING_NRML = 3, BASIC_VARYING_MATERIAL = 6,
+    BASIC_SMOOTH_VARYING_COUNT = 6, BASIC_VARYING_COUNT = 6 + sizeof( SoftwareBasicMaterial ) / sizeof( float )
+};
+
+static void BasicVertexShader( SoftwareShaderContext* ctx, uint32 vertexIndex, float* clipPositionOut, float* varyingsOut ) {
+    float position[4], normal[4], texCoord[2], modelMatrix[16], materialIndex;
+    SoftwareFetchInput( ctx, 0, vertexIndex, position );
+    SoftwareFetchInput( ctx, 1, vertexIndex, normal );
+    SoftwareFetchInput( ctx, 2, vertexIndex, texCoord );
+    SoftwareFetchInput( ctx, 3, vertexIndex, modelMatrix );
+    SoftwareFetchInput( ctx, 4, vertexIndex, &materialIndex );
+    position[3] = 1.0f;
+    normal[3] = 0.0f;
+
+    SoftwareBasicFrameConstants* frame = (SoftwareBasicFrameConstants*)SoftwareUniformBlockData( ctx, 0 );
+    SoftwareBasicMaterial* materials = (SoftwareBasicMaterial*)SoftwareUniformBlockData( ctx, 1 );
+
+    float* bary = &varyingsOut[ BASIC_VARYING_BARY ];
+    if( texCoord[0] == 0.0f && texCoord[1] == 1.0f ) {
+        bary[0] = 1.0f; bary[1] = 0.0f; bary[2] = 0.0f;
+    } else if( texCoord[0] == 1.0f && texCoord[1] == 1.0f ) {
+        bary[0] = 0.0f; bary[1] = 1.0f; bary[2] = 0.0f;
+    } else {
+        bary[0] = 0.0f; bary[1] = 0.0f; bary[2] = 1.0f;
+    }
+
+    if( materials != NULL ) {
+        memcpy( &varyingsOut[ BASIC_VARYING_MATERIAL ], &materials[ (int32)materialIndex ], sizeof( SoftwareBasicMaterial ) );
+    }
+
+    float worldPosition[4], worldNormal[4];
+    SoftwareTransform( modelMatrix, position, worldPosition );
+    SoftwareTransform( modelMatrix, normal, worldNormal );
+    if( frame != NULL ) {
+        SoftwareTransform( frame->cameraMatrix, worldPosition, clipPositionOut );
+    } else {
+        memcpy( clipPositionOut, worldPosition, sizeof( float ) * 4 );
+    }
+    memcpy( &varyingsOut[ BASIC_VARYING_NRML ], worldNormal, sizeof( float ) * 3 );
+}
+
+static void BasicColorFragAsSpace( SoftwareShaderContext* ctx, SoftwareBasicFrameConstants* frame, float fragCoordX, float fragCoordY, float* depth, float* colorOut ) {
+    float adjustedX = ( fragCoordX - ( ( frame->screenSize[0] - frame->screenSize[1] ) * 0.5f ) ) / frame->screenSize[1];
+    float adjustedY = fragCoordY / frame->screenSize[1];
+    SoftwareSampleTexture( ctx->params->samplerData[0], adjustedX, adjustedY, colorOut );
+    //Same magic number as Basic.frag
+    *depth = 0.37125f;
+}
+
+static void BasicShade( SoftwareBasicFrameConstants* frame, float* nrml, float* colorOut ) {
+    float shadowDot = frame->lightDirection[0] * nrml[0] + frame->lightDirection[1] * nrml[1] + frame->lightDirection[2] * nrml[2];
+    float sign = ( shadowDot > 0.0f ) ? 1.0f : ( ( shadowDot < 0.0f ) ? -1.0f : 0.0f );
+    shadowDot = -1.0f * sign * sqrtf( fabsf( shadowDot ) );
+
+    if( shadowDot > 0.0f ) {
+        SoftwareMix( colorOut, frame->lightColor, shadowDot * 0.5f, colorOut );
+    } else {
+        SoftwareMix( colorOut, frame->shadowColor, shadowDot * -0.45f, colorOut );
+    }
+}
+
+static void BasicColorAsLines( float subRange, float* c1, float* c2, float* colorOut ) {
+    const float lineWidths = 0.1f;
+    float dividedRanges = subRange / lineWidths;
+    float modValue = fmodf( dividedRanges, 2.0f ) - 1.0f;
+    float sign = ( modValue > 0.0f ) ? 1.0f : ( ( modValue < 0.0f ) ? -1.0f : 0.0f );
+    float sectionEnum = ( 1.0f + sign ) / 2.0f;
+    SoftwareMix( c1, c2, sectionEnum, colorOut );
+}
+
+static bool BasicFragmentShader( SoftwareShaderContext* ctx, float* varyings, float fragCoordX, float fragCoordY, float* depth, float* colorOut ) {
+    SoftwareBasicFrameConstants* frame = (SoftwareBasicFrameConstants*)SoftwareUniformBlockData( ctx, 0 );
+    if( frame == NULL ) return false;
+
+    float* bary = &varyings[ BASIC_VARYING_BARY ];
+    float* nrml = &varyings[ BASIC_VARYING_NRML ];
+    SoftwareBasicMaterial* material = (SoftwareBasicMaterial*)&varyings[ BASIC_VARYING_MATERIAL ];
+
+    float minComponent = fminf( fminf( bary[0], bary[1] ), bary[2] );
+    float outerRange = material->widthsAndTypes[0] * 0.33333f;
+    float innerRange = material->widthsAndTypes[1] * 0.33333f;
+
+    float innerBorderWidth = 0.9f;
+    float outerBorderWidth = 0.9f;
+
+    if( minComponent > innerRange ) {
+        BasicColorFragAsSpace( ctx, frame, fragCoordX, fragCoordY, depth, colorOut );
+    } else if( minComponent > outerRange ) {
+        float subRegionRange = ( minComponent - outerRange ) / ( innerRange - outerRange );
+        if( subRegionRange < innerBorderWidth ) {
+            if( material->widthsAndTypes[2] == 0.5f ) {
+                SoftwareMix( material->innerColor1, material->innerColor2, subRegionRange, colorOut );
+                BasicShade( frame, nrml, colorOut );
+            } else if( material->widthsAndTypes[2] == 1.0f ) {
+                BasicColorFragAsSpace( ctx, frame, fragCoordX, fragCoordY, depth, colorOut );
+            } else {
+                BasicColorAsLines( subRegionRange, material->innerColor1, material->innerColor2, colorOut );
+                BasicShade( frame, nrml, colorOut );
+            }
+        } else {
+            memcpy( colorOut, material->innerBorderColor, sizeof( float ) * 4 );
+        }
+    } else {
+        float subRegionRange = minComponent / outerRange;
+        if( subRegionRange < outerBorderWidth ) {
+            if( material->widthsAndTypes[3] == 0.5f ) {
+                SoftwareMix( material->outerColor1, material->outerColor2, subRegionRange, colorOut );
+                BasicShade( frame, nrml, colorOut );
+            } else if( material->widthsAndTypes[3] == 1.0f ) {
+                BasicColorFragAsSpace( ctx, frame, fragCoordX, fragCoordY, depth, colorOut );
+            } else {
+                BasicColorAsLines( subRegionRange, material->outerColor1, material->outerColor2, colorOut );
+                BasicShade( frame, nrml, colorOut );
+            }
+        } else {
+            memcpy( colorOut, material->outerBorderColor, sizeof( float ) * 4 );
+        }
+    }
+
+    return true;
+}
+
+static SoftwareShaderDesc softwareShaders[] = {
+    {
+        "Basic.vert",
+        { { "position", 3 }, { "normal", 3 }, { "texCoord", 2 }, { "instanceModelMatrix", 16 }, { "instanceMaterialIndex", 1 } }, 5,
+        { }, 0,
+        { "spaceBG" }, 1,
+        { "FrameConstants", "MaterialConstants" }, { sizeof( SoftwareBasicFrameConstants ), sizeof( SoftwareBasicMaterial ) * 8 }, 2,
+        BASIC_SMOOTH_VARYING_COUNT, BASIC_VARYING_COUNT,
+        BasicVertexShader, BasicFragmentShader
+    }
+};
+
+/*------------------------------------------------------------------------------------------------------------------
+                                               Rasterization
+-------------------------------------------------------------------------------------------------------------------*/
+
+struct SoftwareDrawJob {
+    SoftwareShaderDesc* desc;
+    ShaderProgram* program;
+    ShaderProgramParams* params;
+    uint32* indices;
+    uint32 indexCount;
+    SoftwareTriangle* triangles;
+    uint32 triangleCount;
+    SoftwareRenderTarget* target;
+    uint32 tilesX;
+};
+
+static void SoftwareVertexJob( void* jobData, uint32 instanceIndex ) {
+    SoftwareDrawJob* draw = (SoftwareDrawJob*)jobData;
+    SoftwareShaderContext ctx = { draw->program, draw->params, instanceIndex };
+    SoftwareVertexOut* out = &softwareRenderer.vertexScratch[ instanceIndex * draw->indexCount ];
+    for( uint32 i = 0; i < draw->indexCount; ++i ) {
+        draw->desc->vertexShader( &ctx, draw->indices[i], out[i].clip, out[i].varyings );
+    }
+}
+
+///Top-left fill rule for counter clockwise triangles in y-up window coordinates
+static bool IsTopLeftEdge( float ax, float ay, float bx, float by ) {
+    float dx = bx - ax;
+    float dy = by - ay;
+    return ( dy == 0.0f && dx < 0.0f ) || dy < 0.0f;
+}
+
+static void SoftwareRasterTileJob( void* jobData, uint32 tileIndex ) {
+    SoftwareDrawJob* draw = (SoftwareDrawJob*)jobData;
+    SoftwareRenderTarget* target = draw->target;
+    int32 tileMinX = ( tileIndex % draw->tilesX ) * SOFTWARE_TILE_SIZE;
+    int32 tileMinY = ( tileIndex / draw->tilesX ) * SOFTWARE_TILE_SIZE;
+    int32 tileMaxX = tileMinX + SOFTWARE_TILE_SIZE - 1;
+    int32 tileMaxY = tileMinY + SOFTWARE_TILE_SIZE - 1;
+    if( tileMaxX >= target->width ) tileMaxX = target->width - 1;
+    if( tileMaxY >= target->height ) tileMaxY = target->height - 1;
+
+    uint8 varyingCount = draw->desc->varyingCount;
+    uint8 smoothCount = draw->desc->smoothVaryingCount;
+
+    //Triangles are walked in submission order so overlapping draws resolve the same way GL would
+    for( uint32 triIndex = 0; triIndex < draw->triangleCount; ++triIndex ) {
+        SoftwareTriangle* tri = &draw->triangles[ triIndex ];
+        int32 minX = ( tri->minX > tileMinX ) ? tri->minX : tileMinX;
+        int32 minY = ( tri->minY > tileMinY ) ? tri->minY : tileMinY;
+        int32 maxX = ( tri->maxX < tileMaxX ) ? tri->maxX : tileMaxX;
+        int32 maxY = ( tri->maxY < tileMaxY ) ? tri->maxY : tileMaxY;
+        if( minX > maxX || minY > maxY ) continue;
+
+        bool topLeft0 = IsTopLeftEdge( tri->x[1], tri->y[1], tri->x[2], tri->y[2] );
+        bool topLeft1 = IsTopLeftEdge( tri->x[2], tri->y[2], tri->x[0], tri->y[0] );
+        bool topLeft2 = IsTopLeftEdge( tri->x[0], tri->y[0], tri->x[1], tri->y[1] );
+        float invArea = 1.0f / tri->area;
+
+        //Flat varyings come from the last (provoking) vertex, same as GL's default
+        float varyings[ SOFTWARE_MAX_VARYINGS ];
+        memcpy( &varyings[ smoothCount ], &tri->verts[2]->varyings[ smoothCount ], sizeof( float ) * ( varyingCount - smoothCount ) );
+
+        for( int32 py = minY; py <= maxY; ++py ) {
+            for( int32 px = minX; px <= maxX; ++px ) {
+                float sampleX = (float)px + 0.5f;
+                float sampleY = (float)py + 0.5f;
+                float w0 = ( tri->x[2] - tri->x[1] ) * ( sampleY - tri->y[1] ) - ( tri->y[2] - tri->y[1] ) * ( sampleX - tri->x[1] );
+                float w1 = ( tri->x[0] - tri->x[2] ) * ( sampleY - tri->y[2] ) - ( tri->y[0] - tri->y[2] ) * ( sampleX - tri->x[2] );
+                float w2 = ( tri->x[1] - tri->x[0] ) * ( sampleY - tri->y[0] ) - ( tri->y[1] - tri->y[0] ) * ( sampleX - tri->x[0] );
+                if( w0 < 0.0f || ( w0 == 0.0f && !topLeft0 ) ) continue;
+                if( w1 < 0.0f || ( w1 == 0.0f && !topLeft1 ) ) continue;
+                if( w2 < 0.0f || ( w2 == 0.0f && !topLeft2 ) ) continue;
+
+                float b0 = w0 * invArea;
+                float b1 = w1 * invArea;
+                float b2 = w2 * invArea;
+                float depth = b0 * tri->z[0] + b1 * tri->z[1] + b2 * tri->z[2];
+                if( depth < 0.0f || depth > 1.0f ) continue;
+
+                //Perspective correct interpolation
+                float p0 = b0 * tri->invW[0];
+                float p1 = b1 * tri->invW[1];
+                float p2 = b2 * tri->invW[2];
+                float invSum = 1.0f / ( p0 + p1 + p2 );
+                p0 *= invSum; p1 *= invSum; p2 *= invSum;
+                for( uint8 v = 0; v < smoothCount; ++v ) {
+                    varyings[v] = p0 * tri->verts[0]->varyings[v] + p1 * tri->verts[1]->varyings[v] + p2 * tri->verts[2]->varyings[v];
+                }
+
+                float color[4];
+                SoftwareShaderContext ctx = { draw->program, draw->params, 0 };
+                if( !draw->desc->fragmentShader( &ctx, varyings, sampleX, sampleY, &depth, color ) ) continue;
+
+                uint32 pixelIndex = py * target->width + px;
+                if( target->depth != NULL ) {
+                    if( !( depth < target->depth[ pixelIndex ] ) ) continue;
+                    target->depth[ pixelIndex ] = depth;
+                }
+                if( target->color != NULL ) {
+                    uint8* pixel = &target->color[ pixelIndex * 4 ];
+                    for( uint8 channel = 0; channel < 4; ++channel ) {
+                        float c = color[ channel ];
+                        if( c < 0.0f ) c = 0.0f;
+                        if( c > 1.0f ) c = 1.0f;
+                        pixel[ channel ] = (uint8)( c * 255.0f + 0.5f );
+                    }
+                }
+            }
+        }
+    }
+}
+
+static void SoftwareDraw( ShaderProgram* programBinding, ShaderProgramParams* params, uint32 instanceCount ) {
+    if( programBinding->programID == 0 ) return;
+    SoftwareShaderDesc* desc = &softwareShaders[ programBinding->programID - 1 ];
+    SoftwareBuffer* indexBuffer = GetSoftwareBuffer( params->indexDataPtr );
+    SoftwareRenderTarget* target = softwareRenderer.currentTarget;
+    if( indexBuffer == NULL || target == NULL ) return;
+
+    SoftwareDrawJob draw;
+    draw.desc = desc;
+    draw.program = programBinding;
+    draw.params = params;
+    draw.indices = (uint32*)indexBuffer->data;
+    draw.indexCount = params->indiciesToDraw - ( params->indiciesToDraw % 3 );
+    draw.target = target;
+
+    uint32 vertexCount = draw.indexCount * instanceCount;
+    if( vertexCount > softwareRenderer.vertexScratchSize ) {
+        free( softwareRenderer.vertexScratch );
+        softwareRenderer.vertexScratch = (SoftwareVertexOut*)malloc( sizeof( SoftwareVertexOut ) * vertexCount );
+        softwareRenderer.vertexScratchSize = vertexCount;
+    }
+    if( vertexCount / 3 > softwareRenderer.triangleScratchSize ) {
+        free( softwareRenderer.triangleScratch );
+        softwareRenderer.triangleScratch = (SoftwareTriangle*)malloc( sizeof( SoftwareTriangle ) * ( vertexCount / 3 ) );
+        softwareRenderer.triangleScratchSize = vertexCount / 3;
+    }
+
+    SoftwareParallelFor( instanceCount, SoftwareVertexJob, &draw );
+
+    //Triangle setup, back faces and anything behind the eye are dropped here
+    draw.triangles = softwareRenderer.triangleScratch;
+    draw.triangleCount = 0;
+    for( uint32 vertexIndex = 0; vertexIndex < vertexCount; vertexIndex += 3 ) {
+        SoftwareTriangle* tri = &draw.triangles[ draw.triangleCount ];
+        bool behindEye = false;
+        for( uint8 corner = 0; corner < 3; ++corner ) {
+            SoftwareVertexOut* vert = &softwareRenderer.vertexScratch[ vertexIndex + corner ];
+            if( vert->clip[3] <= 0.0f ) {
+                behindEye = true;
+                break;
+            }
+            float invW = 1.0f / vert->clip[3];
+            tri->x[ corner ] = ( vert->clip[0] * invW * 0.5f + 0.5f ) * target->width;
+            tri->y[ corner ] = ( vert->clip[1] * invW * 0.5f + 0.5f ) * target->height;
+            tri->z[ corner ] = vert->clip[2] * invW * 0.5f + 0.5f;
+            tri->invW[ corner ] = invW;
+            tri->verts[ corner ] = vert;
+        }
+        if( behindEye ) continue;
+
+        tri->area = ( tri->x[1] - tri->x[0] ) * ( tri->y[2] - tri->y[0] ) - ( tri->y[1] - tri->y[0] ) * ( tri->x[2] - tri->x[0] );
+        if( tri->area <= 0.0f ) continue;
+
+        tri->minX = (int32)floorf( fminf( fminf( tri->x[0], tri->x[1] ), tri->x[2] ) );
+        tri->minY = (int32)floorf( fminf( fminf( tri->y[0], tri->y[1] ), tri->y[2] ) );
+        tri->maxX = (int32)ceilf( fmaxf( fmaxf( tri->x[0], tri->x[1] ), tri->x[2] ) );
+        tri->maxY = (int32)ceilf( fmaxf( fmaxf( tri->y[0], tri->y[1] ), tri->y[2] ) );
+        if( tri->maxX < 0 || tri->maxY < 0 || tri->minX >= target->width || tri->minY >= target->height ) continue;
+        draw.triangleCount++;
+    }
+    if( draw.triangleCount == 0 ) return;
+
+    draw.tilesX = ( target->width + SOFTWARE_TILE_SIZE - 1 ) / SOFTWARE_TILE_SIZE;
+    uint32 tilesY = ( target->height + SOFTWARE_TILE_SIZE - 1 ) / SOFTWARE_TILE_SIZE;
+    SoftwareParallelFor( draw.tilesX * tilesY, SoftwareRasterTileJob, &draw );
+}
+
+/*------------------------------------------------------------------------------------------------------------------
+                                          Renderer.h interface
+-------------------------------------------------------------------------------------------------------------------*/
+
+static uint32 CreateSoftwareBuffer( void* data, uint32 size ) {
+    assert( softwareRenderer.bufferCount < SOFTWARE_MAX_BUFFERS );
+    SoftwareBuffer* buffer = &softwareRenderer.buffers[ softwareRenderer.bufferCount++ ];
+    buffer->data = (uint8*)malloc( size );
+    buffer->size = size;
+    if( data != NULL ) {
+        memcpy( buffer->data, data, size );
+    } else {
+        memset( buffer->data, 0, size );
+    }
+    return softwareRenderer.bufferCount;
+}
+
+static void AllocateSoftwareRenderTarget( SoftwareRenderTarget* target, uint16 width, uint16 height, uint8* colorStorage, bool hasDepth ) {
+    target->width = width;
+    target->height = height;
+    target->color = colorStorage;
+    target->depth = hasDepth ? (float*)malloc( sizeof( float ) * width * height ) : NULL;
+}
+
+Framebuffer CreateFramebuffer( uint32 pixelWidth, uint32 pixelHeight, Framebuffer::FramebufferType type ) {
+    Framebuffer newFramebuffer = { };
+    newFramebuffer.type = type;
+    CreateEmptyTexture( &newFramebuffer.framebufferTexture, pixelWidth, pixelHeight );
+    CreateTextureBinding( &newFramebuffer.framebufferTexture, &newFramebuffer.textureBindingID );
+
+    assert( softwareRenderer.framebufferCount < SOFTWARE_MAX_FRAMEBUFFERS );
+    SoftwareRenderTarget* target = &softwareRenderer.framebufferTargets[ softwareRenderer.framebufferCount++ ];
+    uint8* colorStorage = ( type == Framebuffer::FramebufferType::COLOR ) ? newFramebuffer.framebufferTexture.data : NULL;
+    AllocateSoftwareRenderTarget( target, pixelWidth, pixelHeight, colorStorage, true );
+    newFramebuffer.framebufferPtr = softwareRenderer.framebufferCount;
+
+    return newFramebuffer;
+}
+
+void SetCurrentFramebuffer( Framebuffer* framebuffer ) {
+    if( framebuffer != NULL ) {
+        softwareRenderer.currentTarget = &softwareRenderer.framebufferTargets[ framebuffer->framebufferPtr - 1 ];
+    } else {
+        softwareRenderer.currentTarget = &softwareRenderer.screen;
+    }
+}
+
+void ClearCurrentFramebuffer() {
+    SoftwareRenderTarget* target = softwareRenderer.currentTarget;
+    uint32 pixelCount = target->width * target->height;
+    if( target->color != NULL ) {
+        uint8 clear[4];
+        for( uint8 channel = 0; channel < 4; ++channel ) {
+            clear[ channel ] = (uint8)( softwareRenderer.clearColor[ channel ] * 255.0f + 0.5f );
+        }
+        for( uint32 pixelIndex = 0; pixelIndex < pixelCount; ++pixelIndex ) {
+            memcpy( &target->color[ pixelIndex * 4 ], clear, 4 );
+        }
+    }
+    if( target->depth != NULL ) {
+        for( uint32 pixelIndex = 0; pixelIndex < pixelCount; ++pixelIndex ) {
+            target->depth[ pixelIndex ] = 1.0f;
+        }
+    }
+}
+
+void CreateTextureBinding( TextureData* texData, TextureBindingID* texBindID ) {
+    assert( softwareRenderer.textureCount < SOFTWARE_MAX_TEXTURES );
+    softwareRenderer.textures[ softwareRenderer.textureCount++ ] = *texData;
+    *texBindID = softwareRenderer.textureCount;
+}
+
+///Matches the program by its vertex shader's file name and fills in the same reflection data GL would give
+void CreateShaderProgram( const char* vertProgramFilePath, const char*, ShaderProgram* bindDataStorage ) {
+    memset( bindDataStorage, 0, sizeof( ShaderProgram ) );
+
+    SoftwareShaderDesc* desc = NULL;
+    uint32 shaderCount = sizeof( softwareShaders ) / sizeof( SoftwareShaderDesc );
+    for( uint32 shaderIndex = 0; shaderIndex < shaderCount; ++shaderIndex ) {
+        const char* fileName = softwareShaders[ shaderIndex ].vertProgramFileName;
+        size_t pathLen = strlen( vertProgramFilePath );
+        size_t fileNameLen = strlen( fileName );
+        if( pathLen >= fileNameLen && strcmp( vertProgramFilePath + pathLen - fileNameLen, fileName ) == 0 ) {
+            desc = &softwareShaders[ shaderIndex ];
+            bindDataStorage->programID = shaderIndex + 1;
+            break;
+        }
+    }
+    if( desc == NULL ) {
+        printf( "No software port of shader %s, draws with it will be skipped\n", vertProgramFilePath );
+        return;
+    }
+    printf( "Software shader program %s bound\n", vertProgramFilePath );
+
+    uint32 nameWriteTargetOffset = 0;
+    auto CopyName = [&]( const char* name ) -> char* {
+        char* nameWriteTarget = &bindDataStorage->nameBuffer[ nameWriteTargetOffset ];
+        size_t nameLen = strlen( name );
+        assert( nameWriteTargetOffset + nameLen + 1 <= 512 );
+        memcpy( nameWriteTarget, name, nameLen + 1 );
+        nameWriteTargetOffset += nameLen + 1;
+        return nameWriteTarget;
+    };
+
+    //Types hold float counts here rather than GL enums, only this backend reads them
+    for( uint8 inputIndex = 0; inputIndex < desc->vertexInputCount; ++inputIndex ) {
+        bindDataStorage->vertexInputNames[ inputIndex ] = CopyName( desc->vertexInputs[ inputIndex ].name );
+        bindDataStorage->vertexInputPtrs[ inputIndex ] = inputIndex;
+        bindDataStorage->vertexInputTypes[ inputIndex ] = desc->vertexInputs[ inputIndex ].floatCount;
+        InsertShaderName( bindDataStorage, bindDataStorage->vertexInputNames[ inputIndex ], SHADER_NAME_VERTEX_INPUT, inputIndex );
+        bindDataStorage->vertInputCount++;
+    }
+    for( uint8 uniformIndex = 0; uniformIndex < desc->uniformCount; ++uniformIndex ) {
+        bindDataStorage->uniformNames[ uniformIndex ] = CopyName( desc->uniformNames[ uniformIndex ] );
+        bindDataStorage->uniformPtrs[ uniformIndex ] = uniformIndex;
+        InsertShaderName( bindDataStorage, bindDataStorage->uniformNames[ uniformIndex ], SHADER_NAME_UNIFORM, uniformIndex );
+        bindDataStorage->uniformCount++;
+    }
+    for( uint8 samplerIndex = 0; samplerIndex < desc->samplerCount; ++samplerIndex ) {
+        bindDataStorage->samplerNames[ samplerIndex ] = CopyName( desc->samplerNames[ samplerIndex ] );
+        bindDataStorage->samplerPtrs[ samplerIndex ] = samplerIndex;
+        InsertShaderName( bindDataStorage, bindDataStorage->samplerNames[ samplerIndex ], SHADER_NAME_SAMPLER, samplerIndex );
+        bindDataStorage->samplerCount++;
+    }
+    for( uint8 blockIndex = 0; blockIndex < desc->uniformBlockCount; ++blockIndex ) {
+        bindDataStorage->uniformBlockNames[ blockIndex ] = CopyName( desc->uniformBlockNames[ blockIndex ] );
+        bindDataStorage->uniformBlockIndices[ blockIndex ] = blockIndex;
+        bindDataStorage->uniformBlockSizes[ blockIndex ] = desc->uniformBlockSizes[ blockIndex ];
+        InsertShaderName( bindDataStorage, bindDataStorage->uniformBlockNames[ blockIndex ], SHADER_NAME_UNIFORM_BLOCK, blockIndex );
+        bindDataStorage->uniformBlockCount++;
+    }
+}
+
+///Nothing to compile here, the sources are ignored and the program is matched by file name as usual
+void CreateShaderProgramFromSource( const char* vertProgramFilePath, const char*, const char* fragProgramFilePath, const char*, ShaderProgram* bindDataStorage ) {
+    CreateShaderProgram( vertProgramFilePath, fragProgramFilePath, bindDataStorage );
+}
+
+void CreateRenderBinding( MeshGeometryData* meshDataStorage, MeshGPUBinding* bindDataStorage, VertexBufferLayout layout ) {
+    uint32 dataCount = meshDataStorage->dataCount;
+    uint32 vertexCount = meshDataStorage->vertexCount;
+    bool includeBoneData = meshDataStorage->boneWeightData != NULL && meshDataStorage->boneIndexData != NULL;
+    bindDataStorage->hasBoneData = includeBoneData;
+    bindDataStorage->layout = layout;
+
+    if( layout == VERTEX_BUFFERS_INTERLEAVED ) {
+        InterleavedVertexFormat format = MakeInterleavedVertexFormat( includeBoneData );
+        uint32 bufferID = CreateSoftwareBuffer( NULL, vertexCount * format.stride );
+        InterleaveMeshData( meshDataStorage, &format, GetSoftwareBuffer( bufferID )->data );
+        bindDataStorage->format = format;
+        bindDataStorage->vertexDataPtr = bufferID;
+        bindDataStorage->nrmlDataPtr = bufferID;
+        bindDataStorage->uvDataPtr = bufferID;
+        bindDataStorage->boneWeightDataPtr = includeBoneData ? bufferID : 0;
+        bindDataStorage->boneIndexDataPtr = includeBoneData ? bufferID : 0;
+    } else {
+        memset( &bindDataStorage->format, 0, sizeof( InterleavedVertexFormat ) );
+        bindDataStorage->vertexDataPtr = CreateSoftwareBuffer( meshDataStorage->vData, vertexCount * sizeof( Vec3 ) );
+        bindDataStorage->nrmlDataPtr = CreateSoftwareBuffer( meshDataStorage->normalData, vertexCount * sizeof( Vec3 ) );
+        bindDataStorage->uvDataPtr = CreateSoftwareBuffer( meshDataStorage->uvData, vertexCount * 2 * sizeof( float ) );
+        bindDataStorage->boneWeightDataPtr = 0;
+        bindDataStorage->boneIndexDataPtr = 0;
+        if( includeBoneData ) {
+            bindDataStorage->boneWeightDataPtr = CreateSoftwareBuffer( meshDataStorage->boneWeightData, vertexCount * MAXBONESPERVERT * sizeof( float ) );
+            bindDataStorage->boneIndexDataPtr = CreateSoftwareBuffer( meshDataStorage->boneIndexData, vertexCount * MAXBONESPERVERT * sizeof( uint32 ) );
+        }
+    }
+
+    bindDataStorage->indexDataPtr = CreateSoftwareBuffer( meshDataStorage->iData, dataCount * sizeof( uint32 ) );
+    bindDataStorage->dataCount = dataCount;
+}
+
+///Buffer IDs are never reused, only the memory behind them goes back
+static void FreeSoftwareBuffer( uint32 bufferID ) {
+    SoftwareBuffer* buffer = GetSoftwareBuffer( bufferID );
+    if( buffer == NULL ) return;
+    free( buffer->data );
+    buffer->data = NULL;
+    buffer->size = 0;
+}
+
+void DestroyRenderBinding( MeshGPUBinding* bindDataStorage ) {
+    FreeSoftwareBuffer( bindDataStorage->vertexDataPtr );
+    if( bindDataStorage->layout != VERTEX_BUFFERS_INTERLEAVED ) {
+        FreeSoftwareBuffer( bindDataStorage->nrmlDataPtr );
+        FreeSoftwareBuffer( bindDataStorage->uvDataPtr );
+        FreeSoftwareBuffer( bindDataStorage->boneWeightDataPtr );
+        FreeSoftwareBuffer( bindDataStorage->boneIndexDataPtr );
+    }
+    FreeSoftwareBuffer( bindDataStorage->indexDataPtr );
+    memset( bindDataStorage, 0, sizeof( MeshGPUBinding ) );
+}
+
+void DestroyShaderParamSet( ShaderProgramParams* ) { }
+
+InstanceBuffer CreateInstanceBuffer( uint32 instanceSize, uint32 maxInstances ) {
+    InstanceBuffer instanceBuffer;
+    instanceBuffer.instanceSize = instanceSize;
+    instanceBuffer.maxInstances = maxInstances;
+    instanceBuffer.bufferPtr = CreateSoftwareBuffer( NULL, instanceSize * maxInstances );
+    return instanceBuffer;
+}
+
+void UpdateInstanceBuffer( InstanceBuffer* instanceBuffer, void* instanceData, uint32 instanceCount ) {
+    assert( instanceCount <= instanceBuffer->maxInstances );
+    memcpy( GetSoftwareBuffer( instanceBuffer->bufferPtr )->data, instanceData, instanceBuffer->instanceSize * instanceCount );
+}
+
+UniformBuffer CreateUniformBuffer( uint32 size, uint32 bindingPoint ) {
+    assert( bindingPoint < SOFTWARE_MAX_UNIFORM_BINDINGS );
+    UniformBuffer uniformBuffer;
+    uniformBuffer.size = size;
+    uniformBuffer.bindingPoint = bindingPoint;
+    uniformBuffer.bufferPtr = CreateSoftwareBuffer( NULL, size );
+    softwareRenderer.uniformBindings[ bindingPoint ] = uniformBuffer.bufferPtr;
+    return uniformBuffer;
+}
+
+void UpdateUniformBuffer( UniformBuffer* uniformBuffer, void* data, uint32 size ) {
+    assert( size <= uniformBuffer->size );
+    memcpy( GetSoftwareBuffer( uniformBuffer->bufferPtr )->data, data, size );
+}
+
+void SetUniformBlock( ShaderProgram* program, ShaderName blockName, UniformBuffer* uniformBuffer ) {
+    int32 blockIndex = FindShaderName( program, blockName.hash, SHADER_NAME_UNIFORM_BLOCK );
+    if( blockIndex < 0 ) {
+        printf( "Cannot find uniform block named: %s\n", blockName.str );
+        return;
+    }
+    program->uniformBlockBindings[ blockIndex ] = uniformBuffer->bindingPoint;
+}
+
+RendererStorage* InitRenderer( uint16 screen_w, uint16 screen_h, SlabSubsection_Stack* systemsMemory ) {
+    RendererStorage* rendererStorage = (RendererStorage*)AllocOnSubStack_Aligned( systemsMemory, sizeof( RendererStorage ), alignof( RendererStorage ) );
+    memset( rendererStorage, 0, sizeof( RendererStorage ) );
+
+    printf( "Renderer: Software rasterizer\n" );
+    StartSoftwareWorkers();
+
+    AllocateSoftwareRenderTarget( &softwareRenderer.screen, screen_w, screen_h, (uint8*)malloc( 4 * screen_w * screen_h ), true );
+    softwareRenderer.currentTarget = &softwareRenderer.screen;
+
+    //Same clear color the GL backend uses
+    softwareRenderer.clearColor[0] = 50.0f / 255.0f;
+    softwareRenderer.clearColor[1] = 15.0f / 255.0f;
+    softwareRenderer.clearColor[2] = 32.0f / 255.0f;
+    softwareRenderer.clearColor[3] = 1.0f;
+    ClearCurrentFramebuffer();
+
+    SetToIdentity( &rendererStorage->baseProjectionMatrix );
+    SetToIdentity( &rendererStorage->cameraTransform );
+
+    return rendererStorage;
+}
+
+void RenderBoundData( ShaderProgram* programBinding, ShaderProgramParams* params ) {
+    SoftwareDraw( programBinding, params, 1 );
+}
+
+void RenderBoundDataInstanced( ShaderProgram* programBinding, ShaderProgramParams* params, uint32 instanceCount ) {
+    if( instanceCount == 0 ) return;
+    SoftwareDraw( programBinding, params, instanceCount );
+}
+
+///No driver state to skip here, binds are counted the same way as the GL backend so the numbers stay comparable
+void SubmitRenderCommands( RenderCommandList* list ) {
+    SortRenderCommands( list );
+
+    uint32 currentProgram = 0;
+    ShaderProgramParams* currentParams = NULL;
+    TextureBindingID currentTextures[ MAX_SUPPORTED_TEX_SAMPLERS ] = { };
+    RenderStats* stats = &list->stats;
+
+    for( uint32 commandIndex = 0; commandIndex < list->commandCount; ++commandIndex ) {
+        RenderCommand* command = &list->commands[ commandIndex ];
+        ShaderProgram* programBinding = command->program;
+        ShaderProgramParams* params = command->params;
+
+        if( currentProgram != programBinding->programID ) {
+            currentProgram = programBinding->programID;
+            stats->programBindsIssued++;
+        } else {
+            stats->programBindsSkipped++;
+        }
+        if( currentParams != params ) {
+            currentParams = params;
+            stats->vertexBindsIssued++;
+        } else {
+            stats->vertexBindsSkipped++;
+        }
+        for( int samplerIndex = 0; samplerIndex < programBinding->samplerCount; ++samplerIndex ) {
+            if( currentTextures[ samplerIndex ] == params->samplerData[ samplerIndex ] ) {
+                stats->textureBindsSkipped++;
+            } else {
+                currentTextures[ samplerIndex ] = params->samplerData[ samplerIndex ];
+                stats->textureBindsIssued++;
+            }
+        }
+
+        SoftwareDraw( programBinding, params, ( command->instanceCount > 0 ) ? command->instanceCount : 1 );
+        stats->drawCalls++;
+    }
+
+    list->commandCount = 0;
+}
+
+void RenderTexturedQuad( RendererStorage*, TextureBindingID texture, float width, float height, float x, float y ) {
+    SoftwareRenderTarget* target = softwareRenderer.currentTarget;
+
+    //TexturedQuad.vert scales the unit quad then translates it, uv (0,0) is the top left corner
+    float minNDCX = -width + x, maxNDCX = width + x;
+    float minNDCY = -height + y, maxNDCY = height + y;
+    int32 minX = (int32)( ( minNDCX * 0.5f + 0.5f ) * target->width );
+    int32 maxX = (int32)( ( maxNDCX * 0.5f + 0.5f ) * target->width );
+    int32 minY = (int32)( ( minNDCY * 0.5f + 0.5f ) * target->height );
+    int32 maxY = (int32)( ( maxNDCY * 0.5f + 0.5f ) * target->height );
+    if( minX < 0 ) minX = 0;
+    if( minY < 0 ) minY = 0;
+    if( maxX > target->width ) maxX = target->width;
+    if( maxY > target->height ) maxY = target->height;
+
+    for( int32 py = minY; py < maxY; ++py ) {
+        for( int32 px = minX; px < maxX; ++px ) {
+            float ndcX = ( ( (float)px + 0.5f ) / target->width ) * 2.0f - 1.0f;
+            float ndcY = ( ( (float)py + 0.5f ) / target->height ) * 2.0f - 1.0f;
+            float u = ( ( ndcX - x ) / width + 1.0f ) * 0.5f;
+            float v = ( 1.0f - ( ndcY - y ) / height ) * 0.5f;
+
+            uint32 pixelIndex = py * target->width + px;
+            if( target->depth != NULL ) {
+                if( !( 0.5f < target->depth[ pixelIndex ] ) ) continue;
+                target->depth[ pixelIndex ] = 0.5f;
+            }
+
+            float color[4];
+            SoftwareSampleTexture( texture, u, v, color );
+            if( target->color != NULL ) {
+                uint8* pixel = &target->color[ pixelIndex * 4 ];
+                for( uint8 channel = 0; channel < 4; ++channel ) {
+                    pixel[ channel ] = (uint8)( color[ channel ] * 255.0f + 0.5f );
+                }
+            }
+        }
+    }
+}
+
+//Debug primitives are not ported, the GL versions of these are unfinished as well
+void RenderDebugCircle( RendererStorage*, Vec3, float, Vec3 ) { }
+void RenderDebugLines( RendererStorage*, float*, uint8, const Mat4&, Vec3 ) { }
+void RenderArmatureAsLines( RendererStorage*, Armature*, const Mat4&, Vec3 ) { }
+
+///The screen target as RGBA8, rows bottom to top
+uint8* GetSoftwareFramebufferPixels( uint16* width, uint16* height ) {
+    *width = softwareRenderer.screen.width;
+    *height = softwareRenderer.screen.height;
+    return softwareRenderer.screen.color;
+}
+
+///Binary PPM of the screen target, flipped so it reads top to bottom. Returns false if the file couldn't be written
+bool WriteSoftwareFramebufferToFile( const char* fileName ) {
+    FILE* file = fopen( fileName, "wb" );
+    if( file == NULL ) {
+        printf( "Could not open file %s\n", fileName );
+        return false;
+    }
+
+    SoftwareRenderTarget* screen = &softwareRenderer.screen;
+    fprintf( file, "P6\n%d %d\n255\n", screen->width, screen->height );
+    for( int32 row = screen->height - 1; row >= 0; --row ) {
+        for( int32 column = 0; column < screen->width; ++column ) {
+            fwrite( &screen->color[ ( row * screen->width + column ) * 4 ], 1, 3, file );
+        }
+    }
+    fclose( file );
+    return true;
+}
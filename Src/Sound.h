@@ -4,9 +4,17 @@ struct LoadedSound {
 	int32 sampleCount;
 	int32 channelCount;
 	int16* samples [2];
+	//Whole wave file as read from disk, samples point into it
+	void* fileData;
 };
 
-LoadedSound LoadWaveFile( char* filePath );
+LoadedSound LoadWaveFile( const char* filePath );
+
+///Frees the wave data and hands the slot back, stop any instances playing it first
+void FreeLoadedSound( Pool<LoadedSound>* pool, LoadedSound* sound ) {
+	FreeAssetMemory( sound->fileData );
+	FreeToPool( pool, sound );
+}
 
 struct SoundRenderBuffer {
 	int32 samplesPerSecond;
@@ -18,18 +26,33 @@ struct SoundRenderBuffer {
 struct PlayingSound {
 	LoadedSound* baseSound;
 	uint32 lastPlayLocation;
+	PlayingSound* next;
 };
 
-PlayingSound* QueueLoadedSound( LoadedSound* sound, PlayingSound* activeSoundList ) {
-	for( uint8 soundIndex = 0; soundIndex < MAXSOUNDSATONCE; ++soundIndex ) {
-		if( activeSoundList[ soundIndex ].baseSound == NULL ) {
-			activeSoundList[ soundIndex ].baseSound = sound;
-			activeSoundList[ soundIndex ].lastPlayLocation = 0;
-			return &activeSoundList[ soundIndex ];
-		}
-	}
+///Sounds currently mixing, slots come from the pool and go back once the sound finishes
+struct ActiveSoundList {
+	Pool<PlayingSound> pool;
+	PlayingSound* first;
+};
+
+ActiveSoundList CreateActiveSoundList( SlabSubsection_Stack* allocater ) {
+	ActiveSoundList list;
+	list.pool = CreatePool<PlayingSound>( allocater, MAXSOUNDSATONCE );
+	list.first = NULL;
+	return list;
+}
 
-	return NULL;
+///Returns NULL if MAXSOUNDSATONCE sounds are already playing
+PlayingSound* QueueLoadedSound( LoadedSound* sound, ActiveSoundList* activeSoundList ) {
+	PlayingSound* playing = AllocFromPool( &activeSoundList->pool );
+	if( playing == NULL ) {
+		return NULL;
+	}
+	playing->baseSound = sound;
+	playing->lastPlayLocation = 0;
+	playing->next = activeSoundList->first;
+	activeSoundList->first = playing;
+	return playing;
 }
 
 void OutputTestTone( SoundRenderBuffer* srb, int hz = 440, int volume = 3000 ) {
@@ -52,32 +75,151 @@ void OutputTestTone( SoundRenderBuffer* srb, int hz = 440, int volume = 3000 ) {
 	}
 }
 
-void MixSound( SoundRenderBuffer* srb, PlayingSound* activeSoundList ) {
-	for( uint8 soundIndex = 0; soundIndex < MAXSOUNDSATONCE; ++soundIndex ) {
-		if( activeSoundList[ soundIndex ].baseSound != NULL ) {
-			PlayingSound* activeSound = &activeSoundList[ soundIndex ];
+void MixSound( SoundRenderBuffer* srb, ActiveSoundList* activeSoundList ) {
+	PlayingSound** link = &activeSoundList->first;
+	while( *link != NULL ) {
+		PlayingSound* activeSound = *link;
 
-			uint32 samplesToWrite = srb->samplesToWrite / 2;
-			uint32 samplesLeftInSound = activeSound->baseSound->sampleCount - activeSound->lastPlayLocation;
-			if( samplesLeftInSound < samplesToWrite ) {
-				samplesToWrite = samplesLeftInSound;
-			}
-			for( int32 sampleIndex = 0; sampleIndex < samplesToWrite; ++sampleIndex ) {
-				int16 value = activeSound->baseSound->samples[0][ ( sampleIndex + activeSound->lastPlayLocation ) ];
+		uint32 samplesToWrite = srb->samplesToWrite / 2;
+		uint32 samplesLeftInSound = activeSound->baseSound->sampleCount - activeSound->lastPlayLocation;
+		if( samplesLeftInSound < samplesToWrite ) {
+			samplesToWrite = samplesLeftInSound;
+		}
+		for( int32 sampleIndex = 0; sampleIndex < samplesToWrite; ++sampleIndex ) {
+			int16 value = activeSound->baseSound->samples[0][ ( sampleIndex + activeSound->lastPlayLocation ) ];
+
+			int32 i = sampleIndex * 2;
+
+	        srb->samples[ i ] += value;     //Left Channel
+	        srb->samples[ i + 1 ] += value; //Right Channel
+	    }
+	    activeSound->lastPlayLocation += samplesToWrite;
+
+		//Finished sounds unlink themselves and give their slot back
+		if( activeSound->lastPlayLocation >= activeSound->baseSound->sampleCount ) {
+			*link = activeSound->next;
+			FreeToPool( &activeSoundList->pool, activeSound );
+		} else {
+			link = &activeSound->next;
+		}
+	}
+}
+
+LoadedSound LoadWaveFile( const char* filePath ) {
+	#pragma pack( push, 1 )
+	struct WaveHeader{
+		uint32 RIFFID;
+		uint32 size;
+		uint32 WAVEID;
+	};
+
+    #define RIFF_CODE( a, b, c, d ) ( ( (uint32)(a) << 0 ) | ( (uint32)(b) << 8 ) | ( (uint32)(c) << 16 ) | ( (uint32)(d) << 24 ) )
+	enum {
+		WAVE_ChunkID_fmt = RIFF_CODE( 'f', 'm', 't', ' ' ),
+		WAVE_ChunkID_data = RIFF_CODE( 'd', 'a', 't', 'a' ),
+		WAVE_ChunkID_RIFF = RIFF_CODE( 'R', 'I', 'F', 'F' ),
+		WAVE_ChunkID_WAVE = RIFF_CODE( 'W', 'A', 'V', 'E' )
+	};
+
+	struct WaveChunk {
+		uint32 ID;
+		uint32 size;
+	};
+
+	struct Wave_fmt {
+		uint16 wFormatTag;
+		uint16 nChannels;
+		uint32 nSamplesPerSec;
+		uint32 nAvgBytesPerSec;
+		uint16 nBlockAlign;
+		uint16 wBitsPerSample;
+		uint16 cbSize;
+		uint16 wValidBitsPerSample;
+		uint32 dwChannelMask;
+		uint8 SubFormat [8];
+	};
+    #pragma pack( pop )
+
+	LoadedSound result = { };
+
+	int64 bytesRead = 0;
+	void* fileData = ReadWholeFile( filePath, &bytesRead );
+
+	if( bytesRead > 0 ) {
+		struct RiffIterator {
+			uint8* currentByte;
+			uint8* stop;
+		};
 
-				int32 i = sampleIndex * 2;
+		auto ParseChunkAt = []( WaveHeader* header, void* stop ) -> RiffIterator {
+			return { (uint8*)header, (uint8*)stop };
+		};
+		auto IsValid = []( RiffIterator iter ) -> bool  {
+			return iter.currentByte < iter.stop;
+		};
+		auto NextChunk = []( RiffIterator iter ) -> RiffIterator {
+			WaveChunk* chunk = (WaveChunk*)iter.currentByte;
+			//This is for alignment: ( ptr + ( targetalignment - 1 ) & ~( targetalignment - 1)) aligns ptr with the correct bit padding
+			uint32 size = ( chunk->size + 1 ) & ~1;
+			iter.currentByte += sizeof( WaveChunk ) + size;
+			return iter;
+		};
+		auto GetChunkData = []( RiffIterator iter ) -> void* {
+			void* result = ( iter.currentByte  + sizeof( WaveChunk ) );
+			return result;
+		};
+		auto GetType = []( RiffIterator iter ) -> uint32 {
+			WaveChunk* chunk = (WaveChunk*)iter.currentByte;
+			uint32 result = chunk->ID;
+			return result;
+		};
+		auto GetChunkSize = []( RiffIterator iter) -> uint32 {
+			WaveChunk* chunk = (WaveChunk*)iter.currentByte;
+			uint32 result = chunk->size;
+			return result;
+		};
 
-		        srb->samples[ i ] += value;     //Left Channel
-		        srb->samples[ i + 1 ] += value; //Right Channel
-		    }
-		    activeSound->lastPlayLocation += samplesToWrite;
+		WaveHeader* header = (WaveHeader*)fileData;
+		assert( header->RIFFID == WAVE_ChunkID_RIFF );
+		assert( header->WAVEID == WAVE_ChunkID_WAVE );
 
-			if( activeSound->lastPlayLocation >= activeSound->baseSound->sampleCount ) {
-				activeSound->baseSound = NULL;
-				activeSound->lastPlayLocation = 0;
+		uint32 channelCount = 0;
+		uint32 sampleDataSize = 0;
+		void* sampleData = 0;
+		for( RiffIterator iter = ParseChunkAt( header + 1, (uint8*)( header + 1 ) + header->size - 4 ); 
+			IsValid( iter ); iter = NextChunk( iter ) ) {
+			switch( GetType( iter ) ) {
+				case WAVE_ChunkID_fmt: {
+					Wave_fmt* fmt = (Wave_fmt*)GetChunkData( iter );
+					assert( fmt->wFormatTag == 1 ); //NOTE: only supporting PCM
+					assert( fmt->nSamplesPerSec == 48000 );
+					assert( fmt->wBitsPerSample == 16 );
+					channelCount = fmt->nChannels;
+				}break;
+				case WAVE_ChunkID_data: {
+					sampleData = GetChunkData( iter );
+					sampleDataSize = GetChunkSize( iter );
+				}break;
 			}
 		}
+
+		assert( sampleData != 0 );
+
+		result.fileData = fileData;
+		result.sampleCount = sampleDataSize / ( channelCount * sizeof( uint16 ) );
+		result.channelCount = channelCount;
+
+		if( channelCount == 1 ) {
+			result.samples[0] = (int16*)sampleData;
+			result.samples[1] = 0;
+		} else if( channelCount == 2 ) {
+
+		} else {
+			assert(false);
+		}
 	}
+	
+	return result;
 }
 
 #ifdef WIN32_ENTRY
@@ -98,7 +240,7 @@ struct SoundSystemStorage {
 	uint64 runningSampleIndex;
 	DWORD bytesToWrite, byteToLock;
 
-	PlayingSound* activeSounds;
+	ActiveSoundList activeSounds;
 	SoundRenderBuffer srb;
 };
 
@@ -167,9 +309,7 @@ SoundSystemStorage* Win32InitSound( HWND hwnd, int targetGameHZ, SlabSubsection_
 			soundSystemStorage->srb.samples = (int16*)malloc( BufferSize );
 			memset( soundSystemStorage->srb.samples, 0, BufferSize );
 
-			size_t playingInfoBufferSize = sizeof( PlayingSound ) * MAXSOUNDSATONCE;
-			soundSystemStorage->activeSounds = (PlayingSound*)malloc( playingInfoBufferSize );
-			memset( soundSystemStorage->activeSounds, 0, playingInfoBufferSize );
+			soundSystemStorage->activeSounds = CreateActiveSoundList( systemStorage );
 
 			HRESULT playResult = soundSystemStorage->writeBuffer->Play( 0, 0, DSBPLAY_LOOPING );
 			if( !SUCCEEDED( playResult ) ) {
@@ -243,7 +383,7 @@ void PushAudioToSoundCard( SoundSystemStorage* soundSystemStorage ) {
 	}
 
 	//Mix together currently playing sounds
-	MixSound( &soundSystemStorage->srb, soundSystemStorage->activeSounds );
+	MixSound( &soundSystemStorage->srb, &soundSystemStorage->activeSounds );
 
 	//Push mixed sounds to the actual card
 	VOID* region0;
@@ -291,119 +431,30 @@ void PushAudioToSoundCard( SoundSystemStorage* soundSystemStorage ) {
 	}
 }
 
-LoadedSound LoadWaveFile( char* filePath ) {
-	#pragma pack( push, 1 )
-	struct WaveHeader{
-		uint32 RIFFID;
-		uint32 size;
-		uint32 WAVEID;
-	};
+#endif //WIN32 specific implementation
 
-    #define RIFF_CODE( a, b, c, d ) ( ( (uint32)(a) << 0 ) | ( (uint32)(b) << 8 ) | ( (uint32)(c) << 16 ) | ( (uint32)(d) << 24 ) )
-	enum {
-		WAVE_ChunkID_fmt = RIFF_CODE( 'f', 'm', 't', ' ' ),
-		WAVE_ChunkID_data = RIFF_CODE( 'd', 'a', 't', 'a' ),
-		WAVE_ChunkID_RIFF = RIFF_CODE( 'R', 'I', 'F', 'F' ),
-		WAVE_ChunkID_WAVE = RIFF_CODE( 'W', 'A', 'V', 'E' )
-	};
-
-	struct WaveChunk {
-		uint32 ID;
-		uint32 size;
-	};
-
-	struct Wave_fmt {
-		uint16 wFormatTag;
-		uint16 nChannels;
-		uint32 nSamplesPerSec;
-		uint32 nAvgBytesPerSec;
-		uint16 nBlockAlign;
-		uint16 wBitsPerSample;
-		uint16 cbSize;
-		uint16 wValidBitsPerSample;
-		uint32 dwChannelMask;
-		uint8 SubFormat [8];
-	};
-    #pragma pack( pop )
-
-	LoadedSound result = { };
-
-	int64 bytesRead = 0;
-	void* fileData = ReadWholeFile( filePath, &bytesRead );
-
-	if( bytesRead > 0 ) {
-		struct RiffIterator {
-			uint8* currentByte;
-			uint8* stop;
-		};
-
-		auto ParseChunkAt = []( WaveHeader* header, void* stop ) -> RiffIterator {
-			return { (uint8*)header, (uint8*)stop };
-		};
-		auto IsValid = []( RiffIterator iter ) -> bool  {
-			return iter.currentByte < iter.stop;
-		};
-		auto NextChunk = []( RiffIterator iter ) -> RiffIterator {
-			WaveChunk* chunk = (WaveChunk*)iter.currentByte;
-			//This is for alignment: ( ptr + ( targetalignment - 1 ) & ~( targetalignment - 1)) aligns ptr with the correct bit padding
-			uint32 size = ( chunk->size + 1 ) & ~1;
-			iter.currentByte += sizeof( WaveChunk ) + size;
-			return iter;
-		};
-		auto GetChunkData = []( RiffIterator iter ) -> void* {
-			void* result = ( iter.currentByte  + sizeof( WaveChunk ) );
-			return result;
-		};
-		auto GetType = []( RiffIterator iter ) -> uint32 {
-			WaveChunk* chunk = (WaveChunk*)iter.currentByte;
-			uint32 result = chunk->ID;
-			return result;
-		};
-		auto GetChunkSize = []( RiffIterator iter) -> uint32 {
-			WaveChunk* chunk = (WaveChunk*)iter.currentByte;
-			uint32 result = chunk->size;
-			return result;
-		};
-
-		WaveHeader* header = (WaveHeader*)fileData;
-		assert( header->RIFFID == WAVE_ChunkID_RIFF );
-		assert( header->WAVEID == WAVE_ChunkID_WAVE );
-
-		uint32 channelCount = 0;
-		uint32 sampleDataSize = 0;
-		void* sampleData = 0;
-		for( RiffIterator iter = ParseChunkAt( header + 1, (uint8*)( header + 1 ) + header->size - 4 ); 
-			IsValid( iter ); iter = NextChunk( iter ) ) {
-			switch( GetType( iter ) ) {
-				case WAVE_ChunkID_fmt: {
-					Wave_fmt* fmt = (Wave_fmt*)GetChunkData( iter );
-					assert( fmt->wFormatTag == 1 ); //NOTE: only supporting PCM
-					assert( fmt->nSamplesPerSec == 48000 );
-					assert( fmt->wBitsPerSample == 16 );
-					channelCount = fmt->nChannels;
-				}break;
-				case WAVE_ChunkID_data: {
-					sampleData = GetChunkData( iter );
-					sampleDataSize = GetChunkSize( iter );
-				}break;
-			}
-		}
-
-		assert( sampleData != 0 );
-
-		result.sampleCount = sampleDataSize / ( channelCount * sizeof( uint16 ) );
-		result.channelCount = channelCount;
+#ifdef LINUX_ENTRY
+//Headless, there's no audio device. Sounds are still mixed every frame so they advance and finish on time
+struct SoundSystemStorage {
+	int32 samplesPerFrame;
+	ActiveSoundList activeSounds;
+	SoundRenderBuffer srb;
+};
 
-		if( channelCount == 1 ) {
-			result.samples[0] = (int16*)sampleData;
-			result.samples[1] = 0;
-		} else if( channelCount == 2 ) {
+SoundSystemStorage* LinuxInitSound( int targetGameHZ, SlabSubsection_Stack* systemStorage ) {
+	const int32 SamplesPerSecond = 48000;
+	SoundSystemStorage* soundSystemStorage = (SoundSystemStorage*)AllocOnSubStack_Aligned( systemStorage, sizeof( SoundSystemStorage ), 8 );
+	soundSystemStorage->samplesPerFrame = SamplesPerSecond / targetGameHZ;
+	soundSystemStorage->activeSounds = CreateActiveSoundList( systemStorage );
+	soundSystemStorage->srb.samplesPerSecond = SamplesPerSecond;
+	//Stereo, samplesToWrite counts both channels like the Win32 buffer does
+	soundSystemStorage->srb.samplesToWrite = soundSystemStorage->samplesPerFrame * 2;
+	soundSystemStorage->srb.samples = (int16*)AllocAssetMemory( sizeof( int16 ) * soundSystemStorage->srb.samplesToWrite );
+	return soundSystemStorage;
+}
 
-		} else {
-			assert(false);
-		}
-	}
-	
-	return result;
+void PushAudioToSoundCard( SoundSystemStorage* soundSystemStorage ) {
+	memset( soundSystemStorage->srb.samples, 0, sizeof( int16 ) * soundSystemStorage->srb.samplesToWrite );
+	MixSound( &soundSystemStorage->srb, &soundSystemStorage->activeSounds );
 }
-#endif //WIN32 specific implementation
\ No newline at end of file
+#endif //LINUX specific implementation
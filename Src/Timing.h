@@ -0,0 +1,271 @@
+#ifndef TIMING_H
+#define TIMING_H
+
+/*------------------------------------------------------------------------------------------------------------------
+												Fixed Step Clock
+    The platform feeds in real elapsed time, the game updates in whole fixed steps and renders with the leftover
+    fraction of a step so motion stays smooth at any render rate. Kept in integer nanoseconds so a render rate
+    that divides evenly into the step rate always takes the same number of steps
+-------------------------------------------------------------------------------------------------------------------*/
+
+#ifndef SIMULATION_HZ
+	#define SIMULATION_HZ 120
+#endif
+//Longest frame the clock will catch up on, anything past it is dropped instead of spiralling (debugger, window drag)
+#define MAX_CATCHUP_NANOSECONDS 250000000LL
+
+struct FixedStepClock {
+	int64 stepNanoseconds;
+	int64 accumulator;
+	uint32 stepsThisFrame;
+	uint64 totalSteps;
+	//Time thrown away by the catch up limit
+	int64 droppedNanoseconds;
+};
+
+FixedStepClock CreateFixedStepClock( uint32 simulationHZ ) {
+	assert( simulationHZ > 0 );
+	FixedStepClock clock = { };
+	clock.stepNanoseconds = 1000000000LL / simulationHZ;
+	return clock;
+}
+
+///Call once per loop iteration with the real time since the last call
+void AdvanceFixedStepClock( FixedStepClock* clock, int64 elapsedNanoseconds ) {
+	if( elapsedNanoseconds < 0 ) {
+		elapsedNanoseconds = 0;
+	}
+	if( elapsedNanoseconds > MAX_CATCHUP_NANOSECONDS ) {
+		clock->droppedNanoseconds += elapsedNanoseconds - MAX_CATCHUP_NANOSECONDS;
+		elapsedNanoseconds = MAX_CATCHUP_NANOSECONDS;
+	}
+	clock->accumulator += elapsedNanoseconds;
+	clock->stepsThisFrame = 0;
+}
+
+///True while there is a whole step left to simulate, meant to drive a while loop around Update
+bool TakeFixedStep( FixedStepClock* clock ) {
+	if( clock->accumulator < clock->stepNanoseconds ) {
+		return false;
+	}
+	clock->accumulator -= clock->stepNanoseconds;
+	clock->stepsThisFrame++;
+	clock->totalSteps++;
+	return true;
+}
+
+float GetFixedStepMilliseconds( const FixedStepClock* clock ) {
+	return (float)( (double)clock->stepNanoseconds / 1000000.0 );
+}
+
+///How far between the previous and current simulation state the render should be, 0 to 1
+float GetInterpolationAlpha( const FixedStepClock* clock ) {
+	return (float)( (double)clock->accumulator / (double)clock->stepNanoseconds );
+}
+
+/*------------------------------------------------------------------------------------------------------------------
+												Frame Pacer
+    Holds the loop to a target rate against absolute deadlines. Sleeps on a high resolution timer until a little
+    before the deadline, then spins the rest, since OS sleeps routinely wake a millisecond or two late.
+    A frame that runs past its deadline starts a fresh schedule instead of rushing the next ones to catch up
+-------------------------------------------------------------------------------------------------------------------*/
+
+#ifndef FRAME_PACER_SPIN_NANOSECONDS
+	//How far ahead of the deadline the sleep hands over to spinning
+	#define FRAME_PACER_SPIN_NANOSECONDS 1000000LL
+#endif
+//Waking later than this past a deadline counts as an oversleep in the stats
+#define FRAME_PACER_OVERSLEEP_NANOSECONDS 250000LL
+
+struct FramePacerStats {
+	uint64 frames;
+	//Frames whose work alone ran past the deadline
+	uint64 missedDeadlines;
+	int64 worstMiss;
+	//Frames where the wait itself woke late
+	uint64 oversleeps;
+	int64 worstOversleep;
+	int64 totalWaitNanoseconds;
+	int64 totalSpinNanoseconds;
+};
+
+struct FramePacer {
+	int64 periodNanoseconds;
+	int64 spinNanoseconds;
+	int64 nextDeadline;
+	FramePacerStats stats;
+#ifdef WIN32_ENTRY
+	HANDLE waitableTimer;
+	bool timerIsHighResolution;
+#endif
+};
+
+#if defined( WIN32_ENTRY )
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+	#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+int64 GetMonotonicNanoseconds() {
+	static LARGE_INTEGER ticksPerSecond;
+	if( ticksPerSecond.QuadPart == 0 ) {
+		QueryPerformanceFrequency( &ticksPerSecond );
+	}
+	LARGE_INTEGER now;
+	QueryPerformanceCounter( &now );
+	//Split so the multiply can't overflow however long the machine has been up
+	int64 seconds = now.QuadPart / ticksPerSecond.QuadPart;
+	int64 remainder = now.QuadPart % ticksPerSecond.QuadPart;
+	return seconds * 1000000000LL + ( remainder * 1000000000LL ) / ticksPerSecond.QuadPart;
+}
+
+static void InitPacerTimer( FramePacer* pacer ) {
+	//High resolution timers need Windows 10 1803, older systems get a regular timer with the 1ms scheduler period
+	pacer->waitableTimer = CreateWaitableTimerExW( NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS );
+	pacer->timerIsHighResolution = pacer->waitableTimer != NULL;
+	if( !pacer->timerIsHighResolution ) {
+		timeBeginPeriod( 1 );
+		pacer->waitableTimer = CreateWaitableTimerExW( NULL, NULL, 0, TIMER_ALL_ACCESS );
+	}
+	assert( pacer->waitableTimer != NULL );
+}
+
+static void SleepUntil( FramePacer* pacer, int64 wakeTime ) {
+	int64 nanoseconds = wakeTime - GetMonotonicNanoseconds();
+	if( nanoseconds <= 0 ) return;
+	//Negative due time is relative, in 100ns units
+	LARGE_INTEGER dueTime;
+	dueTime.QuadPart = -( nanoseconds / 100 );
+	if( SetWaitableTimerEx( pacer->waitableTimer, &dueTime, 0, NULL, NULL, NULL, 0 ) ) {
+		WaitForSingleObject( pacer->waitableTimer, INFINITE );
+	}
+}
+
+static inline void SpinPause() {
+	YieldProcessor();
+}
+
+void DestroyFramePacer( FramePacer* pacer ) {
+	CloseHandle( pacer->waitableTimer );
+	if( !pacer->timerIsHighResolution ) {
+		timeEndPeriod( 1 );
+	}
+	pacer->waitableTimer = NULL;
+}
+
+#elif defined( LINUX_ENTRY )
+#include <time.h>
+#include <errno.h>
+
+int64 GetMonotonicNanoseconds() {
+	timespec now;
+	clock_gettime( CLOCK_MONOTONIC, &now );
+	return (int64)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+static void InitPacerTimer( FramePacer* ) { }
+
+static void SleepUntil( FramePacer*, int64 wakeTime ) {
+	//Absolute wake time, so being interrupted and going back to sleep doesn't drift
+	timespec request;
+	request.tv_sec = wakeTime / 1000000000LL;
+	request.tv_nsec = wakeTime % 1000000000LL;
+	while( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &request, NULL ) == EINTR ) { }
+}
+
+static inline void SpinPause() {
+#if defined( __x86_64__ ) || defined( __i386__ )
+	__builtin_ia32_pause();
+#endif
+}
+
+void DestroyFramePacer( FramePacer* ) { }
+
+#else
+#include <chrono>
+#include <thread>
+
+//No platform layer, the standard library clock and sleep with no resolution guarantees
+int64 GetMonotonicNanoseconds() {
+	return (int64)std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+static void InitPacerTimer( FramePacer* ) { }
+
+static void SleepUntil( FramePacer*, int64 wakeTime ) {
+	int64 nanoseconds = wakeTime - GetMonotonicNanoseconds();
+	if( nanoseconds > 0 ) {
+		std::this_thread::sleep_for( std::chrono::nanoseconds( nanoseconds ) );
+	}
+}
+
+static inline void SpinPause() { }
+
+void DestroyFramePacer( FramePacer* ) { }
+
+#endif
+
+void SetFramePacerRate( FramePacer* pacer, uint32 targetHZ ) {
+	assert( targetHZ > 0 );
+	pacer->periodNanoseconds = 1000000000LL / targetHZ;
+	pacer->nextDeadline = GetMonotonicNanoseconds() + pacer->periodNanoseconds;
+}
+
+FramePacer CreateFramePacer( uint32 targetHZ, int64 spinNanoseconds = FRAME_PACER_SPIN_NANOSECONDS ) {
+	FramePacer pacer = { };
+	pacer.spinNanoseconds = spinNanoseconds;
+	InitPacerTimer( &pacer );
+	SetFramePacerRate( &pacer, targetHZ );
+	return pacer;
+}
+
+///Blocks until the current frame's deadline, call once at the end of every loop iteration
+void WaitForNextFrame( FramePacer* pacer ) {
+	FramePacerStats* stats = &pacer->stats;
+	stats->frames++;
+
+	int64 now = GetMonotonicNanoseconds();
+	if( now > pacer->nextDeadline ) {
+		int64 miss = now - pacer->nextDeadline;
+		stats->missedDeadlines++;
+		if( miss > stats->worstMiss ) stats->worstMiss = miss;
+		pacer->nextDeadline = now + pacer->periodNanoseconds;
+		return;
+	}
+
+	int64 waitStart = now;
+	int64 sleepUntil = pacer->nextDeadline - pacer->spinNanoseconds;
+	if( sleepUntil > now ) {
+		SleepUntil( pacer, sleepUntil );
+	}
+	int64 spinStart = GetMonotonicNanoseconds();
+	now = spinStart;
+	while( now < pacer->nextDeadline ) {
+		SpinPause();
+		now = GetMonotonicNanoseconds();
+	}
+	stats->totalSpinNanoseconds += now - spinStart;
+	stats->totalWaitNanoseconds += now - waitStart;
+
+	int64 oversleep = now - pacer->nextDeadline;
+	if( oversleep > FRAME_PACER_OVERSLEEP_NANOSECONDS ) {
+		stats->oversleeps++;
+		if( oversleep > stats->worstOversleep ) stats->worstOversleep = oversleep;
+	}
+	pacer->nextDeadline += pacer->periodNanoseconds;
+}
+
+void PrintFramePacerStats( const FramePacer* pacer ) {
+	const FramePacerStats* stats = &pacer->stats;
+	printf( "Pacer: %llu frames at %.3f ms, %llu missed (worst %.3f ms late), %llu oversleeps (worst %.3f ms)\n",
+		(unsigned long long)stats->frames, (double)pacer->periodNanoseconds / 1000000.0,
+		(unsigned long long)stats->missedDeadlines, (double)stats->worstMiss / 1000000.0,
+		(unsigned long long)stats->oversleeps, (double)stats->worstOversleep / 1000000.0 );
+	if( stats->frames > 0 ) {
+		printf( "Pacer: average wait %.3f ms, %.3f ms of it spinning\n",
+			(double)stats->totalWaitNanoseconds / (double)stats->frames / 1000000.0,
+			(double)stats->totalSpinNanoseconds / (double)stats->frames / 1000000.0 );
+	}
+}
+
+#endif
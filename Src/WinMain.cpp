@@ -7,23 +7,23 @@
 #include <assert.h>
 #include <functional>
 
-#include "tinyxml2/tinyxml2.h"
-#include "tinyxml2/tinyxml2.cpp"
-
 #define GLEW_STATIC
 #include "OpenGL/glew.h"
 
+#include "App.h"
+
+//Decoded images and stb's own scratch come out of the asset heap
+#define STBI_MALLOC( size ) AllocAssetMemory( size )
+#define STBI_REALLOC( ptr, newSize ) ReallocAssetMemory( ptr, newSize )
+#define STBI_FREE( ptr ) FreeAssetMemory( ptr )
 #define STB_IMAGE_IMPLEMENTATION
 #define STBI_ONLY_PNG
 #include "stb/stb_image.h"
 
-#include "App.h"
 #include "..\App.cpp"
 
 //Win32 function prototypes, allows the entry point to be the first function
 static LRESULT CALLBACK WndProc( HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam );
-//A helper function only to be used in this file ( so far )
-static void TextToNumberConversion( char* textIn, float* numbersOut );
 
 static struct {
 	HINSTANCE appInstance;
@@ -49,7 +49,10 @@ static struct {
 		bool specialButtonLeft, specialButtonRight;
 	} controllerState;
 
-	int64 mSecsPerFrame;
+	uint32 targetFrameHZ;
+	uint32 simulationHZ;
+	FrameArena frameArena;
+	SlabHeap assetHeap;
 } appInfo;
 
 static int APIENTRY WinMain( HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow ) {
@@ -65,7 +68,8 @@ static int APIENTRY WinMain( HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR
 
 	appInfo.running = true;
 	appInfo.isFullScreen = false;
-	appInfo.mSecsPerFrame = 16; //60FPS
+	appInfo.targetFrameHZ = 60;
+	appInfo.simulationHZ = SIMULATION_HZ;
 
 	appInfo.wc.cbSize = sizeof(WNDCLASSEX);
 	appInfo.wc.style = CS_OWNDC;
@@ -138,15 +142,17 @@ static int APIENTRY WinMain( HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR
 
 	glewInit();
 
-	MemorySlab gameSlab;
-	gameSlab.slabSize = MEGABYTES( RESERVED_SPACE );
-	gameSlab.slabStart = VirtualAlloc( NULL, gameSlab.slabSize, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE );
+	//Only address space up front, pages get committed as subsections are carved
+	MemorySlab gameSlab = ReserveMemorySlab( MEGABYTES( RESERVED_SPACE ) );
 	assert( gameSlab.slabStart != NULL );
-	gameSlab.current = gameSlab.slabStart;
+	appInfo.frameArena = CreateFrameArena( &gameSlab, FRAME_ARENA_SIZE );
+	appInfo.assetHeap = CreateSlabHeap( &gameSlab, ASSET_HEAP_SIZE );
+
+	StartAssetLoadWorkers();
 
-	SlabSubsection_Stack systemsMemory = CarveNewSubsection( &gameSlab, KILOBYTES( 12 ) );
-	SlabSubsection_Stack gameMemoryStack = CarveNewSubsection( &gameSlab, sizeof( GameMemory ) * 2 );
-	void* gMemPtr = AllocOnSubStack_Aligned( &gameMemoryStack, sizeof( GameMemory ) );
+	SlabSubsection_Stack systemsMemory = CarveNewSubsection( &gameSlab, KILOBYTES( 12 ), "Systems" );
+	SlabSubsection_Stack gameMemoryStack = CarveNewSubsection( &gameSlab, sizeof( GameMemory ) * 2, "Game Memory" );
+	void* gMemPtr = AllocOnSubStack_Aligned( &gameMemoryStack, sizeof( GameMemory ), alignof( GameMemory ) );
 
 	SoundSystemStorage* soundSystemStorage = Win32InitSound( appInfo.hwnd, 60, &systemsMemory );
 	RendererStorage* renderSystemStorage = InitRenderer( SCREEN_WIDTH, SCREEN_HEIGHT, &systemsMemory );
@@ -158,7 +164,12 @@ static int APIENTRY WinMain( HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR
 	BOOL canSupportHiResTimer = QueryPerformanceFrequency( &appInfo.timerResolution );
 	assert( canSupportHiResTimer );
 
-	GameInit( &gameSlab, gMemPtr, renderSystemStorage );
+	GameInit( &gameSlab, gMemPtr, renderSystemStorage, &appInfo.frameArena );
+	PrintMemoryReport();
+
+	FixedStepClock simClock = CreateFixedStepClock( appInfo.simulationHZ );
+	FramePacer framePacer = CreateFramePacer( appInfo.targetFrameHZ );
+	int64 startTime = GetMonotonicNanoseconds();
 
 	MSG Msg;
 	do {
@@ -167,12 +178,14 @@ static int APIENTRY WinMain( HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR
 			DispatchMessage( &Msg );
 		}
 
-		static LARGE_INTEGER startTime;
-		LARGE_INTEGER lastTime = startTime;
-		QueryPerformanceCounter( &startTime );
+		int64 lastTime = startTime;
+		startTime = GetMonotonicNanoseconds();
+		AdvanceFixedStepClock( &simClock, startTime - lastTime );
 
 		//GAME LOOP
 		if(appInfo.running) {
+			ResetFrameArena( &appInfo.frameArena );
+
 			XINPUT_STATE state;
 			DWORD queryResult;
 			memset( &state, 0, sizeof( XINPUT_STATE ) ) ;
@@ -198,33 +211,23 @@ static int APIENTRY WinMain( HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR
 				appInfo.controllerState = { };
 			}
 
-			LARGE_INTEGER elapsedTime;
-			elapsedTime.QuadPart = startTime.QuadPart - lastTime.QuadPart;
-			elapsedTime.QuadPart *= 1000;
-			elapsedTime.QuadPart /= appInfo.timerResolution.QuadPart;
-
-			appInfo.running = Update( gMemPtr, (float)elapsedTime.QuadPart, &soundSystemStorage->srb, soundSystemStorage->activeSounds );
-			Render( gMemPtr, renderSystemStorage );
+			while( appInfo.running && TakeFixedStep( &simClock ) ) {
+				appInfo.running = Update( gMemPtr, GetFixedStepMilliseconds( &simClock ), &soundSystemStorage->activeSounds );
+			}
+			Render( gMemPtr, renderSystemStorage, GetInterpolationAlpha( &simClock ) );
 
 		    PushAudioToSoundCard( soundSystemStorage );
 
 			SwapBuffers( appInfo.deviceContext );
-			glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
-		}
-
-		LARGE_INTEGER endTime, computeTime;
-		QueryPerformanceCounter( &endTime );
-		computeTime.QuadPart = endTime.QuadPart - startTime.QuadPart;
-		computeTime.QuadPart *= 1000;
-		computeTime.QuadPart /= appInfo.timerResolution.QuadPart;
-		if( computeTime.QuadPart <= appInfo.mSecsPerFrame ) {
-			Sleep(appInfo.mSecsPerFrame - computeTime.QuadPart );
-		} else {
-			printf("Didn't sleep, compute was %ld\n", computeTime.QuadPart );
+			ClearCurrentFramebuffer();
 		}
 
+		WaitForNextFrame( &framePacer );
 	} while( appInfo.running );
 
+	PrintFramePacerStats( &framePacer );
+	DestroyFramePacer( &framePacer );
+
 	FreeConsole();
 
 	return Msg.wParam;
@@ -291,7 +294,7 @@ float GetTriggerState( uint8 triggerIndex ) {
 }
 
 #include <strsafe.h>
-void* ReadWholeFile( char* filename, int64* bytesRead ) {
+void* ReadWholeFile( const char* filename, int64* bytesRead ) {
 	//Open
 	HANDLE fileHandle;
 	//TODO: look into other options, such as: Overlapped, No_Bufffering, and Random_Access
@@ -310,9 +313,9 @@ void* ReadWholeFile( char* filename, int64* bytesRead ) {
 
 	//Reserve Space
 	void* data = 0;
-	data = malloc( fileSize.QuadPart );
-	memset( data, 0, fileSize.QuadPart );
+	data = AllocAssetMemory( fileSize.QuadPart );
 	assert( data != 0 );
+	memset( data, 0, fileSize.QuadPart );
 
 	//Read data
 	DWORD dataRead = 0;
@@ -330,6 +333,69 @@ void* ReadWholeFile( char* filename, int64* bytesRead ) {
 	return data;
 }
 
+void* MapWholeFile( const char* filename, int64* bytesMapped ) {
+	*bytesMapped = 0;
+	HANDLE fileHandle = CreateFile( filename, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0 );
+	if( fileHandle == INVALID_HANDLE_VALUE ) {
+		return NULL;
+	}
+	LARGE_INTEGER fileSize;
+	if( !GetFileSizeEx( fileHandle, &fileSize ) || fileSize.QuadPart == 0 ) {
+		CloseHandle( fileHandle );
+		return NULL;
+	}
+	//Copy on write view, the view keeps the mapping and file alive after the handles close
+	HANDLE mappingHandle = CreateFileMapping( fileHandle, NULL, PAGE_WRITECOPY, 0, 0, NULL );
+	void* data = NULL;
+	if( mappingHandle != NULL ) {
+		data = MapViewOfFile( mappingHandle, FILE_MAP_COPY, 0, 0, 0 );
+		CloseHandle( mappingHandle );
+	}
+	CloseHandle( fileHandle );
+	if( data == NULL ) {
+		printf( "Could not map %s\n", filename );
+		return NULL;
+	}
+	*bytesMapped = fileSize.QuadPart;
+	return data;
+}
+
+void UnmapWholeFile( void* data, int64 bytesMapped ) {
+	UnmapViewOfFile( data );
+}
+
+bool WriteWholeFile( const char* filename, const void* data, int64 bytes ) {
+	char tempName[ MAX_PATH ];
+	if( FAILED( StringCchPrintf( tempName, MAX_PATH, "%s.tmp", filename ) ) ) {
+		printf( "Path too long to write: %s\n", filename );
+		return false;
+	}
+	assert( bytes <= 0xFFFFFFFF );
+	HANDLE fileHandle = CreateFile( tempName, GENERIC_WRITE, 0, 0, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, 0 );
+	if( fileHandle == INVALID_HANDLE_VALUE ) {
+		printf( "Could not create file %s\n", tempName );
+		return false;
+	}
+	DWORD dataWritten = 0;
+	BOOL writeSuccess = WriteFile( fileHandle, data, (DWORD)bytes, &dataWritten, 0 );
+	CloseHandle( fileHandle );
+
+	if( !writeSuccess || dataWritten != bytes || !MoveFileEx( tempName, filename, MOVEFILE_REPLACE_EXISTING ) ) {
+		printf( "Could not write %s\n", filename );
+		DeleteFile( tempName );
+		return false;
+	}
+	return true;
+}
+
+int64 GetFileModifiedTime( const char* filename ) {
+	WIN32_FILE_ATTRIBUTE_DATA fileInfo;
+	if( !GetFileAttributesEx( filename, GetFileExInfoStandard, &fileInfo ) ) {
+		return 0;
+	}
+	return ( (int64)fileInfo.ftLastWriteTime.dwHighDateTime << 32 ) | fileInfo.ftLastWriteTime.dwLowDateTime;
+}
+
 /*----------------------------------------------------------------------------------------
                        Renderer.h function prototype implementations
 -----------------------------------------------------------------------------------------*/
@@ -343,7 +409,7 @@ char* ReadShaderSrcFileFromDisk( const char* fileName ) {
     }
     fseek( file, 0, SEEK_END );
     size_t fileSize = ftell( file );
-    char* buffer = (char*)malloc( fileSize + 1 );
+    char* buffer = (char*)AllocAssetMemory( fileSize + 1 );
     memset( buffer, 0, fileSize + 1 );
 
     fseek( file, 0, SEEK_SET );
@@ -352,443 +418,7 @@ char* ReadShaderSrcFileFromDisk( const char* fileName ) {
     return buffer;
 }
 
-void LoadMeshDataFromDisk( const char* fileName,  SlabSubsection_Stack* allocater, MeshGeometryData* storage, Armature* armature ) {
-	tinyxml2::XMLDocument colladaDoc;
-	colladaDoc.LoadFile( fileName );
-	//if( colladaDoc == NULL ) {
-		//printf( "Could not load mesh: %s\n", fileName );
-		//return;
-	//}
-
-	tinyxml2::XMLElement* meshNode = colladaDoc.FirstChildElement( "COLLADA" )->FirstChildElement( "library_geometries" )
-	->FirstChildElement( "geometry" )->FirstChildElement( "mesh" );
-
-	char* colladaTextBuffer = NULL;
-	size_t textBufferLen = 0;
-
-	uint16 vCount = 0;
-	uint16 nCount = 0;
-	uint16 uvCount = 0;
-	uint16 indexCount = 0;
-	float* rawColladaVertexData;
-	float* rawColladaNormalData;
-	float* rawColladaUVData;
-	float* rawIndexData;
-	///Basic Mesh Geometry Data
-	{
-		tinyxml2::XMLNode* colladaVertexArray = meshNode->FirstChildElement( "source" );
-		tinyxml2::XMLElement* vertexFloatArray = colladaVertexArray->FirstChildElement( "float_array" );
-		tinyxml2::XMLNode* colladaNormalArray = colladaVertexArray->NextSibling();
-		tinyxml2::XMLElement* normalFloatArray = colladaNormalArray->FirstChildElement( "float_array" );
-		tinyxml2::XMLNode* colladaUVMapArray = colladaNormalArray->NextSibling();
-		tinyxml2::XMLElement* uvMapFloatArray = colladaUVMapArray->FirstChildElement( "float_array" );
-		tinyxml2::XMLElement* meshSrc = meshNode->FirstChildElement( "polylist" );
-		tinyxml2::XMLElement* colladaIndexArray = meshSrc->FirstChildElement( "p" );
-
-		int count;
-		const char* colladaVertArrayVal = vertexFloatArray->FirstChild()->Value();
-		vertexFloatArray->QueryAttribute( "count", &count );
-		vCount = count;
-		const char* colladaNormArrayVal = normalFloatArray->FirstChild()->Value();
-		normalFloatArray->QueryAttribute( "count", &count );
-		nCount = count;
-		const char* colladaUVMapArrayVal = uvMapFloatArray->FirstChild()->Value();
-		uvMapFloatArray->QueryAttribute( "count", &count );
-		uvCount = count;
-		const char* colladaIndexArrayVal = colladaIndexArray->FirstChild()->Value();
-		meshSrc->QueryAttribute( "count", &count );
-		//Assume this is already triangulated
-		indexCount = count * 3 * 3;
-
-		///TODO: replace this with fmaxf?
-		std::function< size_t (size_t, size_t) > sizeComparison = []( size_t size1, size_t size2 ) -> size_t {
-			if( size1 >= size2 ) return size1;
-			return size2;
-		};
-
-		textBufferLen = strlen( colladaVertArrayVal );
-		textBufferLen = sizeComparison( strlen( colladaNormArrayVal ), textBufferLen );
-		textBufferLen = sizeComparison( strlen( colladaUVMapArrayVal ), textBufferLen );
-		textBufferLen = sizeComparison( strlen( colladaIndexArrayVal ), textBufferLen );
-		colladaTextBuffer = (char*)alloca( textBufferLen );
-		memset( colladaTextBuffer, 0, textBufferLen );
-		rawColladaVertexData = (float*)alloca( sizeof(float) * vCount );
-		rawColladaNormalData = (float*)alloca( sizeof(float) * nCount );
-		rawColladaUVData = (float*)alloca( sizeof(float) * uvCount );
-		rawIndexData = (float*)alloca( sizeof(float) * indexCount );
-
-		memset( rawColladaVertexData, 0, sizeof(float) * vCount );
-		memset( rawColladaNormalData, 0, sizeof(float) * nCount );
-		memset( rawColladaUVData, 0, sizeof(float) * uvCount );
-		memset( rawIndexData, 0, sizeof(float) * indexCount );
-
-		//Reading Vertex position data
-		strcpy( colladaTextBuffer, colladaVertArrayVal );
-		TextToNumberConversion( colladaTextBuffer, rawColladaVertexData );
-
-	    //Reading Normals data
-		memset( colladaTextBuffer, 0, textBufferLen );
-		strcpy( colladaTextBuffer, colladaNormArrayVal );
-		TextToNumberConversion( colladaTextBuffer, rawColladaNormalData );
-
-	    //Reading UV map data
-		memset( colladaTextBuffer, 0, textBufferLen );
-		strcpy( colladaTextBuffer, colladaUVMapArrayVal );
-		TextToNumberConversion( colladaTextBuffer, rawColladaUVData );
-
-	    //Reading index data
-		memset( colladaTextBuffer, 0, textBufferLen );
-		strcpy( colladaTextBuffer, colladaIndexArrayVal );
-		TextToNumberConversion( colladaTextBuffer, rawIndexData );
-	}
-
-	float* rawBoneWeightData = NULL;
-	float* rawBoneIndexData = NULL;
-	//Skinning Data
-	{
-		tinyxml2::XMLElement* libControllers = colladaDoc.FirstChildElement( "COLLADA" )->FirstChildElement( "library_controllers" );
-		if( libControllers == NULL ) goto skinningExit;
-		tinyxml2::XMLElement* controllerElement = libControllers->FirstChildElement( "controller" );
-		if( controllerElement == NULL ) goto skinningExit;
-
-		tinyxml2::XMLNode* vertexWeightDataArray = controllerElement->FirstChild()->FirstChild()->NextSibling()->NextSibling()->NextSibling();
-		tinyxml2::XMLNode* vertexBoneIndexDataArray = vertexWeightDataArray->NextSibling()->NextSibling();
-		tinyxml2::XMLNode* vCountArray = vertexBoneIndexDataArray->FirstChildElement( "vcount" );
-		tinyxml2::XMLNode* vArray = vertexBoneIndexDataArray->FirstChildElement( "v" );
-		const char* boneWeightsData = vertexWeightDataArray->FirstChild()->FirstChild()->Value();
-		const char* vCountArrayData = vCountArray->FirstChild()->Value();
-		const char* vArrayData = vArray->FirstChild()->Value();
-
-		float* colladaBoneWeightData = NULL;
-		float* colladaBoneIndexData = NULL;
-		float* colladaBoneInfluenceCounts = NULL;
-		///This is overkill, Collada stores ways less data usually, plus this still doesn't account for very complex models 
-		///(e.g, lots of verts with more than MAXBONESPERVERT influencing position )
-		colladaBoneWeightData = (float*)alloca( sizeof(float) * MAXBONESPERVERT * vCount );
-		colladaBoneIndexData = (float*)alloca( sizeof(float) * MAXBONESPERVERT * vCount );
-		colladaBoneInfluenceCounts = (float*)alloca( sizeof(float) * MAXBONESPERVERT * vCount );
-
-		//Read bone weights data
-		memset( colladaTextBuffer, 0, textBufferLen );
-		strcpy( colladaTextBuffer, boneWeightsData );
-		TextToNumberConversion( colladaTextBuffer, colladaBoneWeightData );
-
-		//Read bone index data
-		memset( colladaTextBuffer, 0, textBufferLen );
-		strcpy( colladaTextBuffer, vArrayData );
-		TextToNumberConversion( colladaTextBuffer, colladaBoneIndexData );
-
-		//Read bone influence counts
-		memset( colladaTextBuffer, 0, textBufferLen );
-		strcpy( colladaTextBuffer, vCountArrayData );
-		TextToNumberConversion( colladaTextBuffer, colladaBoneInfluenceCounts );
-
-		rawBoneWeightData = (float*)alloca( sizeof(float) * MAXBONESPERVERT * vCount );
-		rawBoneIndexData = (float*)alloca( sizeof(float) * MAXBONESPERVERT * vCount );
-		memset( rawBoneWeightData, 0, sizeof(float) * MAXBONESPERVERT * vCount );
-		memset( rawBoneIndexData, 0, sizeof(float) * MAXBONESPERVERT * vCount );
-
-		int colladaIndexIndirection = 0;
-		int verticiesInfluenced = 0;
-		vCountArray->Parent()->ToElement()->QueryAttribute( "count", &verticiesInfluenced );
-		for( uint16 i = 0; i < verticiesInfluenced; i++ ) {
-			uint8 influenceCount = colladaBoneInfluenceCounts[i];
-			for( uint16 j = 0; j < influenceCount; j++ ) {
-				uint16 boneIndex = colladaBoneIndexData[ colladaIndexIndirection++ ];
-				uint16 weightIndex = colladaBoneIndexData[ colladaIndexIndirection++ ];
-				rawBoneWeightData[ i * MAXBONESPERVERT + j ] = colladaBoneWeightData[ weightIndex ];
-				rawBoneIndexData[ i * MAXBONESPERVERT + j ] = boneIndex;
-			}
-		}
-	}
-	skinningExit:
-
-	//Armature
-	if( armature != NULL ) {
-		tinyxml2::XMLElement* visualScenesNode = colladaDoc.FirstChildElement( "COLLADA" )->FirstChildElement( "library_visual_scenes" )
-		->FirstChildElement( "visual_scene" )->FirstChildElement( "node" );
-		tinyxml2::XMLElement* armatureNode = NULL;
-
-		//Step through scene heirarchy until start of armature is found
-		while( visualScenesNode != NULL ) {
-			if( visualScenesNode->FirstChildElement( "node" ) != NULL && 
-				visualScenesNode->FirstChildElement( "node" )->Attribute( "type", "JOINT" ) != NULL ) {
-				armatureNode = visualScenesNode;
-			    break;
-			} else {
-				visualScenesNode = visualScenesNode->NextSibling()->ToElement();
-			}
-		}
-		if( armatureNode == NULL ) return;
-
-		//Parsing basic bone data from XML
-		std::function< Bone* ( tinyxml2::XMLElement*, Armature*, Bone*  ) > ParseColladaBoneData = 
-		[&]( tinyxml2::XMLElement* boneElement, Armature* armature, Bone* parentBone ) -> Bone* {
-			Bone* bone = &armature->bones[ armature->boneCount ];
-			bone->parent = parentBone;
-			bone->currentTransform = &armature->boneTransforms[ armature->boneCount ];
-			SetToIdentity( bone->currentTransform );
-			bone->boneIndex = armature->boneCount;
-			armature->boneCount++;
-
-			strcpy( &bone->name[0], boneElement->Attribute( "sid" ) );
-
-			float matrixData[16];
-			char matrixTextData [512];
-			tinyxml2::XMLNode* matrixElement = boneElement->FirstChildElement("matrix");
-			strcpy( &matrixTextData[0], matrixElement->FirstChild()->ToText()->Value() );
-			TextToNumberConversion( matrixTextData, matrixData );
-			//Note: this is only local transform data, but its being saved in bind matrix for now
-			Mat4 m;
-			memcpy( &m.m[0][0], &matrixData[0], sizeof(float) * 16 );
-			bone->bindPose = TransposeMatrix( m );
-
-			if( parentBone == NULL ) {
-				armature->rootBone = bone;
-			} else {
-				bone->bindPose = MultMatrix( parentBone->bindPose, bone->bindPose );
-			}
-
-			bone->childCount = 0;
-			tinyxml2::XMLElement* childBoneElement = boneElement->FirstChildElement( "node" );
-			while( childBoneElement != NULL ) {
-				Bone* childBone = ParseColladaBoneData( childBoneElement, armature, bone );
-				bone->children[ bone->childCount++ ] = childBone;
-				tinyxml2::XMLNode* siblingNode = childBoneElement->NextSibling();
-				if( siblingNode != NULL ) {
-					childBoneElement = siblingNode->ToElement();
-				} else {
-					childBoneElement = NULL;
-				}
-			};
-
-			return bone;
-		};
-		armature->boneCount = 0;
-		tinyxml2::XMLElement* boneElement = armatureNode->FirstChildElement( "node" );
-		ParseColladaBoneData( boneElement, armature, NULL );
-
-		//Parse inverse bind pose data from skinning section of XML
-		{
-			tinyxml2::XMLElement* boneNamesSource = colladaDoc.FirstChildElement( "COLLADA" )->FirstChildElement( "library_controllers" )
-			->FirstChildElement( "controller" )->FirstChildElement( "skin" )->FirstChildElement( "source" );
-			tinyxml2::XMLElement* boneBindPoseSource = boneNamesSource->NextSibling()->ToElement();
-
-			char* boneNamesLocalCopy = NULL;
-			float* boneMatriciesData = (float*)alloca( sizeof(float) * 16 * armature->boneCount );
-			const char* boneNameArrayData = boneNamesSource->FirstChild()->FirstChild()->Value();
-			const char* boneMatrixTextData = boneBindPoseSource->FirstChild()->FirstChild()->Value();
-			size_t nameDataLen = strlen( boneNameArrayData );
-			size_t matrixDataLen = strlen( boneMatrixTextData );
-			boneNamesLocalCopy = (char*)alloca( nameDataLen + 1 );
-			memset( boneNamesLocalCopy, 0, nameDataLen + 1 );
-			assert( textBufferLen > matrixDataLen );
-			memcpy( boneNamesLocalCopy, boneNameArrayData, nameDataLen );
-			memcpy( colladaTextBuffer, boneMatrixTextData, matrixDataLen );
-			TextToNumberConversion( colladaTextBuffer, boneMatriciesData );
-			char* nextBoneName = &boneNamesLocalCopy[0];
-			for( uint8 matrixIndex = 0; matrixIndex < armature->boneCount; matrixIndex++ ) {
-				Mat4 matrix;
-				memcpy( &matrix.m[0], &boneMatriciesData[matrixIndex * 16], sizeof(float) * 16 );
-
-				char boneName [32];
-				char* boneNameEnd = nextBoneName;
-				do {
-					boneNameEnd++;
-				} while( *boneNameEnd != ' ' && *boneNameEnd != 0 );
-				size_t charCount = boneNameEnd - nextBoneName;
-				memset( boneName, 0, sizeof( char ) * 32 );
-				memcpy( boneName, nextBoneName, charCount );
-				nextBoneName = boneNameEnd + 1;
-
-				Bone* targetBone = NULL;
-				for( uint8 boneIndex = 0; boneIndex < armature->boneCount; boneIndex++ ) {
-					Bone* bone = &armature->bones[ boneIndex ];
-					if( strcmp( bone->name, boneName ) == 0 ) {
-						targetBone = bone;
-						break;
-					}
-				}
-
-				Mat4 correction;
-				correction.m[0][0] = 1.0f; correction.m[0][1] = 0.0f; correction.m[0][2] = 0.0f; correction.m[0][3] = 0.0f;
-				correction.m[1][0] = 0.0f; correction.m[1][1] = 0.0f; correction.m[1][2] = 1.0f; correction.m[1][3] = 0.0f;
-				correction.m[2][0] = 0.0f; correction.m[2][1] = -1.0f; correction.m[2][2] = 0.0f; correction.m[2][3] = 0.0f;
-				correction.m[3][0] = 0.0f; correction.m[3][1] = 0.0f; correction.m[3][2] = 0.0f; correction.m[3][3] = 1.0f;
-				targetBone->invBindPose = TransposeMatrix( matrix );
-				targetBone->invBindPose = MultMatrix( correction, targetBone->invBindPose );
-			}
-		}
-	}
-
-	//output to my version of storage
-	storage->dataCount = 0;
-	uint16 counter = 0;
-
-	const uint32 vertCount = indexCount / 3;
-	storage->vData = (Vec3*)AllocOnSubStack_Aligned( allocater, vertCount * sizeof( Vec3 ), 16 );
-	storage->uvData = (float*)AllocOnSubStack_Aligned( allocater, vertCount * 2 * sizeof( float ), 4 );
-	storage->normalData = (Vec3*)AllocOnSubStack_Aligned( allocater, vertCount * sizeof( Vec3 ), 4 );
-	storage->iData = (uint32*)AllocOnSubStack_Aligned( allocater, vertCount * sizeof( uint32 ), 4 );
-	if( rawBoneWeightData != NULL ) {
-		storage->boneWeightData = (float*)AllocOnSubStack_Aligned( allocater, sizeof(float) * vertCount * MAXBONESPERVERT, 4 );
-		storage->boneIndexData = (uint32*)AllocOnSubStack_Aligned( allocater, sizeof(uint32) * vertCount * MAXBONESPERVERT, 4 );
-	} else {
-		storage->boneWeightData = NULL;
-		storage->boneIndexData = NULL;
-	}
-
-	while( counter < indexCount ) {
-		Vec3 v, n;
-		float uv_x, uv_y;
-
-		uint16 vertIndex = rawIndexData[ counter++ ];
-		uint16 normalIndex = rawIndexData[ counter++ ];
-		uint16 uvIndex = rawIndexData[ counter++ ];
-
-		v.x = rawColladaVertexData[ vertIndex * 3 + 0 ];
-		v.z = -rawColladaVertexData[ vertIndex * 3 + 1 ];
-		v.y = rawColladaVertexData[ vertIndex * 3 + 2 ];
-
-		n.x = rawColladaNormalData[ normalIndex * 3 + 0 ];
-		n.z = -rawColladaNormalData[ normalIndex * 3 + 1 ];
-		n.y = rawColladaNormalData[ normalIndex * 3 + 2 ];
-
-		uv_x = rawColladaUVData[ uvIndex * 2 ];
-		uv_y = rawColladaUVData[ uvIndex * 2 + 1 ];
-
-		///TODO: check for exact copies of data, use to index to first instance instead
-		uint32 storageIndex = storage->dataCount;
-		storage->vData[ storageIndex ] = v;
-		storage->normalData[ storageIndex ] = n;
-		storage->uvData[ storageIndex * 2 ] = uv_x;
-		storage->uvData[ storageIndex * 2 + 1 ] = uv_y;
-		if( rawBoneWeightData != NULL ) {
-			uint16 boneDataIndex = storage->dataCount * MAXBONESPERVERT;
-			uint16 boneVertexIndex = vertIndex * MAXBONESPERVERT;
-			for( uint8 i = 0; i < MAXBONESPERVERT; i++ ) {
-				storage->boneWeightData[ boneDataIndex + i ] = rawBoneWeightData[ boneVertexIndex + i ];
-				storage->boneIndexData[ boneDataIndex + i ] = rawBoneIndexData[ boneVertexIndex + i ];
-			}
-		}
-		storage->iData[ storageIndex ] = storageIndex;
-		storage->dataCount++;
-	};
-}
-
-void LoadAnimationDataFromCollada( const char* fileName, ArmatureKeyFrame* keyframe, Armature* armature ) {
-	tinyxml2::XMLDocument colladaDoc;
-	colladaDoc.LoadFile( fileName );
-
-	tinyxml2::XMLNode* animationNode = colladaDoc.FirstChildElement( "COLLADA" )->FirstChildElement( "library_animations" )->FirstChild();
-	while( animationNode != NULL ) {
-		//Desired data: what bone, and what local transform to it occurs
-		Mat4 boneLocalTransform;
-		Bone* targetBone = NULL;
-
-		//Parse the target attribute from the XMLElement for channel, and get the bone it corresponds to
-		const char* transformName = animationNode->FirstChildElement( "channel" )->Attribute( "target" );
-		size_t nameLen = strlen( transformName );
-		char* transformNameCopy = (char*)alloca( nameLen );
-		strcpy( transformNameCopy, transformName );
-		char* nameEnd = transformNameCopy;
-		while( *nameEnd != '/' && *nameEnd != 0 ) {
-			nameEnd++;
-		}
-		memset( transformNameCopy, 0, nameLen );
-		nameLen = nameEnd - transformNameCopy;
-		memcpy( transformNameCopy, transformName, nameLen );
-		for( uint8 boneIndex = 0; boneIndex < armature->boneCount; boneIndex++ ) {
-			if( strcmp( armature->bones[ boneIndex ].name, transformNameCopy ) == 0 ) {
-				targetBone = &armature->bones[ boneIndex ];
-				break;
-			}
-		}
-
-		//Parse matrix data, and extract first keyframe data
-		tinyxml2::XMLNode* transformMatrixElement = animationNode->FirstChild()->NextSibling();
-		const char* matrixTransformData = transformMatrixElement->FirstChild()->FirstChild()->Value();
-		size_t transformDataLen = strlen( matrixTransformData ) + 1;
-		char* transformDataCopy = (char*)alloca( transformDataLen * sizeof( char ) );
-		memset( transformDataCopy, 0, transformDataLen );
-		memcpy( transformDataCopy, matrixTransformData, transformDataLen );
-		int count = 0; 
-		transformMatrixElement->FirstChildElement()->QueryAttribute( "count", &count );
-		float* rawTransformData = (float*)alloca(  count * sizeof(float) );
-		memset( rawTransformData, 0, count * sizeof(float) );
-		TextToNumberConversion( transformDataCopy, rawTransformData );
-		memcpy( &boneLocalTransform.m[0][0], &rawTransformData[0], 16 * sizeof(float) );
-
-		//Save data in BoneKeyFrame struct
-		boneLocalTransform = TransposeMatrix( boneLocalTransform );
-		if( targetBone == armature->rootBone ) {
-			Mat4 correction;
-			correction.m[0][0] = 1.0f; correction.m[0][1] = 0.0f; correction.m[0][2] = 0.0f; correction.m[0][3] = 0.0f;
-			correction.m[1][0] = 0.0f; correction.m[1][1] = 0.0f; correction.m[1][2] = -1.0f; correction.m[1][3] = 0.0f;
-			correction.m[2][0] = 0.0f; correction.m[2][1] = 1.0f; correction.m[2][2] = 0.0f; correction.m[2][3] = 0.0f;
-			correction.m[3][0] = 0.0f; correction.m[3][1] = 0.0f; correction.m[3][2] = 0.0f; correction.m[3][3] = 1.0f;
-			boneLocalTransform = MultMatrix( boneLocalTransform, correction );
-		}
-		BoneKeyFrame* key = &keyframe->targetBoneTransforms[ targetBone->boneIndex ];
-		key->combinedMatrix = boneLocalTransform;
-		DecomposeMat4( boneLocalTransform, &key->scale, &key->rotation, &key->translation );
-		Mat4 m = Mat4FromComponents( key->scale, key->rotation, key->translation );
-
-		animationNode = animationNode->NextSibling();
-	}
-
-	//Pre multiply bones with parents to save doing it during runtime
-	struct {
-		ArmatureKeyFrame* keyframe;
-		void PremultiplyKeyFrame( Bone* target, Mat4 parentTransform ) {
-			BoneKeyFrame* boneKey = &keyframe->targetBoneTransforms[ target->boneIndex ];
-			Mat4 netMatrix = MultMatrix( boneKey->combinedMatrix, parentTransform );
-
-			for( uint8 boneIndex = 0; boneIndex < target->childCount; boneIndex++ ) {
-				PremultiplyKeyFrame( target->children[ boneIndex ], netMatrix );
-			}
-			boneKey->combinedMatrix = netMatrix;
-			DecomposeMat4( boneKey->combinedMatrix, &boneKey->scale, &boneKey->rotation, &boneKey->translation );
-		}
-	}LocalRecursiveScope;
-	LocalRecursiveScope.keyframe = keyframe;
-	Mat4 i; SetToIdentity( &i );
-	LocalRecursiveScope.PremultiplyKeyFrame( armature->rootBone, i );
-}
-
-void LoadTextureDataFromDisk( const char* fileName, TextureData* storage ) {
-    storage->data = (uint8*)stbi_load( fileName, (int*)&storage->width, (int*)&storage->height, (int*)&storage->channelsPerPixel, 0 );
-    if( storage->data == NULL ) {
-        printf( "Could not load file: %s\n", fileName );
-    }
-    printf( "Loaded file: %s\n", fileName );
-    printf( "Width: %d, Height: %d, Channel count: %d\n", storage->width, storage->height, storage->channelsPerPixel );
-}
-
-/*----------------------------------------------------------------------------------------
-                       Local Functions only to be used in this file
-------------------------------------------------------------------------------------------*/
-
-static void TextToNumberConversion( char* textIn, float* numbersOut ) {
-	char* start;
-	char* end; 
-	start = textIn; 
-	end = start;
-	uint16 index = 0;
-	do {
-		do {
-			end++;
-		} while( *end != ' ' && *end != 0 );
-		assert( ( end - start) < 16 );
-		char buffer [16];
-		memcpy( &buffer[0], start, end - start);
-		buffer[end - start] = 0;
-		start = end;
-
-		numbersOut[index] = atof( buffer );
-		index++;
-	} while( *end != 0 );
-}
+#include "AssetLoaders.cpp"
 
 static LRESULT CALLBACK WndProc( HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam ) {
 	switch (uMsg) {
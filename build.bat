@@ -5,7 +5,7 @@ SET VSFlags=/W1 /O2 /Zi /FeTetra.exe
 SET VSIncludes=-I..\Tetrahedron\Src\Dependencies\include
 SET VSLinkerFlags=/link /Profile
 
-SET GlobalLibs=user32.lib glu32.lib opengl32.lib gdi32.lib xinput9_1_0.lib
+SET GlobalLibs=user32.lib glu32.lib opengl32.lib gdi32.lib xinput9_1_0.lib winmm.lib
 SET LocalLibsInclude=-LIBPATH:..\Tetrahedron\Src\Dependencies\lib\OpenGL\
 SET LocalLibs=glew32s.lib
 